@@ -28,13 +28,57 @@ namespace re
 	{
 		return m_vertex_data;
 	}
+	math::faabb_t const& Model::aabb() const
+	{
+		return m_vertex_data->aabb();
+	}
+	void Model::setVertexData(Shared<graphics::gl::VertexArrayBase> vertex_data)
+	{
+		m_vertex_data = std::move(vertex_data);
+	}
+	Shared<graphics::Material> const& Model::material() const
+	{
+		return m_material;
+	}
+	void Model::setMaterial(Shared<graphics::Material> material)
+	{
+		m_material = std::move(material);
+	}
+	Shared<graphics::gl::ShaderProgram> const& Model::shader() const
+	{
+		return m_shader;
+	}
+	void Model::setShader(Shared<graphics::gl::ShaderProgram> shader)
+	{
+		m_shader = std::move(shader);
+	}
+	Shared<graphics::gl::Texture> const& Model::texture() const
+	{
+		return m_texture;
+	}
+	void Model::setTexture(Shared<graphics::gl::Texture> texture)
+	{
+		m_texture = std::move(texture);
+	}
+
 	void Model::draw(
 		const math::fmat4x4_t &mvp) const
 	{
-		passMaterial();
-		m_texture->bind();
+		draw(mvp, nullptr);
+	}
+
+	void Model::draw(
+		const math::fmat4x4_t &mvp,
+		Model const * previous) const
+	{
+		// the material properties are uniforms of the shader, so they are passed again to another shader.
+		if(!previous || previous->m_shader != m_shader || previous->m_material != m_material)
+			passMaterial();
+		if(!previous || previous->m_texture != m_texture)
+			m_texture->bind();
 		m_shader->set_uniform("RE_MVP", mvp);
-		m_vertex_data->bind();
+		if(!previous || previous->m_vertex_data != m_vertex_data)
+			m_vertex_data->bind();
 		m_vertex_data->draw();
 	}
 }
@@ -27,8 +27,16 @@ namespace re
 		void passMaterial() const;
 		/** Draws the VertexData. */
 		void draw(math::fmat4x4_t const& mvp) const;
-
-		/** Returns the BoundingBox of the VertexData. */
+		/** Draws the VertexData, but skips binding the shader, material, texture and vertex array if the given Model, which was drawn last, already did.
+		@param[in] mvp:
+			The projection, view and model matrix.
+		@param[in] previous:
+			The Model that was drawn last, or null. */
+		void draw(
+			math::fmat4x4_t const& mvp,
+			Model const * previous) const;
+
+		/** Returns the BoundingBox of the VertexData. It is empty if it is unknown. */
 		math::faabb_t const& aabb() const;
 		/** Returns the VertexData of this Model. */
 		Shared<graphics::gl::VertexArrayBase> const& vertex_data() const&;
@@ -0,0 +1,181 @@
+#include "RenderQueue.hpp"
+#include "util/FrameArena.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace re
+{
+	static_assert(4 * RenderQueue::k_state_bits + RenderQueue::k_depth_bits == 64,
+		"the sort key fields must fill 64 bits.");
+
+	namespace
+	{
+		/** How many bits are sorted per radix sort pass. */
+		unsigned const k_radix_bits = 8;
+		/** How many radix sort passes a key needs. */
+		unsigned const k_radix_passes = 64 / k_radix_bits;
+		/** How many different digits there are per pass. */
+		size_t const k_radix_size = size_t(1) << k_radix_bits;
+
+		template<class T>
+		/** Maps a state object to `k_state_bits` bits. Equal objects get equal bits, so that their draws become adjacent. */
+		uint64_t state_bits(Shared<T> const& state)
+		{
+			T const * const address = state ? &*state : nullptr;
+			// Fibonacci hashing, so that the low bits of addresses, which are mostly 0, do not collide.
+			return (uint64_t(uintptr_t(address)) * 0x9e3779b97f4a7c15ull) >> (64 - RenderQueue::k_state_bits);
+		}
+
+		/** Maps a depth to `k_depth_bits` bits, keeping the order. */
+		uint64_t depth_bits(float depth)
+		{
+			// the bits of non-negative floats grow with their value. NaN counts as 0.
+			float const clamped = depth > 0.0f ? depth : 0.0f;
+			uint32_t bits;
+			std::memcpy(&bits, &clamped, sizeof(bits));
+			return bits >> (32 - RenderQueue::k_depth_bits);
+		}
+
+		/** Counts the state changes that drawing a Model after another causes, as done by `Model::draw()`. */
+		void count_changes(
+			RenderStateChanges &changes,
+			Model const * previous,
+			Model const& model)
+		{
+			bool const shader = !previous || previous->shader() != model.shader();
+			changes.shaders += shader;
+			// material properties are uniforms, and have to be passed again to another shader.
+			changes.materials += shader || previous->material() != model.material();
+			changes.textures += !previous || previous->texture() != model.texture();
+			changes.vertex_arrays += !previous || previous->vertex_data() != model.vertex_data();
+		}
+	}
+
+	RenderStateChanges::RenderStateChanges():
+		shaders(0),
+		materials(0),
+		textures(0),
+		vertex_arrays(0)
+	{
+	}
+
+	RenderStatistics::RenderStatistics():
+		draws(0),
+		unsorted(),
+		sorted()
+	{
+	}
+
+	RenderQueue::RenderQueue()
+	{
+	}
+
+	void RenderQueue::clear()
+	{
+		models.clear();
+		transformations.clear();
+		entries.clear();
+		statistics = RenderStatistics();
+	}
+
+	void RenderQueue::add(
+		Model const& model,
+		math::fmat4x4_t const& mvp)
+	{
+		count_changes(statistics.unsorted, models.empty() ? nullptr : models.back(), model);
+		statistics.draws++;
+
+		// the w coordinate of the Model's origin in clip space is its distance to the camera.
+		Entry const entry = { key(model, mvp.v3.w), uint32_t(models.size()) };
+		entries.push_back(entry);
+		models.push_back(&model);
+		transformations.push_back(mvp);
+	}
+
+	void RenderQueue::sort()
+	{
+		size_t const count = entries.size();
+		statistics.sorted = RenderStateChanges();
+		if(!count)
+			return;
+
+		// a stable LSD radix sort, counting the digits of all passes at once.
+		size_t histograms[k_radix_passes][k_radix_size] = {};
+		for(Entry const& entry: entries)
+			for(unsigned pass = 0; pass < k_radix_passes; pass++)
+				histograms[pass][(entry.key >> (pass * k_radix_bits)) & (k_radix_size - 1)]++;
+
+		util::FrameArena::Scope scope(util::FrameArena::local());
+		Entry * from = entries.data();
+		Entry * to = scope.arena().allocate_array<Entry>(count);
+		for(unsigned pass = 0; pass < k_radix_passes; pass++)
+		{
+			unsigned const shift = pass * k_radix_bits;
+			size_t * const histogram = histograms[pass];
+			// the state bits of most keys are equal, so many passes would not change anything.
+			if(histogram[(from[0].key >> shift) & (k_radix_size - 1)] == count)
+				continue;
+
+			size_t offset = 0;
+			for(size_t digit = 0; digit < k_radix_size; digit++)
+			{
+				size_t const digits = histogram[digit];
+				histogram[digit] = offset;
+				offset += digits;
+			}
+
+			for(size_t i = 0; i < count; i++)
+				to[histogram[(from[i].key >> shift) & (k_radix_size - 1)]++] = from[i];
+			std::swap(from, to);
+		}
+
+		if(from != entries.data())
+			std::copy(from, from + count, entries.data());
+
+		Model const * previous = nullptr;
+		for(Entry const& entry: entries)
+		{
+			count_changes(statistics.sorted, previous, *models[entry.draw]);
+			previous = models[entry.draw];
+		}
+	}
+
+	void RenderQueue::submit() const
+	{
+		Model const * previous = nullptr;
+		for(Entry const& entry: entries)
+		{
+			Model const& model = *models[entry.draw];
+			model.draw(transformations[entry.draw], previous);
+			previous = &model;
+		}
+	}
+
+	size_t RenderQueue::size() const
+	{
+		return entries.size();
+	}
+
+	RenderStatistics const& RenderQueue::getStatistics() const
+	{
+		return statistics;
+	}
+
+	uint64_t RenderQueue::key(
+		Model const& model,
+		float depth)
+	{
+		unsigned const depth_shift = 0;
+		unsigned const vertex_array_shift = depth_shift + k_depth_bits;
+		unsigned const texture_shift = vertex_array_shift + k_state_bits;
+		unsigned const material_shift = texture_shift + k_state_bits;
+		unsigned const shader_shift = material_shift + k_state_bits;
+
+		return state_bits(model.shader()) << shader_shift
+			| state_bits(model.material()) << material_shift
+			| state_bits(model.texture()) << texture_shift
+			| state_bits(model.vertex_data()) << vertex_array_shift
+			| depth_bits(depth) << depth_shift;
+	}
+}
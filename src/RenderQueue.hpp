@@ -0,0 +1,100 @@
+#ifndef __re_renderqueue_hpp_defined
+#define __re_renderqueue_hpp_defined
+
+#include "Model.hpp"
+#include "math/Matrix.hpp"
+#include "util/AlignedAllocator.hpp"
+#include "types.hpp"
+#include "defines.hpp"
+
+#include <vector>
+
+namespace re
+{
+	/** Counts how often the state changes between consecutive draws. */
+	struct RenderStateChanges
+	{
+		RenderStateChanges();
+
+		/** How often another shader program is used. */
+		size_t shaders;
+		/** How often material properties are passed to the shader. */
+		size_t materials;
+		/** How often another texture is bound. */
+		size_t textures;
+		/** How often another vertex array is bound. */
+		size_t vertex_arrays;
+	};
+
+	/** Describes the draws of a frame. */
+	struct RenderStatistics
+	{
+		RenderStatistics();
+
+		/** How many Models were drawn. */
+		size_t draws;
+		/** The state changes the draws cause in the order they were added. */
+		RenderStateChanges unsorted;
+		/** The state changes the draws cause after sorting, as they were submitted. */
+		RenderStateChanges sorted;
+	};
+
+	/** Collects the draws of a frame and submits them ordered by state, so that shaders, materials, textures and vertex arrays are changed as rarely as possible.
+	Every draw gets a 64 bit sort key, which holds, from the most significant bits on: the shader program, the material, the texture, the vertex array, and the depth. Draws with the same state are thus drawn front to back. The keys are sorted with a radix sort, whose scratch memory comes from the frame arena. */
+	class RenderQueue
+	{
+		/** A sort key, and the draw it belongs to. */
+		struct Entry
+		{
+			uint64_t key;
+			uint32_t draw;
+		};
+
+		/** The Model of each draw. */
+		std::vector<Model const *> models;
+		/** The transformation of each draw. */
+		util::AlignedVector<math::fmat4x4_t> transformations;
+		/** The draws, in submission order after sort(). */
+		std::vector<Entry> entries;
+		/** The statistics of the current draws. */
+		RenderStatistics statistics;
+	public:
+		/** How many bits of the sort key identify the shader program, material, texture and vertex array, each. */
+		static unsigned const k_state_bits = 12;
+		/** How many bits of the sort key hold the depth. */
+		static unsigned const k_depth_bits = 16;
+
+		RenderQueue();
+
+		/** Removes all draws and resets the statistics. The memory is kept for the next frame. */
+		void clear();
+		/** Adds a draw.
+		@param[in] model:
+			The Model to draw. Must outlive the next submit().
+		@param[in] mvp:
+			The projection, view and model matrix to draw the Model with. */
+		void add(
+			Model const& model,
+			math::fmat4x4_t const& mvp);
+		/** Sorts the draws by their keys, and counts their state changes. */
+		void sort();
+		/** Draws all Models in the current order, skipping the bindings the previous Model already made. The draws are kept. */
+		void submit() const;
+
+		/** How many draws there are. */
+		size_t size() const;
+		/** Returns the statistics of the current draws, which are complete after sort(). */
+		RenderStatistics const& getStatistics() const;
+
+		/** Computes the sort key of a draw.
+		@param[in] model:
+			The Model to draw.
+		@param[in] depth:
+			The distance from the camera. Negative depths count as 0. */
+		static uint64_t key(
+			Model const& model,
+			float depth);
+	};
+}
+
+#endif
@@ -2,11 +2,20 @@
 #include "graphics/gl/OpenGL.hpp"
 #include "Scene.hpp"
 #include "SceneNode.hpp"
+#include "math/PointTransform.hpp"
 
 #include "LogFile.hpp"
 
 namespace re
 {
+	CullingStatistics::CullingStatistics():
+		tests(0),
+		culled_subtrees(0),
+		culled(0),
+		drawn(0)
+	{
+	}
+
 	Renderer::Renderer(
 		NotNull<graphics::gl::ShaderProgram> shader,
 		NotNull<Scene> scene,
@@ -53,11 +62,15 @@ namespace re
 	void Renderer::render()
 	{
 		RE_DBG_ASSERT(window->context().current());
+
+		scene->resetTransformStatistics();
+		scene->updateTransforms();
+
 		shader->use();
 
 		math::fmat4x4_t camera_mat(camera->view_matrix());
 
-		render(scene->getRoot(), projection * camera_mat);
+		renderQueued(scene->getRoot(), projection * camera_mat);
 	}
 
 	void Renderer::render(
@@ -78,6 +91,61 @@ namespace re
 		}
 	}
 
+	void Renderer::renderQueued(
+		SceneNode const& node,
+		math::fmat4x4_t const& view_projection)
+	{
+		culling_statistics = CullingStatistics();
+		queue.clear();
+		collect(node, view_projection, math::ffrustum_t(view_projection), false);
+		queue.sort();
+		queue.submit();
+	}
+
+	void Renderer::collect(
+		SceneNode const& node,
+		math::fmat4x4_t const& camera_mat,
+		math::ffrustum_t const& frustum,
+		bool inside)
+	{
+		// the bounding boxes are cached like the world transformations, so only changed branches are recomputed.
+		if(!node.getModelCount())
+			return;
+		// a Model without bounding box cannot be culled, but its child nodes can.
+		if(!inside && node.isBounded())
+		{
+			culling_statistics.tests++;
+			math::Visibility const visibility = frustum.classify(node.getBounds());
+			if(visibility == math::Visibility::Outside)
+			{
+				culling_statistics.culled_subtrees++;
+				culling_statistics.culled += node.getModelCount();
+				return;
+			}
+			inside = visibility == math::Visibility::Inside;
+		}
+
+		if(auto model = node.getModel())
+		{
+			// the bounding box of a SceneNode with child nodes also contains them, so its Model is tested on its own.
+			bool visible = inside || node.isLeaf() || model->aabb().empty();
+			if(!visible)
+			{
+				culling_statistics.tests++;
+				visible = frustum.classify(math::transformed_aabb(node.getWorldTransformation(), model->aabb())) != math::Visibility::Outside;
+			}
+
+			if(visible)
+			{
+				queue.add(*model, camera_mat * node.getWorldTransformation());
+				culling_statistics.drawn++;
+			} else
+				culling_statistics.culled++;
+		}
+		for(SceneNode const * child = node.firstChild(); child; child = child->nextSibling())
+			collect(*child, camera_mat, frustum, inside);
+	}
+
 	void Renderer::setTransformUniform(
 		graphics::gl::ShaderProgram::uniform_t uniform)
 	{
@@ -95,4 +163,19 @@ namespace re
 	{
 		this->projection = projection;
 	}
+
+	RenderStatistics const& Renderer::getRenderStatistics() const
+	{
+		return queue.getStatistics();
+	}
+
+	CullingStatistics const& Renderer::getCullingStatistics() const
+	{
+		return culling_statistics;
+	}
+
+	math::ffrustum_t Renderer::getFrustum() const
+	{
+		return math::ffrustum_t(projection * camera->view_matrix());
+	}
 }
\ No newline at end of file
@@ -6,12 +6,29 @@
 #include "types.hpp"
 #include "Camera.hpp"
 #include "Scene.hpp"
+#include "RenderQueue.hpp"
 
 #include "ui/UIView.hpp"
 #include "Projection.hpp"
+#include "math/Frustum.hpp"
 
 namespace re
 {
+	/** Counts how many Models the view frustum culling skipped. */
+	struct CullingStatistics
+	{
+		CullingStatistics();
+
+		/** How many bounding boxes were tested against the frustum. */
+		size_t tests;
+		/** How many SceneNodes were outside the frustum, and skipped with their child nodes. */
+		size_t culled_subtrees;
+		/** How many Models were skipped. */
+		size_t culled;
+		/** How many Models were drawn. */
+		size_t drawn;
+	};
+
 	class Renderer
 	{
 		NotNull<graphics::gl::ShaderProgram> shader;
@@ -22,7 +39,25 @@ namespace re
 		NotNull<graphics::Window> window;
 		NotNull<Camera> camera;
 		math::fmat4x4_t projection;
+		/** The draws of the current frame, sorted by state before they are submitted. */
+		RenderQueue queue;
+		/** The culling counts of the current frame. */
+		CullingStatistics culling_statistics;
 
+		/** Queues the Models of a SceneNode and its child nodes that are not outside the frustum.
+		@param[in] node:
+			The SceneNode to draw.
+		@param[in] camera_mat:
+			The projection and view matrix of the camera.
+		@param[in] frustum:
+			The frustum of camera_mat.
+		@param[in] inside:
+			Whether the SceneNode is known to be completely inside the frustum, so that it is not tested. */
+		void collect(
+			SceneNode const& node,
+			math::fmat4x4_t const& camera_mat,
+			math::ffrustum_t const& frustum,
+			bool inside);
 
 	public:
 		Renderer(
@@ -47,10 +82,32 @@ namespace re
 		void setProjection(
 			math::fmat4x4_t const& projection);
 
+		/** Returns the frustum that is visible through the camera and projection, for culling. */
+		math::ffrustum_t getFrustum() const;
+
+		/** Draws the Scene via renderQueued(). If the Scene uses its flattened transform hierarchy, the world transformations are updated first. */
 		virtual void render();
+		/** Draws a SceneNode and its child nodes immediately, in tree order, without culling.
+		@param[in] node:
+			The SceneNode to draw.
+		@param[in] camera_mat:
+			The model view projection matrix of the node's parent. The node's local transformation is applied to it, and the result is passed on to the child nodes. */
 		virtual void render(
 			SceneNode const& node,
 			math::fmat4x4_t const& camera_mat);
+		/** Draws a SceneNode and its child nodes with the current shader. The bounding boxes of the SceneNodes are tested against the camera's frustum, and SceneNodes that are outside are skipped together with their child nodes. The remaining Models are collected into a RenderQueue, and drawn ordered by state.
+		@param[in] node:
+			The SceneNode to draw.
+		@param[in] view_projection:
+			The projection and view matrix of the camera. The world transformations of the SceneNodes are applied to it. */
+		virtual void renderQueued(
+			SceneNode const& node,
+			math::fmat4x4_t const& view_projection);
+
+		/** Returns how many Models were drawn, and how many state changes sorting saved, during the last call to renderQueued(). */
+		RenderStatistics const& getRenderStatistics() const;
+		/** Returns how many Models were culled and drawn during the last call to renderQueued(). */
+		CullingStatistics const& getCullingStatistics() const;
 	};
 }
 
@@ -124,17 +124,17 @@ namespace re
 		return loaded;
 	}
 
-	Shared<lock::ThreadSafe<TextAsset>> Resource::addText(TextAsset &&asset)
+	AtomicShared<lock::ThreadSafe<TextAsset>> Resource::addText(TextAsset &&asset)
 	{
 		texts.push_back(
-			Shared<lock::ThreadSafe<TextAsset>>::alloc(
+			AtomicShared<lock::ThreadSafe<TextAsset>>::alloc(
 				std::move(asset)));
 		return texts.back();
 	}
-	Shared<lock::ThreadSafe<BitmapAsset>> Resource::addBitmap(BitmapAsset &&asset)
+	AtomicShared<lock::ThreadSafe<BitmapAsset>> Resource::addBitmap(BitmapAsset &&asset)
 	{
 		bitmaps.push_back(
-			Shared<lock::ThreadSafe<BitmapAsset>>::alloc(
+			AtomicShared<lock::ThreadSafe<BitmapAsset>>::alloc(
 				std::move(asset)));
 		return bitmaps.back();
 	}
@@ -15,8 +15,8 @@ namespace re
 		string8_t filename;
 		bool loaded;
 
-		std::vector<Shared<lock::ThreadSafe<TextAsset>>> texts;
-		std::vector<Shared<lock::ThreadSafe<BitmapAsset>>> bitmaps;
+		std::vector<AtomicShared<lock::ThreadSafe<TextAsset>>> texts;
+		std::vector<AtomicShared<lock::ThreadSafe<BitmapAsset>>> bitmaps;
 
 		explicit Resource(
 			string8_t const& filename);
@@ -35,8 +35,8 @@ namespace re
 		bool isLoaded() const;
 
 		/** Used for constructing Resources before writing them to a file. */
-		Shared<lock::ThreadSafe<TextAsset>> addText(TextAsset &&asset);
-		Shared<lock::ThreadSafe<BitmapAsset>> addBitmap(BitmapAsset &&asset);
+		AtomicShared<lock::ThreadSafe<TextAsset>> addText(TextAsset &&asset);
+		AtomicShared<lock::ThreadSafe<BitmapAsset>> addBitmap(BitmapAsset &&asset);
 	};
 }
 #endif
\ No newline at end of file
@@ -1,8 +1,24 @@
 #include "Scene.hpp"
+#include "LogFile.hpp"
 
 namespace re
 {
-	Scene::Scene() : root(*this)	{ }
+	TransformStatistics::TransformStatistics():
+		local_updates(0),
+		world_updates(0)
+	{
+	}
+
+	Scene::Scene():
+		handle_slots(1),
+		structure_generation(0),
+		flat_enabled(false),
+		flat_transforms(*this),
+		root(*this)
+	{
+		// creates the pool before the Scene is complete, so that the pool is destroyed after static Scenes.
+		getNodePool();
+	}
 
 	SceneNode &Scene::getRoot()
 	{
@@ -12,4 +28,83 @@ namespace re
 	{
 		return root;
 	}
-}
\ No newline at end of file
+
+	util::ObjectPool<SceneNode> &Scene::getNodePool()
+	{
+		return SceneNode::nodePool();
+	}
+
+	uint32_t Scene::acquireHandle(SceneNode &node)
+	{
+		uint32_t index;
+		if(free_handles.empty())
+		{
+			index = uint32_t(handle_slots.size());
+			handle_slots.push_back(HandleSlot());
+		} else
+		{
+			index = free_handles.back();
+			free_handles.pop_back();
+		}
+
+		handle_slots[index].node = &node;
+		return index;
+	}
+
+	void Scene::releaseHandle(uint32_t index)
+	{
+		RE_DBG_ASSERT(index && index < handle_slots.size() && handle_slots[index].node);
+
+		handle_slots[index].node = nullptr;
+		handle_slots[index].generation++;
+		free_handles.push_back(index);
+	}
+
+	SceneNode * Scene::resolve(NodeHandle handle) const
+	{
+		if(!handle.index || handle.index >= handle_slots.size())
+			return nullptr;
+
+		const HandleSlot &slot = handle_slots[handle.index];
+		return slot.generation == handle.generation
+			? slot.node
+			: nullptr;
+	}
+
+	const TransformStatistics &Scene::getTransformStatistics() const
+	{
+		return transform_statistics;
+	}
+
+	void Scene::resetTransformStatistics()
+	{
+		transform_statistics = TransformStatistics();
+	}
+
+	void Scene::setFlatTransforms(bool enable)
+	{
+		flat_enabled = enable;
+		if(!enable)
+			flat_transforms.clear();
+	}
+
+	bool Scene::usesFlatTransforms() const
+	{
+		return flat_enabled;
+	}
+
+	void Scene::updateTransforms()
+	{
+		if(!flat_enabled)
+			return;
+
+		if(!flat_transforms.current())
+			flat_transforms.build();
+		transform_statistics.world_updates += flat_transforms.update();
+	}
+
+	const TransformHierarchy &Scene::getFlatTransforms() const
+	{
+		return flat_transforms;
+	}
+}
\ No newline at end of file
@@ -2,20 +2,87 @@
 #define __re_scene_hpp_defined
 
 #include "SceneNode.hpp"
+#include "TransformHierarchy.hpp"
 #include "types.hpp"
 #include "defines.hpp"
 
 namespace re
 {
-	class Scene
+	/** Counts how many cached SceneNode transformations were recomputed. */
+	struct TransformStatistics
 	{
+		TransformStatistics();
+
+		/** How many transformations relative to the parent node were recomputed. */
+		size_t local_updates;
+		/** How many transformations relative to the Scene root were recomputed. */
+		size_t world_updates;
+	};
+
+	class Scene
+	{	friend class SceneNode;
+		friend class TransformHierarchy;
+
+		/** An entry of the handle table. */
+		struct HandleSlot
+		{
+			/** The SceneNode, or null if the slot is free. */
+			SceneNode * node;
+			/** Incremented whenever the slot is freed, so that old handles to it no longer match. */
+			uint32_t generation;
+		};
+		/** The handle table, so that NodeHandles stay checkable after their SceneNode was freed. Slot 0 is never used, as 0 marks the null handle.
+		It is declared before the root, so that it outlives it. */
+		std::vector<HandleSlot> handle_slots;
+		/** The free slots of the handle table. */
+		std::vector<uint32_t> free_handles;
+		/** Incremented whenever SceneNodes are added, removed or moved, so that a TransformHierarchy knows when it is out of date. */
+		uint32_t structure_generation;
+		/** Whether updateTransforms() uses the flattened hierarchy. */
+		bool flat_enabled;
+		/** The flattened hierarchy, if enabled. It is declared before the root, so that it outlives it. */
+		TransformHierarchy flat_transforms;
 		SceneNode root;
+		/** Counts the transformations recomputed by the SceneNodes of this Scene. */
+		TransformStatistics transform_statistics;
+
+		/** Assigns a handle table slot to a SceneNode. */
+		uint32_t acquireHandle(SceneNode &node);
+		/** Frees a handle table slot, so that all handles to it become invalid. */
+		void releaseHandle(uint32_t index);
 	public:
 		Scene();
+		/** The SceneNodes and the handle table point at their Scene, so it cannot be copied or moved. */
+		Scene(Scene const&) = delete;
+		Scene &operator=(Scene const&) = delete;
 
 		SceneNode &getRoot();
 		const SceneNode &getRoot() const;
+
+		/** The pool the child SceneNodes of all Scenes, and of SceneNodes outside of a Scene, are allocated from.
+		It is shared, so that SceneNodes can move between Scenes without outliving their pool, and thread-safe, so that detached subtrees can be built on other threads. */
+		static util::ObjectPool<SceneNode> &getNodePool();
+
+		/** Returns the SceneNode the given handle refers to, or null if the handle is null, or the SceneNode was destroyed or has left this Scene. */
+		SceneNode * resolve(NodeHandle handle) const;
+
+		/** Returns how many SceneNode transformations were recomputed since the last call to resetTransformStatistics().
+		Renderer::render() resets them when a frame begins, so after rendering, they hold the counts of that frame. */
+		const TransformStatistics &getTransformStatistics() const;
+		/** Sets the transformation counters to 0. */
+		void resetTransformStatistics();
+
+		/** Enables or disables the flattened transform hierarchy, see TransformHierarchy. While it is enabled, updateTransforms() recomputes the world transformations of all changed SceneNodes in one pass over contiguous arrays, without visiting unchanged subtrees, and the SceneNodes copy their world transformations from there instead of computing them.
+		The hierarchy is rebuilt by the next updateTransforms() after SceneNodes were added, removed or moved. Disabling it frees its memory. */
+		void setFlatTransforms(bool enable);
+		/** Returns whether the flattened transform hierarchy is enabled. */
+		bool usesFlatTransforms() const;
+		/** Brings the world transformations of all SceneNodes up to date via the flattened transform hierarchy, rebuilding it if needed. Does nothing if it is disabled.
+		Renderer::render() calls this before drawing the Scene. The recomputed transformations are counted in getTransformStatistics(). */
+		void updateTransforms();
+		/** Returns the flattened transform hierarchy. It is only filled while enabled, and current after updateTransforms(). */
+		const TransformHierarchy &getFlatTransforms() const;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -1,42 +1,218 @@
 #include "SceneNode.hpp"
 #include "Scene.hpp"
+#include "math/PointTransform.hpp"
 
 namespace re
 {
+	NodeHandle::NodeHandle(): index(0), generation(0) { }
+	NodeHandle::NodeHandle(uint32_t index, uint32_t generation): index(index), generation(generation) { }
 
-	math::fmat4x4_t SceneNode::getTransformation() const
+	NodeHandle::operator bool() const
 	{
-		return math::fmat4x4_t::transformation(position, rotation, scaling);
+		return index != 0;
 	}
 
-	SceneNode::~SceneNode() {}
-	SceneNode::SceneNode(): parent_node(nullptr), scene(nullptr), rotation(), position(), scaling(1,1,1), model(nullptr) { }
-	SceneNode::SceneNode(SceneNode &&move): parent_node(move.parent_node), child_nodes(std::move(move.child_nodes)), scene(move.scene), rotation(move.rotation), position(move.position), scaling(move.scaling), model(move.model)  {
-		for(SceneNode &node: child_nodes)
-			node.parent_node = this;
+	bool NodeHandle::operator==(const NodeHandle &rhs) const
+	{
+		return index == rhs.index && generation == rhs.generation;
+	}
+
+	bool NodeHandle::operator!=(const NodeHandle &rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	const math::fmat4x4_t &SceneNode::getTransformation() const
+	{
+		if(local_dirty)
+		{
+			local_transformation = math::fmat4x4_t::transformation(position, orientation, scaling);
+			local_dirty = false;
+			if(scene)
+				scene->transform_statistics.local_updates++;
+		}
+		return local_transformation;
+	}
+
+	const math::fmat4x4_t &SceneNode::getWorldTransformation() const
+	{
+		if(world_dirty)
+		{
+			if(scene && scene->flat_transforms.contains(*this))
+			{
+				// asks the parent node first, so that clean nodes only have clean parents.
+				if(parent_node)
+					parent_node->getWorldTransformation();
+				scene->updateTransforms();
+				world_transformation = scene->flat_transforms.getWorldTransformation(flat_index);
+			} else
+			{
+				world_transformation = parent_node
+					? parent_node->getWorldTransformation() * getTransformation()
+					: getTransformation();
+				if(scene)
+					scene->transform_statistics.world_updates++;
+			}
+			world_dirty = false;
+		}
+		return world_transformation;
+	}
+
+	void SceneNode::invalidateTransformation()
+	{
+		local_dirty = true;
+		invalidateWorldTransformation();
+		if(scene)
+			scene->flat_transforms.changed(*this);
+	}
+
+	void SceneNode::invalidateWorldTransformation()
+	{
+		// dirty nodes only have dirty children.
+		if(world_dirty)
+			return;
+		world_dirty = true;
+		invalidateBounds();
+		for(SceneNode * child = first_child; child; child = child->next_sibling)
+			child->invalidateWorldTransformation();
+	}
+
+	void SceneNode::invalidateBounds()
+	{
+		// dirty nodes only have dirty parents.
+		for(SceneNode * node = this; node && !node->bounds_dirty; node = node->parent_node)
+			node->bounds_dirty = true;
+	}
+
+	void SceneNode::updateBounds() const
+	{
+		if(!bounds_dirty)
+			return;
+
+		// also updates the world transformation, so that bounds_dirty is set whenever world_dirty is.
+		const math::fmat4x4_t &world = getWorldTransformation();
+		bounds = math::faabb_t(math::empty);
+		model_count = 0;
+		unbounded = false;
+		if(model)
+		{
+			model_count = 1;
+			const math::faabb_t &aabb = model->aabb();
+			if(aabb.empty())
+				unbounded = true;
+			else
+				bounds = math::transformed_aabb(world, aabb);
+		}
+
+		for(const SceneNode * child = first_child; child; child = child->next_sibling)
+		{
+			child->updateBounds();
+			bounds |= child->bounds;
+			model_count += child->model_count;
+			unbounded = unbounded || child->unbounded;
+		}
+		bounds_dirty = false;
+	}
+
+	const math::faabb_t &SceneNode::getBounds() const
+	{
+		updateBounds();
+		return bounds;
+	}
+
+	size_t SceneNode::getModelCount() const
+	{
+		updateBounds();
+		return model_count;
+	}
+
+	bool SceneNode::isBounded() const
+	{
+		updateBounds();
+		return !unbounded;
+	}
+
+	const math::fquat_t &SceneNode::getOrientation() const
+	{
+		return orientation;
+	}
+
+	void SceneNode::setOrientation(const math::fquat_t &orientation)
+	{
+		this->orientation = orientation;
+		invalidateTransformation();
+	}
+
+	math::Vec3<math::Angle> SceneNode::getRotation() const
+	{
+		return math::euler(orientation);
+	}
+
+	void SceneNode::setRotation(const math::Vec3<math::Angle> &rotation)
+	{
+		orientation = math::fquat_t::euler(rotation);
+		invalidateTransformation();
+	}
+
+	const math::fvec3_t &SceneNode::getScaling() const
+	{
+		return scaling;
+	}
+
+	void SceneNode::setScaling(const math::fvec3_t &scaling)
+	{
+		this->scaling = scaling;
+		invalidateTransformation();
+	}
+
+	const math::fvec3_t &SceneNode::getPosition() const
+	{
+		return position;
+	}
+
+	void SceneNode::setPosition(const math::fvec3_t &position)
+	{
+		this->position = position;
+		invalidateTransformation();
 	}
-	SceneNode::SceneNode(const SceneNode &copy): parent_node(copy.parent_node), child_nodes(copy.child_nodes), scene(copy.scene), rotation(copy.rotation), position(copy.position), scaling(copy.scaling), model(copy.model)
+
+	SceneNode::~SceneNode()
 	{
-		for(SceneNode &node: child_nodes)
-			node.parent_node = this;
+		destroyChildren();
+		if(handle_index)
+			scene->releaseHandle(handle_index);
+	}
+	SceneNode::SceneNode(): scene(nullptr), parent_node(nullptr), model(nullptr), first_child(nullptr), last_child(nullptr), next_sibling(nullptr), prev_sibling(nullptr), child_count(0), handle_index(0), flat_index(0), orientation(), scaling(1,1,1), position(), local_transformation(math::fmat4x4_t::kIdentity), world_transformation(math::fmat4x4_t::kIdentity), local_dirty(true), world_dirty(true), bounds(math::empty), model_count(0), unbounded(false), bounds_dirty(true) { }
+	SceneNode::SceneNode(SceneNode &&move): scene(move.scene), parent_node(nullptr), model(move.model), first_child(move.first_child), last_child(move.last_child), next_sibling(nullptr), prev_sibling(nullptr), child_count(move.child_count), handle_index(0), flat_index(0), orientation(move.orientation), scaling(move.scaling), position(move.position), local_transformation(move.local_transformation), world_transformation(move.world_transformation), local_dirty(move.local_dirty), world_dirty(true), bounds(math::empty), model_count(0), unbounded(false), bounds_dirty(true)  {
+		move.first_child = move.last_child = nullptr;
+		move.child_count = 0;
+		for(SceneNode * node = first_child; node; node = node->next_sibling)
+		{
+			node->parent_node = this;
+			node->invalidateWorldTransformation();
+		}
+		if(first_child)
+			invalidateStructure();
+		move.passHandle(*this);
 	}
-	SceneNode::SceneNode(Scene &scene) : parent_node(nullptr), scene(&scene), rotation(), position(), scaling(1,1,1), model(nullptr)  { }
+	SceneNode::SceneNode(const SceneNode &copy): scene(copy.scene), parent_node(nullptr), model(copy.model), first_child(nullptr), last_child(nullptr), next_sibling(nullptr), prev_sibling(nullptr), child_count(0), handle_index(0), flat_index(0), orientation(copy.orientation), scaling(copy.scaling), position(copy.position), local_transformation(copy.local_transformation), world_transformation(copy.world_transformation), local_dirty(copy.local_dirty), world_dirty(true), bounds(math::empty), model_count(0), unbounded(false), bounds_dirty(true)
+	{
+		copyChildren(copy);
+	}
+	SceneNode::SceneNode(Scene &scene) : scene(&scene), parent_node(nullptr), model(nullptr), first_child(nullptr), last_child(nullptr), next_sibling(nullptr), prev_sibling(nullptr), child_count(0), handle_index(0), flat_index(0), orientation(), scaling(1,1,1), position(), local_transformation(math::fmat4x4_t::kIdentity), world_transformation(math::fmat4x4_t::kIdentity), local_dirty(true), world_dirty(true), bounds(math::empty), model_count(0), unbounded(false), bounds_dirty(true)  { }
 
 
 	SceneNode &SceneNode::operator=(const SceneNode &rhs)
 	{
 		if(&rhs == this)
 			return *this;
-		parent_node = rhs.parent_node;
-		child_nodes = rhs.child_nodes;
+		copyChildren(rhs);
 
-		rotation = rhs.rotation;
+		orientation = rhs.orientation;
 		position = rhs.position;
 		scaling = rhs.scaling;
 		model = rhs.model;
-
-		for(SceneNode &child: child_nodes)
-			child.parent_node = this;
+		invalidateTransformation();
 
 		return *this;
 	}
@@ -45,29 +221,160 @@ namespace re
 	{
 		if(&rhs == this)
 			return *this;
-		parent_node = rhs.parent_node;
-		child_nodes = std::move(rhs.child_nodes);
+		destroyChildren();
+		first_child = rhs.first_child;
+		last_child = rhs.last_child;
+		child_count = rhs.child_count;
+		rhs.first_child = rhs.last_child = nullptr;
+		rhs.child_count = 0;
+		if(first_child)
+		{
+			rhs.invalidateStructure();
+			invalidateStructure();
+		}
 
-		rotation = rhs.rotation;
+		orientation = rhs.orientation;
 		position = rhs.position;
 		scaling = rhs.scaling;
 		model = rhs.model;
+		invalidateTransformation();
 
-		for(SceneNode &child: child_nodes)
-			child.parent_node = this;
+		for(SceneNode * child = first_child; child; child = child->next_sibling)
+		{
+			child->parent_node = this;
+			if(child->scene != scene)
+				child->setScene(scene);
+			child->invalidateWorldTransformation();
+		}
+		rhs.passHandle(*this);
 
 		return *this;
 	}
 
+	util::ObjectPool<SceneNode> &SceneNode::nodePool()
+	{
+		// shared by all Scenes, so that subtrees can move between Scenes, and detached subtrees can be built on any thread.
+		static util::ObjectPool<SceneNode> pool(util::ObjectPoolMode::Concurrent);
+		return pool;
+	}
+
+	NotNull<SceneNode> SceneNode::adoptChild(SceneNode * node)
+	{
+		node->parent_node = this;
+		node->next_sibling = nullptr;
+		node->prev_sibling = last_child;
+		if(last_child)
+			last_child->next_sibling = node;
+		else
+			first_child = node;
+		last_child = node;
+		child_count++;
+
+		if(node->scene != scene)
+			node->setScene(scene);
+		node->invalidateWorldTransformation();
+		invalidateBounds();
+		invalidateStructure();
+		return node;
+	}
+
+	SceneNode * SceneNode::detachChild(SceneNode * child)
+	{
+		RE_DBG_ASSERT(child->parent_node == this);
+
+		if(child->prev_sibling)
+			child->prev_sibling->next_sibling = child->next_sibling;
+		else
+			first_child = child->next_sibling;
+		if(child->next_sibling)
+			child->next_sibling->prev_sibling = child->prev_sibling;
+		else
+			last_child = child->prev_sibling;
+		child_count--;
+		invalidateBounds();
+
+		child->parent_node = nullptr;
+		child->next_sibling = child->prev_sibling = nullptr;
+		child->invalidateWorldTransformation();
+		invalidateStructure();
+		return child;
+	}
+
+	void SceneNode::copyChildren(const SceneNode &from)
+	{
+		destroyChildren();
+
+		util::ObjectPool<SceneNode> &pool = nodePool();
+		for(const SceneNode * child = from.first_child; child; child = child->next_sibling)
+			adoptChild(pool.alloc(*child));
+	}
+
+	void SceneNode::destroyChildren()
+	{
+		SceneNode * child = first_child;
+		if(child)
+			invalidateStructure();
+		first_child = last_child = nullptr;
+		child_count = 0;
+
+		util::ObjectPool<SceneNode> &pool = nodePool();
+		while(child)
+		{
+			SceneNode * const next = child->next_sibling;
+			pool.dealloc(child);
+			child = next;
+		}
+	}
+
+	void SceneNode::setScene(Scene * scene)
+	{
+		if(handle_index)
+		{
+			this->scene->releaseHandle(handle_index);
+			handle_index = 0;
+		}
+
+		this->scene = scene;
+		for(SceneNode * child = first_child; child; child = child->next_sibling)
+			child->setScene(scene);
+	}
+
+	void SceneNode::passHandle(SceneNode &to)
+	{
+		if(!handle_index || to.scene != scene)
+			return;
+
+		if(to.handle_index)
+			scene->releaseHandle(to.handle_index);
+		scene->handle_slots[handle_index].node = &to;
+		to.handle_index = handle_index;
+		handle_index = 0;
+	}
+
+	void SceneNode::invalidateStructure()
+	{
+		if(scene)
+			scene->structure_generation++;
+	}
+
+	NodeHandle SceneNode::handle()
+	{
+		RE_ASSERT(scene);
+
+		if(!handle_index)
+			handle_index = scene->acquireHandle(*this);
+		return NodeHandle(handle_index, scene->handle_slots[handle_index].generation);
+	}
+
 	void SceneNode::releaseChild(NotNull<SceneNode> node, SceneNode * out_node)
 	{
-		RE_ASSERT(node>= &child_nodes.front() && node<=&child_nodes.back() && node->parent_node == this);
+		RE_ASSERT(node->parent_node == this);
 
+		SceneNode * const child = detachChild(node);
 		if(out_node)
-			*out_node = *node;
+			*out_node = std::move(*child);
 
-		size_t i = node-&child_nodes.front();
-		child_nodes.erase(child_nodes.begin()+i);
+		nodePool().dealloc(child);
 	}
 
 	SceneNode * SceneNode::parentNode() const
@@ -82,90 +389,75 @@ namespace re
 
 	bool SceneNode::isLeaf() const
 	{
-		return child_nodes.empty();
+		return !first_child;
 	}
 
 	SceneNode * SceneNode::nextSibling()
 	{
-		if(!parent_node)
-			return nullptr;
-
-		unsigned index = this-&parent_node->child_nodes.front();
-		if(index+1<parent_node->child_nodes.size())
-			return &parent_node->child_nodes[index+1];
-		else
-			return nullptr;
+		return next_sibling;
 	}
 	const SceneNode * SceneNode::nextSibling() const
 	{
-		if(!parent_node)
-			return nullptr;
-
-		unsigned index = this-&parent_node->child_nodes.front();
-		if(index+1<parent_node->child_nodes.size())
-			return &parent_node->child_nodes[index+1];
-		else
-			return nullptr;
+		return next_sibling;
 	}
 	SceneNode * SceneNode::prevSibling()
 	{
-		if(!parent_node)
-			return nullptr;
-		unsigned index = this-&parent_node->child_nodes.front();
-		if(index>0)
-			return &parent_node->child_nodes[index-1];
-		else return nullptr;
+		return prev_sibling;
 	}
 	const SceneNode * SceneNode::prevSibling() const
 	{
-		if(!parent_node)
-			return nullptr;
-		unsigned index = this-&parent_node->child_nodes.front();
-		if(index>0)
-			return &parent_node->child_nodes[index-1];
-		else return nullptr;
+		return prev_sibling;
 	}
 	SceneNode * SceneNode::firstChild()
 	{
-		return child_nodes.size() ? &child_nodes.front() : nullptr;
+		return first_child;
 	}
 	const SceneNode * SceneNode::firstChild() const
 	{
-		return child_nodes.size() ? &child_nodes.front() : nullptr;
+		return first_child;
 	}
 	SceneNode * SceneNode::lastChild()
 	{
-		return child_nodes.size() ? &child_nodes.back() : nullptr;
+		return last_child;
 	}
 	const SceneNode * SceneNode::lastChild() const
 	{
-		return child_nodes.size() ? &child_nodes.back() : nullptr;
+		return last_child;
 	}
 
 	SceneNode * SceneNode::nthChild(size_t child)
 	{
-		return child_nodes.size() > child ? &child_nodes[child] : nullptr;
+		SceneNode * node = first_child;
+		while(node && child--)
+			node = node->next_sibling;
+		return node;
 	}
 	const SceneNode * SceneNode::nthChild(size_t child) const
 	{
-		return child_nodes.size() > child ? &child_nodes[child] : nullptr;
+		const SceneNode * node = first_child;
+		while(node && child--)
+			node = node->next_sibling;
+		return node;
 	}
 
-	size_t SceneNode::children() const { return child_nodes.size(); }
+	size_t SceneNode::children() const { return child_count; }
 
 	NotNull<SceneNode> SceneNode::addChild(const SceneNode &node)
 	{
 		RE_ASSERT(!node.parent_node);
 
-		child_nodes.push_back(node);
-		SceneNode &handle = child_nodes.back();
-		handle.parent_node = this;
-		handle.scene = scene;
-		return &handle;
+		return adoptChild(nodePool().alloc(node));
+	}
+	NotNull<SceneNode> SceneNode::addChild(SceneNode &&node)
+	{
+		RE_ASSERT(!node.parent_node);
+
+		return adoptChild(nodePool().alloc(std::move(node)));
 	}
 	void SceneNode::setModel(Shared<Model> model)
 	{
 		this->model = std::move(model);
+		invalidateBounds();
 	}
 	Shared<Model> SceneNode::getModel()
 	{
@@ -178,13 +470,9 @@ namespace re
 
 	bool SceneNode::isfarchild(NotNull<SceneNode> child) const
 	{
-		for(const SceneNode &_child: child_nodes)
-			if(&_child == child)
+		for(const SceneNode * node = child->parent_node; node; node = node->parent_node)
+			if(node == this)
 				return true;
-			else if(_child.isfarchild(child))
-				return true;
-			else
-				continue;
 
 		return false;
 	}
@@ -195,10 +483,8 @@ namespace re
 			return child;
 
 		RE_ASSERT(child != &newParent && !child->isfarchild(&newParent));
+		RE_ASSERT(child->parent_node == this);
 
-		SceneNode temp;
-
-		releaseChild(child, &temp);
-		return newParent.addChild(temp);
+		return newParent.adoptChild(detachChild(child));
 	}
-}
\ No newline at end of file
+}
\ No newline at end of file
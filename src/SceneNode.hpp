@@ -8,14 +8,36 @@
 #include <memory>
 #include "Model.hpp"
 #include "defines.hpp"
+#include "util/ObjectPool.hpp"
 
 namespace re
 {
 	class Scene;
+
+	/** A weak reference to a SceneNode of a Scene, resolved via Scene::resolve().
+	Unlike a pointer, it detects when the SceneNode was destroyed or moved to another Scene, even if its memory was reused by another SceneNode. */
+	struct NodeHandle
+	{
+		/** The slot in the Scene's handle table, or 0 for the null handle. */
+		uint32_t index;
+		/** The generation of the slot when the handle was created. */
+		uint32_t generation;
+
+		/** Creates the null handle. */
+		NodeHandle();
+		NodeHandle(uint32_t index, uint32_t generation);
+
+		/** Returns whether this is not the null handle. Does not check whether the SceneNode still exists. */
+		explicit operator bool() const;
+		bool operator==(const NodeHandle &rhs) const;
+		bool operator!=(const NodeHandle &rhs) const;
+	};
+
 	/** The base scene node class used for representing entities in a scene.
 	It has a tree-based layout. */
 	class SceneNode
 	{	friend class Scene;
+		friend class TransformHierarchy;
 
 		/** The Scene this SceneNode belongs to. */
 		Scene * scene;
@@ -24,24 +46,81 @@ namespace re
 		/** The Model this SceneNode has. */
 		Shared<Model> model;
 
-		/** The child nodes of this Node. */
-		std::vector<SceneNode> child_nodes;
+		/** The first and last child nodes of this Node.
+		The child nodes are allocated from the shared node pool and linked via their sibling pointers, so that they keep their address, and are added, removed and moved in constant time. */
+		SceneNode * first_child, * last_child;
+		/** The neighbouring child nodes of the parent node. */
+		SceneNode * next_sibling, * prev_sibling;
+		/** How many child nodes there are. */
+		size_t child_count;
+		/** The slot of this SceneNode in the Scene's handle table, or 0 if no handle was created yet. */
+		uint32_t handle_index;
+		/** The index of this SceneNode in the Scene's TransformHierarchy, if it is current. */
+		uint32_t flat_index;
 
 		SceneNode(Scene &scene);
-	public:
-		/** The rotation of this SceneNode. */
-		math::Vec3<math::Angle> rotation;
+
+		/** The pool that the child nodes of all SceneNodes are allocated from, see Scene::getNodePool(). */
+		static util::ObjectPool<SceneNode> &nodePool();
+		/** Appends an allocated SceneNode as child. */
+		NotNull<SceneNode> adoptChild(SceneNode * node);
+		/** Unlinks a direct child without freeing it. */
+		SceneNode * detachChild(SceneNode * child);
+		/** Replaces the child nodes by copies of the given SceneNode's child nodes. */
+		void copyChildren(const SceneNode &from);
+		/** Frees all child nodes. */
+		void destroyChildren();
+		/** Sets the Scene of this SceneNode and all its child nodes. Handles to SceneNodes that leave their Scene become invalid. */
+		void setScene(Scene * scene);
+		/** Makes the handle of this SceneNode refer to the given SceneNode instead, if both belong to the same Scene. */
+		void passHandle(SceneNode &to);
+		/** Tells the Scene that SceneNodes were added, removed or moved, so that its TransformHierarchy is rebuilt. */
+		void invalidateStructure();
+
+		/** The orientation of this SceneNode, as unit quaternion. */
+		math::fquat_t orientation;
 		/** The scaling of this SceneNode. */
 		math::fvec3_t scaling;
 		/** The position of this SceneNode. */
 		math::fvec3_t position;
 
+		/** The cached transformation relative to the parent node. */
+		mutable math::fmat4x4_t local_transformation;
+		/** The cached transformation relative to the Scene root. */
+		mutable math::fmat4x4_t world_transformation;
+		/** Whether local_transformation is outdated. */
+		mutable bool local_dirty;
+		/** Whether world_transformation is outdated. If set, it is also set in all child nodes, so that only dirty branches are visited. */
+		mutable bool world_dirty;
+
+		/** Marks the transformation of this SceneNode as outdated, after its position, orientation or scaling changed. */
+		void invalidateTransformation();
+		/** Marks the world transformations of this SceneNode and its child nodes as outdated, unless they already are. */
+		void invalidateWorldTransformation();
+
+		/** The cached bounding box of the Models of this SceneNode and its child nodes, relative to the Scene root. */
+		mutable math::faabb_t bounds;
+		/** How many Models this SceneNode and its child nodes have. */
+		mutable size_t model_count;
+		/** Whether a Model of this SceneNode or its child nodes has no bounding box, so that bounds does not contain it. */
+		mutable bool unbounded;
+		/** Whether bounds, model_count and unbounded are outdated. If set, it is also set in all parent nodes, and it is always set while world_dirty is. */
+		mutable bool bounds_dirty;
+
+		/** Recomputes bounds, model_count and unbounded, if they are outdated. */
+		void updateBounds() const;
+	public:
+
 		SceneNode();
+		/** Copies the given SceneNode and its child nodes, but not its parent or handle. */
 		SceneNode(const SceneNode &copy);
+		/** Takes over the child nodes and the handle of the given SceneNode, but not its parent. */
 		SceneNode(SceneNode &&move);
 		virtual ~SceneNode();
 
+		/** Replaces the contents and child nodes of this SceneNode. It keeps its parent and handle. */
 		SceneNode &operator=(const SceneNode &rhs);
+		/** Replaces the contents and child nodes of this SceneNode, and takes over the handle of rhs, if both belong to the same Scene. It keeps its parent. */
 		SceneNode &operator=(SceneNode &&rhs);
 
 		/** Returns the parent SceneNode of this SceneNode, if any. */
@@ -60,11 +139,17 @@ namespace re
 		SceneNode * lastChild();
 		const SceneNode * lastChild() const;
 
+		/** Returns the child at the given index, or null. Takes linear time, so prefer iterating with firstChild() and nextSibling(). */
 		SceneNode * nthChild(size_t child);
 		const SceneNode * nthChild(size_t child) const;
 		size_t children() const;
 
-		/** Releases the direct child SceneNode child, and stores it in out_node, if out_node is set. */
+		/** Returns a handle to this SceneNode, which must belong to a Scene.
+		The handle stays valid while this SceneNode exists and stays in its Scene, no matter how the tree is restructured. */
+		NodeHandle handle();
+
+		/** Releases the direct child SceneNode child, and stores it in out_node, if out_node is set.
+		Handles to the child are passed on to out_node, if it belongs to the same Scene, and become invalid otherwise. */
 		void releaseChild(NotNull<SceneNode> child, SceneNode * out_node);
 
 		/** Adds the given SceneNode to this SceneNode.
@@ -72,22 +157,57 @@ namespace re
 		changes made to the passed SceneNode will not affect this SceneNodes new child.
 		Use the returned NotNull instead to access the copy owned by this SceneNode. */
 		NotNull<SceneNode> addChild(const SceneNode &node);
+		/** Adds the given SceneNode to this SceneNode, taking over its child nodes instead of copying them. */
+		NotNull<SceneNode> addChild(SceneNode &&node);
 
 		void setModel(Shared<Model> model);
 		Shared<Model> getModel();
 		Shared<const Model> getModel() const;
 
-		/** If the new parent is child or a child of child, or this SceneNode, does nothing. */
+		/** Moves a direct child to another parent in constant time, plus the time to invalidate the child's world transformations.
+		The new parent must not be child or a child of child. If it is this SceneNode, does nothing.
+		The child keeps its address and handles. */
 		NotNull<SceneNode> transferChild(NotNull<SceneNode> child, SceneNode &new_parent);
 
 
-		/** Checks whether the passed SceneNode is a child of this SceneNode or any of its children (recursively. */
+		/** Checks whether the passed SceneNode is a child of this SceneNode or any of its children (recursively). Takes time proportional to the depth of the passed SceneNode. */
 		bool isfarchild(NotNull<SceneNode> child) const;
 
-		/** This function calculates the transformation matrix of this SceneNode.
-		Be sure not to call it redundantly. */
-		math::fmat4x4_t getTransformation() const;
+		/** Returns the orientation of this SceneNode, as unit quaternion. */
+		const math::fquat_t &getOrientation() const;
+		/** Sets the orientation of this SceneNode, as unit quaternion. */
+		void setOrientation(const math::fquat_t &orientation);
+		/** Returns the orientation of this SceneNode as Euler angles, as taken by math::Mat4x4::rotation(). */
+		math::Vec3<math::Angle> getRotation() const;
+		/** Sets the orientation of this SceneNode from Euler angles, as taken by math::Mat4x4::rotation(). */
+		void setRotation(const math::Vec3<math::Angle> &rotation);
+		/** Returns the scaling of this SceneNode. */
+		const math::fvec3_t &getScaling() const;
+		/** Sets the scaling of this SceneNode. */
+		void setScaling(const math::fvec3_t &scaling);
+		/** Returns the position of this SceneNode. */
+		const math::fvec3_t &getPosition() const;
+		/** Sets the position of this SceneNode. */
+		void setPosition(const math::fvec3_t &position);
+
+		/** Returns the transformation of this SceneNode relative to its parent node.
+		It is cached, and only recomputed after the position, orientation or scaling changed. */
+		const math::fmat4x4_t &getTransformation() const;
+		/** Returns the transformation of this SceneNode relative to the Scene root, which includes the transformations of all parent nodes.
+		It is cached, and only recomputed after this SceneNode or a parent node changed, or this SceneNode was moved to another parent. If the Scene uses its flattened transform hierarchy, it is copied from there instead, see Scene::setFlatTransforms(). */
+		const math::fmat4x4_t &getWorldTransformation() const;
+
+		/** Marks the bounding box of this SceneNode and its parent nodes as outdated.
+		Has to be called after the vertices of the Model changed, all other changes are tracked. */
+		void invalidateBounds();
+		/** Returns the bounding box of the Models of this SceneNode and its child nodes, relative to the Scene root. Models without a bounding box are not contained, see isBounded().
+		It is cached, and only recomputed after this SceneNode or a child node changed. */
+		const math::faabb_t &getBounds() const;
+		/** Returns how many Models this SceneNode and its child nodes have. */
+		size_t getModelCount() const;
+		/** Returns whether getBounds() contains all Models of this SceneNode and its child nodes. */
+		bool isBounded() const;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
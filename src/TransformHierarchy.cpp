@@ -0,0 +1,347 @@
+#include "TransformHierarchy.hpp"
+#include "Scene.hpp"
+#include "SceneNode.hpp"
+#include "math/SIMD.hpp"
+#include "LogFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace re
+{
+	namespace
+	{
+		/** How many floats describe the upper 3x4 part of a local transformation: three columns and the position. */
+		size_t const k_local_floats = 12;
+
+		/** Loads a column of a matrix. It is copied as a whole, so that the scalar backend does not access it via a pointer to its first element. */
+		REIL math::simd::float4 load_column(const math::fvec4_t &column)
+		{
+			alignas(math::simd::k_float4_alignment) float elements[4];
+			std::memcpy(elements, &column, sizeof(elements));
+			return math::simd::load(elements);
+		}
+
+		/** Stores a column of a matrix, see load_column(). */
+		REIL void store_column(math::fvec4_t &column, math::simd::float4 value)
+		{
+			alignas(math::simd::k_float4_alignment) float elements[4];
+			math::simd::store(elements, value);
+			std::memcpy(&column, elements, sizeof(elements));
+		}
+
+		/** Multiplies a world transformation by a local transformation, given as its upper 3x4 part with the elements `stride` floats apart. */
+		REIL void compose(
+			const math::fmat4x4_t &parent,
+			float const * local,
+			size_t stride,
+			math::fmat4x4_t &world)
+		{
+			using namespace math::simd;
+			float4 const p0 = load_column(parent.v0);
+			float4 const p1 = load_column(parent.v1);
+			float4 const p2 = load_column(parent.v2);
+			float4 const p3 = load_column(parent.v3);
+			math::fvec4_t * const columns[3] = { &world.v0, &world.v1, &world.v2 };
+
+			for(size_t c = 0; c < 3; c++)
+			{
+				float const * const column = local + 3 * c * stride;
+				store_column(*columns[c], madd(p0, splat(column[0]), madd(p1, splat(column[stride]), mul(p2, splat(column[2 * stride])))));
+			}
+			float const * const position = local + 9 * stride;
+			store_column(world.v3, madd(p0, splat(position[0]), madd(p1, splat(position[stride]), madd(p2, splat(position[2 * stride]), p3))));
+		}
+
+		/** Expands the upper 3x4 part of a local transformation, given with the elements `stride` floats apart. */
+		REIL void expand(
+			float const * local,
+			size_t stride,
+			math::fmat4x4_t &world)
+		{
+			world.v0 = math::fvec4_t(local[0], local[stride], local[2 * stride], 0.0f);
+			world.v1 = math::fvec4_t(local[3 * stride], local[4 * stride], local[5 * stride], 0.0f);
+			world.v2 = math::fvec4_t(local[6 * stride], local[7 * stride], local[8 * stride], 0.0f);
+			world.v3 = math::fvec4_t(local[9 * stride], local[10 * stride], local[11 * stride], 1.0f);
+		}
+	}
+
+	uint32_t const TransformHierarchy::kNoParent;
+
+	TransformHierarchy::LocalBlock::LocalBlock()
+	{
+		for(size_t i = 0; i < k_block_size; i++)
+		{
+			position_x[i] = position_y[i] = position_z[i] = 0.0f;
+			orientation_x[i] = orientation_y[i] = orientation_z[i] = 0.0f;
+			orientation_w[i] = 1.0f;
+			scaling_x[i] = scaling_y[i] = scaling_z[i] = 1.0f;
+		}
+	}
+
+	TransformHierarchy::TransformHierarchy(Scene &scene):
+		scene(&scene),
+		generation(0),
+		built(false)
+	{
+	}
+
+	void TransformHierarchy::append(SceneNode &node, uint32_t parent)
+	{
+		uint32_t const index = uint32_t(nodes.size());
+		node.flat_index = index;
+		nodes.push_back(&node);
+		parents.push_back(parent);
+		ends.push_back(0);
+		if(index % k_block_size == 0)
+			locals.push_back(LocalBlock());
+		gather(index);
+
+		for(SceneNode * child = node.firstChild(); child; child = child->nextSibling())
+			append(*child, index);
+		ends[index] = uint32_t(nodes.size());
+	}
+
+	void TransformHierarchy::gather(uint32_t index)
+	{
+		SceneNode const& node = *nodes[index];
+		LocalBlock &block = locals[index / k_block_size];
+		size_t const i = index % k_block_size;
+		block.position_x[i] = node.position.x;
+		block.position_y[i] = node.position.y;
+		block.position_z[i] = node.position.z;
+		block.orientation_x[i] = node.orientation.x;
+		block.orientation_y[i] = node.orientation.y;
+		block.orientation_z[i] = node.orientation.z;
+		block.orientation_w[i] = node.orientation.w;
+		block.scaling_x[i] = node.scaling.x;
+		block.scaling_y[i] = node.scaling.y;
+		block.scaling_z[i] = node.scaling.z;
+	}
+
+	void TransformHierarchy::build()
+	{
+		clear();
+		append(scene->getRoot(), kNoParent);
+
+		size_t const count = nodes.size();
+		world_transformations.resize(count, math::fmat4x4_t::kIdentity);
+		// the root's subtree are all nodes.
+		dirty.assign(count, 0);
+		dirty[0] = 1;
+		dirty_nodes.assign(1, 0);
+
+		generation = scene->structure_generation;
+		built = true;
+	}
+
+	void TransformHierarchy::clear()
+	{
+		built = false;
+		nodes.clear();
+		parents.clear();
+		ends.clear();
+		locals.clear();
+		world_transformations.clear();
+		dirty.clear();
+		dirty_nodes.clear();
+	}
+
+	bool TransformHierarchy::current() const
+	{
+		return built && generation == scene->structure_generation;
+	}
+
+	bool TransformHierarchy::contains(SceneNode const& node) const
+	{
+		// copies of a SceneNode also carry its index, but are not part of the hierarchy.
+		return current()
+			&& node.flat_index < nodes.size()
+			&& nodes[node.flat_index] == &node;
+	}
+
+	size_t TransformHierarchy::size() const
+	{
+		return nodes.size();
+	}
+
+	SceneNode &TransformHierarchy::node(size_t index) const
+	{
+		RE_DBG_ASSERT(current());
+		RE_DBG_ASSERT(index < nodes.size());
+		return *nodes[index];
+	}
+
+	uint32_t TransformHierarchy::parent(size_t index) const
+	{
+		RE_DBG_ASSERT(index < nodes.size());
+		return parents[index];
+	}
+
+	math::fvec3_t TransformHierarchy::getPosition(size_t index) const
+	{
+		RE_DBG_ASSERT(index < nodes.size());
+		LocalBlock const& block = locals[index / k_block_size];
+		size_t const i = index % k_block_size;
+		return math::fvec3_t(block.position_x[i], block.position_y[i], block.position_z[i]);
+	}
+
+	void TransformHierarchy::setPosition(size_t index, const math::fvec3_t &position)
+	{
+		// the SceneNode passes the change on via changed().
+		node(index).setPosition(position);
+	}
+
+	math::fquat_t TransformHierarchy::getOrientation(size_t index) const
+	{
+		RE_DBG_ASSERT(index < nodes.size());
+		LocalBlock const& block = locals[index / k_block_size];
+		size_t const i = index % k_block_size;
+		return math::fquat_t(block.orientation_x[i], block.orientation_y[i], block.orientation_z[i], block.orientation_w[i]);
+	}
+
+	void TransformHierarchy::setOrientation(size_t index, const math::fquat_t &orientation)
+	{
+		node(index).setOrientation(orientation);
+	}
+
+	math::fvec3_t TransformHierarchy::getScaling(size_t index) const
+	{
+		RE_DBG_ASSERT(index < nodes.size());
+		LocalBlock const& block = locals[index / k_block_size];
+		size_t const i = index % k_block_size;
+		return math::fvec3_t(block.scaling_x[i], block.scaling_y[i], block.scaling_z[i]);
+	}
+
+	void TransformHierarchy::setScaling(size_t index, const math::fvec3_t &scaling)
+	{
+		node(index).setScaling(scaling);
+	}
+
+	void TransformHierarchy::changed(SceneNode const& node)
+	{
+		if(!contains(node))
+			return;
+
+		uint32_t const index = node.flat_index;
+		gather(index);
+		if(!dirty[index])
+		{
+			dirty[index] = 1;
+			dirty_nodes.push_back(index);
+		}
+	}
+
+	bool TransformHierarchy::outdated() const
+	{
+		return !dirty_nodes.empty();
+	}
+
+	size_t TransformHierarchy::update()
+	{
+		RE_DBG_ASSERT(current());
+		if(!outdated())
+			return 0;
+
+		// the subtree of a dirty node is the range up to its end. Visiting the dirty nodes in order, the ones within the range of a previous one are already covered.
+		size_t recomputed = 0;
+		uint32_t covered = 0;
+		uint32_t const count = uint32_t(nodes.size());
+		if(dirty_nodes.size() * 8 > count)
+		{
+			// many nodes are dirty: finding them in order is cheaper than sorting them.
+			for(uint32_t i = 0; i < count; i++)
+				if(dirty[i])
+				{
+					dirty[i] = 0;
+					if(i >= covered)
+					{
+						covered = ends[i];
+						recompute(i, covered);
+						recomputed += covered - i;
+					}
+				}
+		} else
+		{
+			std::sort(dirty_nodes.begin(), dirty_nodes.end());
+			for(uint32_t i : dirty_nodes)
+			{
+				dirty[i] = 0;
+				if(i >= covered)
+				{
+					covered = ends[i];
+					recompute(i, covered);
+					recomputed += covered - i;
+				}
+			}
+		}
+		dirty_nodes.clear();
+
+		return recomputed;
+	}
+
+	void TransformHierarchy::recompute(uint32_t begin, uint32_t end)
+	{
+		typedef math::simd::WideLanes L;
+		typedef L::type lanes_t;
+		size_t const width = L::k_width;
+		static_assert(k_block_size % L::k_width == 0, "a block must consist of whole lanes.");
+
+		float local[k_local_floats][width];
+		// converts whole lanes of a block, and composes the nodes of the range within them.
+		for(uint32_t first = begin - begin % uint32_t(width); first < end; first += uint32_t(width))
+		{
+			LocalBlock const& block = locals[first / k_block_size];
+			size_t const lane = first % k_block_size;
+
+			// the same as math::Mat4x4::transformation(), for several nodes at once.
+			lanes_t const x = L::load(block.orientation_x + lane), y = L::load(block.orientation_y + lane);
+			lanes_t const z = L::load(block.orientation_z + lane), w = L::load(block.orientation_w + lane);
+			lanes_t const s = L::div(L::splat(2.0f), L::madd(x, x, L::madd(y, y, L::madd(z, z, L::mul(w, w)))));
+			lanes_t const xs = L::mul(x, s), ys = L::mul(y, s), zs = L::mul(z, s);
+			lanes_t const xx = L::mul(x, xs), yy = L::mul(y, ys), zz = L::mul(z, zs);
+			lanes_t const xy = L::mul(x, ys), xz = L::mul(x, zs), yz = L::mul(y, zs);
+			lanes_t const wx = L::mul(w, xs), wy = L::mul(w, ys), wz = L::mul(w, zs);
+			lanes_t const one = L::splat(1.0f);
+
+			lanes_t const sx = L::load(block.scaling_x + lane), sy = L::load(block.scaling_y + lane), sz = L::load(block.scaling_z + lane);
+			L::store(local[0], L::mul(L::sub(one, L::add(yy, zz)), sx));
+			L::store(local[1], L::mul(L::add(xy, wz), sx));
+			L::store(local[2], L::mul(L::sub(xz, wy), sx));
+			L::store(local[3], L::mul(L::sub(xy, wz), sy));
+			L::store(local[4], L::mul(L::sub(one, L::add(xx, zz)), sy));
+			L::store(local[5], L::mul(L::add(yz, wx), sy));
+			L::store(local[6], L::mul(L::add(xz, wy), sz));
+			L::store(local[7], L::mul(L::sub(yz, wx), sz));
+			L::store(local[8], L::mul(L::sub(one, L::add(xx, yy)), sz));
+			L::store(local[9], L::load(block.position_x + lane));
+			L::store(local[10], L::load(block.position_y + lane));
+			L::store(local[11], L::load(block.position_z + lane));
+
+			// parents precede their children, so their world transformations are up to date.
+			uint32_t const from = std::max(first, begin);
+			uint32_t const to = std::min(first + uint32_t(width), end);
+			for(uint32_t index = from; index < to; index++)
+			{
+				size_t const j = index - first;
+				uint32_t const parent = parents[index];
+				math::fmat4x4_t &world = world_transformations[index];
+				if(parent == kNoParent)
+					expand(&local[0][j], width, world);
+				else
+					compose(world_transformations[parent], &local[0][j], width, world);
+			}
+		}
+	}
+
+	const math::fmat4x4_t &TransformHierarchy::getWorldTransformation(size_t index) const
+	{
+		RE_DBG_ASSERT(index < nodes.size());
+		return world_transformations[index];
+	}
+
+	const math::fmat4x4_t * TransformHierarchy::worldTransformations() const
+	{
+		return world_transformations.data();
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef __re_transformhierarchy_hpp_defined
+#define __re_transformhierarchy_hpp_defined
+
+#include "math/Vector.hpp"
+#include "math/Matrix.hpp"
+#include "util/AlignedAllocator.hpp"
+#include "types.hpp"
+#include "defines.hpp"
+
+#include <vector>
+
+namespace re
+{
+	class Scene;
+	class SceneNode;
+
+	/** A flattened copy of the SceneNode tree of a Scene, whose transformations are stored in contiguous arrays, so that the world transformations are updated in linear passes instead of by chasing pointers through the tree.
+	The nodes are stored in depth-first order, so that parents precede their children and every subtree is a contiguous range of nodes. The positions, orientations and scalings are stored in blocks of consecutive nodes, with one array per coordinate, and are converted to matrices several nodes at once. The blocks keep the data of a single node close together, so that updating a few scattered nodes does not touch ten separate arrays.
+	The SceneNodes remain the authority: changing a SceneNode's position, orientation or scaling also changes it here. update() only writes the world transformations to the arrays, as writing them into every SceneNode would cost more than computing them. A SceneNode copies its world transformation from here when it is asked for it, see SceneNode::getWorldTransformation().
+	The hierarchy is owned by its Scene, which rebuilds it after nodes were added, removed or moved, see Scene::setFlatTransforms(). */
+	class TransformHierarchy
+	{
+		/** How many nodes share a LocalBlock. */
+		static size_t const k_block_size = 8;
+
+		/** The positions, orientations and scalings of k_block_size consecutive nodes. */
+		struct LocalBlock
+		{
+			/** Fills the block with identity transformations, so that unused nodes are still valid. */
+			LocalBlock();
+
+			float position_x[k_block_size], position_y[k_block_size], position_z[k_block_size];
+			/** The orientations, as quaternions. */
+			float orientation_x[k_block_size], orientation_y[k_block_size], orientation_z[k_block_size], orientation_w[k_block_size];
+			float scaling_x[k_block_size], scaling_y[k_block_size], scaling_z[k_block_size];
+		};
+
+		/** The Scene whose SceneNodes are flattened. */
+		Scene * scene;
+		/** The structure generation of the Scene when the hierarchy was built. */
+		uint32_t generation;
+		/** Whether the hierarchy was built at all. */
+		bool built;
+
+		/** The SceneNodes, in hierarchy order. */
+		std::vector<SceneNode *> nodes;
+		/** The index of the parent of each node, or kNoParent. */
+		std::vector<uint32_t> parents;
+		/** The index after the last node of each node's subtree. */
+		std::vector<uint32_t> ends;
+		/** The positions, orientations and scalings of the nodes. */
+		util::AlignedVector<LocalBlock> locals;
+		/** The transformation of each node relative to the Scene root. */
+		util::AlignedVector<math::fmat4x4_t> world_transformations;
+
+		/** Whether the position, orientation or scaling of each node changed since the last update(). */
+		std::vector<uint8_t> dirty;
+		/** The dirty nodes, so that update() does not have to look at the clean ones. */
+		std::vector<uint32_t> dirty_nodes;
+
+		/** Appends a SceneNode and its child nodes. */
+		void append(SceneNode &node, uint32_t parent);
+		/** Copies the position, orientation and scaling of the node at the given index from its SceneNode. */
+		void gather(uint32_t index);
+		/** Recomputes the world transformations of a range of nodes, whose parents are outside of the range or precede their children in it. */
+		void recompute(uint32_t begin, uint32_t end);
+	public:
+		/** The parent index of the root. */
+		static uint32_t const kNoParent = ~uint32_t(0);
+
+		TransformHierarchy(Scene &scene);
+
+		/** Flattens the Scene's SceneNodes, replacing the previous contents. All nodes are dirty afterwards. */
+		void build();
+		/** Clears the hierarchy. */
+		void clear();
+		/** Returns whether the hierarchy matches the structure of its Scene. The SceneNodes and indices of a hierarchy that is not current must not be used. */
+		bool current() const;
+
+		/** Returns whether the given SceneNode is part of the hierarchy, and the hierarchy is current. */
+		bool contains(SceneNode const& node) const;
+
+		/** Returns how many nodes there are. */
+		size_t size() const;
+		/** Returns the SceneNode at the given index. */
+		SceneNode &node(size_t index) const;
+		/** Returns the index of the parent of the node at the given index, or kNoParent for the root. */
+		uint32_t parent(size_t index) const;
+
+		/** Returns the position of the node at the given index. */
+		math::fvec3_t getPosition(size_t index) const;
+		/** Sets the position of the node at the given index, and of its SceneNode. */
+		void setPosition(size_t index, const math::fvec3_t &position);
+		/** Returns the orientation of the node at the given index. */
+		math::fquat_t getOrientation(size_t index) const;
+		/** Sets the orientation of the node at the given index, and of its SceneNode. */
+		void setOrientation(size_t index, const math::fquat_t &orientation);
+		/** Returns the scaling of the node at the given index. */
+		math::fvec3_t getScaling(size_t index) const;
+		/** Sets the scaling of the node at the given index, and of its SceneNode. */
+		void setScaling(size_t index, const math::fvec3_t &scaling);
+
+		/** Called by a SceneNode whose position, orientation or scaling changed: copies them, and marks the node dirty. Ignored while the hierarchy is not current, or if the SceneNode is not part of it. */
+		void changed(SceneNode const& node);
+
+		/** Returns whether any node changed since the last update(). */
+		bool outdated() const;
+		/** Recomputes the world transformations of the dirty nodes and their subtrees. As every subtree is a contiguous range of nodes, clean nodes are not visited.
+		@return
+			How many world transformations were recomputed. */
+		size_t update();
+		/** Returns the world transformation of the node at the given index, as of the last update(). */
+		const math::fmat4x4_t &getWorldTransformation(size_t index) const;
+		/** Returns the world transformations of all nodes, as of the last update(). */
+		const math::fmat4x4_t * worldTransformations() const;
+	};
+}
+
+#endif
@@ -100,7 +100,21 @@ namespace re
 			Component component,
 			uint32_t size)
 		{
-			m_data = realloc(m_data, size * size_of(channel, component));
+			// cache line alignment lets SIMD code process whole lines.
+			size_t const bytes = size * size_of(channel, component);
+			void * const data = re::aligned_malloc(bytes, k_cache_line);
+			RE_ASSERT(data || !bytes);
+
+			if(exists())
+			{
+				std::memcpy(
+					data,
+					m_data,
+					bytes < byte_size() ? bytes : byte_size());
+				re::free(m_data);
+			}
+
+			m_data = data;
 			m_size = size;
 			m_channel = channel;
 			m_component = component;
@@ -110,7 +124,7 @@ namespace re
 		{
 			if(exists())
 			{
-				std::free(m_data);
+				re::free(m_data);
 				m_data = nullptr;
 			}
 		}
@@ -5,6 +5,7 @@
 
 #include "../LogFile.hpp"
 #include "../util/Error.hpp"
+#include "../util/FrameArena.hpp"
 
 namespace re
 {
@@ -566,6 +567,15 @@ namespace re
 				glfwMakeContextCurrent(m_handle), make_current(*m_context);
 		}
 
+		void Window::begin_frame()
+		{
+			util::FrameArena &arena = util::FrameArena::local();
+			RE_DBG_ASSERT(!arena.scopes()
+				&& "A frame began while a FrameArena::Scope is open.");
+
+			arena.reset();
+		}
+
 		void Window::swap_buffers()
 		{
 			RE_DBG_ASSERT(exists() &&
@@ -114,6 +114,12 @@ namespace re
 			@assert The Window must exist. */
 			REIL gl::Context const& context() const;
 
+			/** Marks the beginning of a frame on the calling thread.
+				Releases the scratch memory of the last frame, see util::FrameArena::local(). Call it once per iteration of the main loop, before updating and drawing, so that all Renderers and UI nodes drawn in between share the frame's memory.
+			@assert
+				No util::FrameArena::Scope of the calling thread may be open. */
+			static void begin_frame();
+
 		protected:
 
 			/** Creates the Window handle with the given arguments.
@@ -63,9 +63,9 @@ namespace re
 					return;
 
 				RE_DBG_ASSERT(buffers != nullptr);
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
-				alloc_handles(handles, count);
+				alloc_handles(handles.data(), count);
 
 				for(size_t i = count; i--;)
 				{
@@ -94,7 +94,7 @@ namespace re
 
 				RE_DBG_ASSERT(buffers != nullptr);
 
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
 				for(size_t i = count; i--;)
 				{
@@ -108,7 +108,7 @@ namespace re
 					buffers[i]->null_handle();
 				}
 
-				destroy_handles(handles, count);
+				destroy_handles(handles.data(), count);
 			}
 
 
@@ -8,6 +8,7 @@
 #include "Binding.hpp"
 
 #include "../../util/Lookup.hpp"
+#include "../../util/AlignedAllocator.hpp"
 
 namespace re
 {
@@ -115,7 +116,8 @@ namespace re
 			template<class Vertex>
 			class VertexBuffer : public Buffer
 			{
-				std::vector<Vertex> m_data;
+				/** The vertices, aligned for SIMD processing. */
+				util::AlignedVector<Vertex> m_data;
 			public:
 				REIL VertexBuffer(
 					BufferAccess access,
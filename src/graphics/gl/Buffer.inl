@@ -55,7 +55,7 @@ namespace re
 					data.size(),
 					sizeof(Vertex));
 
-				m_data = std::move(data);
+				m_data.assign(data.begin(), data.end());
 			}
 
 			REIL IndexBuffer::IndexBuffer(
@@ -74,9 +74,9 @@ namespace re
 
 			void FrameBuffer::alloc(FrameBuffer * objects, size_t count)
 			{
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
-				RE_OGL(glGenFramebuffers(count, handles));
+				RE_OGL(glGenFramebuffers(count, handles.data()));
 
 				for(size_t i = count; i--;)
 				{
@@ -89,7 +89,7 @@ namespace re
 
 			void FrameBuffer::destroy(FrameBuffer * objects, size_t count)
 			{
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
 				for(size_t i = count; i--;)
 				{
@@ -112,7 +112,7 @@ namespace re
 					objects[i].null_handle();
 				}
 
-				RE_OGL(glDeleteFramebuffers(count, handles));
+				RE_OGL(glDeleteFramebuffers(count, handles.data()));
 			}
 
 			void FrameBuffer::blit(
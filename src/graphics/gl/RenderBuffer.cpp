@@ -15,8 +15,8 @@ namespace re
 			{
 				RE_DBG_ASSERT(objects != nullptr);
 
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
-				RE_OGL(glGenRenderbuffers(count, handles));
+				util::AllocationBuffer<handle_t> handles(count);
+				RE_OGL(glGenRenderbuffers(count, handles.data()));
 
 				for(size_t i = count; i--;)
 				{
@@ -34,7 +34,7 @@ namespace re
 			{
 				RE_DBG_ASSERT(objects != nullptr);
 
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
 				for(size_t i = count; i--;)
 				{
@@ -42,7 +42,7 @@ namespace re
 					handles[i] = objects[i]->handle();
 				}
 
-				RE_OGL(glDeleteRenderbuffers(count, handles));
+				RE_OGL(glDeleteRenderbuffers(count, handles.data()));
 
 				for(size_t i = count; i--;)
 				{
@@ -79,9 +79,9 @@ namespace re
 			{
 				RE_DBG_ASSERT(textures);
 
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
-				RE_OGL(glGenTextures(count, handles));
+				RE_OGL(glGenTextures(count, handles.data()));
 
 				for(size_t i = count; i--;)
 				{
@@ -103,7 +103,7 @@ namespace re
 			{
 				RE_DBG_ASSERT(textures);
 
-				handle_t * const handles = util::allocation_buffer<handle_t>(count);
+				util::AllocationBuffer<handle_t> handles(count);
 
 				for(size_t i = count; i--;)
 				{
@@ -116,7 +116,7 @@ namespace re
 					s_binding[textures[i]->type()].on_invalidate(textures[i]->handle());
 				}
 
-				RE_OGL(glDeleteTextures(count, handles));
+				RE_OGL(glDeleteTextures(count, handles.data()));
 			}
 
 			void Texture::set_mag_filter(
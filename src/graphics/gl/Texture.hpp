@@ -141,7 +141,7 @@ namespace re
 					How many Textures to allocate.
 				@sideeffect
 					Allocates the Handle held by each passed Texture.
-				@see `util::allocation_buffer()`. */
+				@see `util::AllocationBuffer`. */
 				static void alloc(
 					Texture * const * textures,
 					size_t count);
@@ -158,7 +158,7 @@ namespace re
 				@sideeffect
 					Destroys the Handle held by each passed Texture.
 					Unbinds a bound Texture when it is destroyed.
-				@see `util::allocation_buffer()`. */
+				@see `util::AllocationBuffer`. */
 				static void destroy(
 					Texture ** textures,
 					size_t count);
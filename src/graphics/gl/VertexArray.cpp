@@ -15,7 +15,8 @@ namespace re
 				Handle(),
 				m_vertex(BufferType::Array, access, usage),
 				m_index(BufferType::ElementArray, access, usage),
-				m_index_used(false)
+				m_index_used(false),
+				m_aabb(math::empty)
 			{
 			}
 			VertexArrayBase::VertexArrayBase(
@@ -23,7 +24,8 @@ namespace re
 				Handle(std::move(move)),
 				m_vertex(std::move(move.m_vertex)),
 				m_index(std::move(move.m_index)),
-				m_index_used(move.m_index_used)
+				m_index_used(move.m_index_used),
+				m_aabb(move.m_aabb)
 			{
 			}
 
@@ -36,6 +38,7 @@ namespace re
 					m_vertex = std::move(move.m_vertex);
 					m_index = std::move(move.m_index);
 					m_index_used = move.m_index_used;
+					m_aabb = move.m_aabb;
 				}
 				return *this;
 			}
@@ -65,9 +68,9 @@ namespace re
 				RE_DBG_ASSERT(arrays != nullptr);
 
 				// need 2 times the capacity to also allocate vertex + index buffers.
-				handle_t * const buffer = util::allocation_buffer<handle_t>(count << 1);
+				util::AllocationBuffer<handle_t> buffer(count << 1);
 				// alloc vertex arrays.
-				VertexArrayBase::alloc_handles(buffer, count);
+				VertexArrayBase::alloc_handles(buffer.data(), count);
 
 				for(size_t i = count; i--;)
 				{
@@ -79,7 +82,7 @@ namespace re
 				}
 
 				// alloc vertex and index buffers, reuse previous buffer.
-				Buffer::alloc_handles(buffer, count << 1);
+				Buffer::alloc_handles(buffer.data(), count << 1);
 				for(size_t i = count; i--;)
 				{
 					RE_DBG_ASSERT(!arrays[i]->m_vertex.exists() &&
@@ -108,7 +111,7 @@ namespace re
 				VertexArrayBase * const * arrays,
 				size_t count)
 			{
-				handle_t * const buffer = util::allocation_buffer<handle_t>(count << 1);
+				util::AllocationBuffer<handle_t> buffer(count << 1);
 				for(size_t i = count; i--;)
 				{
 					RE_DBG_ASSERT(arrays[i] != nullptr);
@@ -123,7 +126,7 @@ namespace re
 					arrays[i]->m_index.null_handle();
 				}
 
-				Buffer::destroy_handles(buffer, count << 1);
+				Buffer::destroy_handles(buffer.data(), count << 1);
 
 				for(size_t i = count; i--;)
 				{
@@ -134,7 +137,7 @@ namespace re
 					arrays[i]->null_handle();
 				}
 
-				destroy_handles(buffer, count);
+				destroy_handles(buffer.data(), count);
 			}
 
 			void VertexArrayBase::configure(
@@ -173,6 +176,8 @@ namespace re
 				m_vertex.data(vertex_data, vertices, type_size);
 				m_index_used = false;
 				m_render_mode = render_mode;
+				// the positions are unknown without the vertex type.
+				m_aabb = math::faabb_t(math::empty);
 			}
 
 			void VertexArrayBase::set_data(
@@ -188,6 +193,7 @@ namespace re
 				m_index.data(index_data, indices, sizeof(index_data[0]));
 				m_index_used = true;
 				m_render_mode = render_mode;
+				m_aabb = math::faabb_t(math::empty);
 			}
 
 			void VertexArrayBase::draw(size_t count, size_t start)
@@ -5,6 +5,7 @@
 #include "../../defines.hpp"
 #include "Handle.hpp"
 #include "Buffer.hpp"
+#include "../../util/AlignedAllocator.hpp"
 
 #include "../../math/AxisAlignedBoundingBox.hpp"
 
@@ -83,6 +84,9 @@ namespace re
 				size_t m_index_count;
 				/** How many vertices the array currently has. */
 				size_t m_vertex_count;
+			protected:
+				/** The bounding box of the vertices, or empty if unknown. */
+				math::faabb_t m_aabb;
 			public:
 				/** Creates an invalid handle. */
 				VertexArrayBase(
@@ -113,6 +117,8 @@ namespace re
 				REIL size_t element_count() const;
 				/** @return Whether the index buffer is used. */
 				REIL bool index_used() const;
+				/** @return The bounding box of the vertices. Empty if the vertices were set without their type, or there are none. */
+				REIL math::faabb_t const& aabb() const;
 
 				/** Binds the vertex array to select it for future OpenGL calls. */
 				void bind();
@@ -200,10 +206,16 @@ namespace re
 
 
 			template<class Vertex>
+			/** A VertexArray of a specific vertex type, which must have a `position` member of type `math::fvec2_t`, `math::fvec3_t` or `math::fvec4_t`.
+				Setting the vertices also computes their bounding box. */
 			class VertexArray : public VertexArrayBase
 			{
-				std::vector<Vertex> m_data;
-				math::faabb_t m_aabb;
+				/** The vertices, aligned for SIMD processing. */
+				util::AlignedVector<Vertex> m_data;
+				/** Sets the bounding box to contain the given vertices. */
+				void compute_aabb(
+					Vertex const * vertex_data,
+					size_t vertices);
 			protected:
 				void configure(VertexType<Vertex> const& type_description);
 			public:
@@ -241,8 +253,6 @@ namespace re
 					std::vector<index_t> index_data);
 
 				using VertexArrayBase::draw;
-
-				math::faabb_t const& aabb() const;
 			};
 		}
 	}
@@ -5,6 +5,22 @@ namespace re
 	{
 		namespace gl
 		{
+			namespace detail
+			{
+				/** The 3D position of a vertex, for its bounding box. */
+				REIL math::fvec3_t position3(math::fvec2_t const& position)
+				{
+					return math::fvec3_t(position.x, position.y, 0.0f);
+				}
+				REIL math::fvec3_t position3(math::fvec3_t const& position)
+				{
+					return position;
+				}
+				REIL math::fvec3_t position3(math::fvec4_t const& position)
+				{
+					return math::fvec3_t(position.x, position.y, position.z);
+				}
+			}
 
 			RECX VertexElement::VertexElement(
 				ElementType type,
@@ -55,6 +71,11 @@ namespace re
 				return m_index_used;
 			}
 
+			REIL math::faabb_t const& VertexArrayBase::aabb() const
+			{
+				return m_aabb;
+			}
+
 			REIL void VertexArrayBase::draw()
 			{
 				RE_DBG_ASSERT(exists());
@@ -65,8 +86,7 @@ namespace re
 			RECX VertexArray<Vertex>::VertexArray(
 				BufferAccess access,
 				BufferUsage usage):
-				VertexArrayBase(access, usage),
-				m_aabb(math::empty)
+				VertexArrayBase(access, usage)
 			{
 			}
 
@@ -75,13 +95,13 @@ namespace re
 			{
 				RE_DBG_ASSERT(arrays != nullptr);
 
-				VertexArrayBase ** buffer = util::allocation_buffer<VertexArrayBase *>(count);
+				util::AllocationBuffer<VertexArrayBase *> buffer(count);
 				for(size_t i = count; i--;)
 				{
 					RE_DBG_ASSERT(arrays[i] != nullptr);
 					buffer[i] = arrays[i];
 				}
-				VertexArrayBase::alloc(buffer, count);
+				VertexArrayBase::alloc(buffer.data(), count);
 
 				for(size_t i = count; i--;)
 					arrays[i]->configure(Vertex::type);
@@ -92,10 +112,10 @@ namespace re
 			{
 				RE_DBG_ASSERT(arrays != nullptr);
 
-				VertexArrayBase ** buffer = util::allocation_buffer<VertexArrayBase *>(count);
+				util::AllocationBuffer<VertexArrayBase *> buffer(count);
 				for(size_t i = count; i--;)
 					buffer[i] = arrays[i];
-				VertexArrayBase::destroy(buffer, count);
+				VertexArrayBase::destroy(buffer.data(), count);
 			}
 
 			template<class Vertex>
@@ -122,6 +142,17 @@ namespace re
 						type_description.VERTEX_SIZE);
 			}
 
+			template<class Vertex>
+			void VertexArray<Vertex>::compute_aabb(
+				Vertex const * vertex_data,
+				size_t vertices)
+			{
+				math::faabb_t aabb(math::empty);
+				for(size_t i = 0; i < vertices; i++)
+					aabb |= detail::position3(vertex_data[i].position);
+				m_aabb = aabb;
+			}
+
 			template<class Vertex>
 			void VertexArray<Vertex>::set_data(
 				Vertex const * vertex_data,
@@ -134,6 +165,7 @@ namespace re
 						vertices,
 						sizeof(Vertex),
 						render_mode);
+				compute_aabb(vertex_data, vertices);
 			}
 
 			template<class Vertex>
@@ -147,6 +179,7 @@ namespace re
 				if(!indices)
 					set_data(vertex_data, vertices, render_mode);
 				else
+				{
 					static_cast<VertexArrayBase*>(this)
 						->set_data(
 							vertex_data,
@@ -155,6 +188,30 @@ namespace re
 							render_mode,
 							index_data,
 							indices);
+					compute_aabb(vertex_data, vertices);
+				}
+			}
+
+			template<class Vertex>
+			void VertexArray<Vertex>::set_data(
+				std::vector<Vertex> vertex_data,
+				RenderMode render_mode)
+			{
+				set_data(vertex_data.data(), vertex_data.size(), render_mode);
+			}
+
+			template<class Vertex>
+			void VertexArray<Vertex>::set_data(
+				std::vector<Vertex> vertex_data,
+				RenderMode render_mode,
+				std::vector<index_t> index_data)
+			{
+				set_data(
+					vertex_data.data(),
+					vertex_data.size(),
+					render_mode,
+					index_data.data(),
+					index_data.size());
 			}
 		}
 	}
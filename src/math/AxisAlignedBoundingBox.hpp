@@ -109,9 +109,9 @@ namespace re
 		template<class T>
 		AxisAlignedBoundingBox<T>::AxisAlignedBoundingBox(
 			Vec3<T> const& point):
+			_empty(false),
 			_min(point),
-			_max(point),
-			_empty(false)
+			_max(point)
 		{
 		}
 
@@ -119,18 +119,18 @@ namespace re
 		AxisAlignedBoundingBox<T>::AxisAlignedBoundingBox(
 			Vec3<T> const& min,
 			Vec3<T> const& max):
+			_empty(min.x>max.x || min.y>max.y || min.z>max.z),
 			_min(min),
-			_max(max),
-			_empty(_min.x>_max.x || _min.y>_max.y || _min.z>_max.z)
+			_max(max)
 		{
 		}
 
 		template<class T>
 		AxisAlignedBoundingBox<T>::AxisAlignedBoundingBox(
 			empty_t):
+			_empty(true),
 			_min(),
-			_max(),
-			_empty(true)
+			_max()
 		{
 		}
 
@@ -0,0 +1,580 @@
+#include "Bvh.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace re
+{
+	namespace math
+	{
+		static_assert(sizeof(BvhNode) == 32, "nodes must stay compact.");
+
+		namespace
+		{
+			/** The most bins that are evaluated per axis. */
+			size_t const k_max_bins = 64;
+			/** Below this depth, nodes are split by the surface area heuristic, and then at the median, so that traversal never needs more than 64 stack entries for 2^24 triangles. */
+			size_t const k_max_sah_depth = 32;
+			/** The cost of visiting a node, relative to intersecting a triangle. */
+			float const k_traversal_cost = 1.0f;
+
+			/** Bounds that are cheaper to grow than AxisAlignedBoundingBox. */
+			struct Bounds
+			{
+				float min[3], max[3];
+
+				void clear()
+				{
+					min[0] = min[1] = min[2] = std::numeric_limits<float>::infinity();
+					max[0] = max[1] = max[2] = -std::numeric_limits<float>::infinity();
+				}
+
+				void grow(float const * point)
+				{
+					for(size_t a = 0; a < 3; a++)
+					{
+						min[a] = std::min(min[a], point[a]);
+						max[a] = std::max(max[a], point[a]);
+					}
+				}
+
+				void grow(Bounds const& other)
+				{
+					for(size_t a = 0; a < 3; a++)
+					{
+						min[a] = std::min(min[a], other.min[a]);
+						max[a] = std::max(max[a], other.max[a]);
+					}
+				}
+
+				/** Half the surface area, which is proportional to the probability of a ray hitting the box. */
+				float half_area() const
+				{
+					float const x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+					return (x < 0.0f) ? 0.0f : x * y + y * z + z * x;
+				}
+			};
+
+			REIL fvec3_t const& vertex(
+				fvec3_t const * positions,
+				size_t stride,
+				size_t index)
+			{
+				return *reinterpret_cast<fvec3_t const *>(
+					reinterpret_cast<char const *>(positions) + index * stride);
+			}
+
+			/** Reads the corners of a triangle. */
+			REIL void triangle_corners(
+				fvec3_t const * positions,
+				size_t stride,
+				uint32_t const * indices,
+				size_t triangle,
+				fvec3_t (&corners)[3])
+			{
+				for(size_t i = 0; i < 3; i++)
+					corners[i] = vertex(positions, stride, indices ? indices[3 * triangle + i] : 3 * triangle + i);
+			}
+
+			/** The state shared by all threads of a build. */
+			struct Builder
+			{
+				BvhSettings settings;
+				/** The bounds of each source triangle. */
+				std::vector<Bounds> bounds;
+				/** The centroid of each source triangle. */
+				std::vector<float> centroids;
+				/** The source triangles, which are partitioned into the order of the leaves. */
+				uint32_t * order;
+				BvhNode * nodes;
+				/** The next unused node. */
+				std::atomic<uint32_t> next_node;
+
+				/** Makes a node into a leaf over the given triangles. */
+				void make_leaf(
+					BvhNode &node,
+					size_t begin,
+					size_t end)
+				{
+					node.first = uint32_t(begin);
+					node.count = uint32_t(end - begin);
+				}
+
+				/** Splits the triangles at the median centroid along the given axis, and returns the split position. */
+				size_t median_split(
+					size_t begin,
+					size_t end,
+					size_t axis)
+				{
+					size_t const middle = begin + (end - begin) / 2;
+					float const * const c = centroids.data();
+					std::nth_element(order + begin, order + middle, order + end,
+						[c, axis](uint32_t a, uint32_t b) {
+							return c[3 * a + axis] < c[3 * b + axis];
+						});
+					return middle;
+				}
+
+				/** Builds the subtree of a node, whose bounds are not yet known.
+				@param[in] index:
+					The node.
+				@param[in] begin:
+					The first triangle of the node, in `order`.
+				@param[in] end:
+					The end of the triangles of the node, in `order`.
+				@param[in] depth:
+					The depth of the node.
+				@param[in] threads:
+					How many threads may work on the subtree. */
+				void build(
+					uint32_t index,
+					size_t begin,
+					size_t end,
+					size_t depth,
+					size_t threads)
+				{
+					Bounds node_bounds, centroid_bounds;
+					node_bounds.clear();
+					centroid_bounds.clear();
+					for(size_t i = begin; i < end; i++)
+					{
+						uint32_t const triangle = order[i];
+						node_bounds.grow(bounds[triangle]);
+						centroid_bounds.grow(&centroids[3 * triangle]);
+					}
+
+					BvhNode &node = nodes[index];
+					for(size_t a = 0; a < 3; a++)
+					{
+						node.min[a] = node_bounds.min[a];
+						node.max[a] = node_bounds.max[a];
+					}
+
+					size_t const count = end - begin;
+					if(count == 1)
+					{
+						make_leaf(node, begin, end);
+						return;
+					}
+
+					size_t largest_axis = 0;
+					for(size_t a = 1; a < 3; a++)
+						if(centroid_bounds.max[a] - centroid_bounds.min[a]
+						> centroid_bounds.max[largest_axis] - centroid_bounds.min[largest_axis])
+							largest_axis = a;
+
+					size_t middle = begin;
+					if(depth < k_max_sah_depth)
+					{
+						size_t const bin_count = settings.bins;
+						float best_cost = std::numeric_limits<float>::infinity();
+						size_t best_axis = 0, best_split = 0;
+						float best_scale = 0.0f;
+
+						for(size_t axis = 0; axis < 3; axis++)
+						{
+							float const extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+							if(!(extent > 0.0f))
+								continue;
+							float const scale = float(bin_count) / extent;
+							float const offset = centroid_bounds.min[axis];
+
+							Bounds bin_bounds[k_max_bins];
+							size_t bin_size[k_max_bins] = {};
+							for(size_t b = 0; b < bin_count; b++)
+								bin_bounds[b].clear();
+
+							for(size_t i = begin; i < end; i++)
+							{
+								uint32_t const triangle = order[i];
+								size_t const b = std::min(bin_count - 1,
+									size_t((centroids[3 * triangle + axis] - offset) * scale));
+								bin_bounds[b].grow(bounds[triangle]);
+								bin_size[b]++;
+							}
+
+							// the cost of everything left of each split, then right of it.
+							float left_cost[k_max_bins];
+							Bounds sweep;
+							sweep.clear();
+							size_t sweep_size = 0;
+							for(size_t b = 0; b + 1 < bin_count; b++)
+							{
+								sweep.grow(bin_bounds[b]);
+								sweep_size += bin_size[b];
+								left_cost[b] = sweep.half_area() * float(sweep_size);
+							}
+							sweep.clear();
+							sweep_size = 0;
+							for(size_t b = bin_count - 1; b > 0; b--)
+							{
+								sweep.grow(bin_bounds[b]);
+								sweep_size += bin_size[b];
+								float const cost = left_cost[b-1] + sweep.half_area() * float(sweep_size);
+								if(sweep_size && sweep_size != count && cost < best_cost)
+								{
+									best_cost = cost;
+									best_axis = axis;
+									best_split = b;
+									best_scale = scale;
+								}
+							}
+						}
+
+						float const leaf_cost = float(count);
+						float const area = node_bounds.half_area();
+						bool const splittable = best_cost < std::numeric_limits<float>::infinity();
+						float const split_cost = splittable
+							? k_traversal_cost + (area > 0.0f ? best_cost / area : float(count))
+							: std::numeric_limits<float>::infinity();
+
+						if(count <= settings.max_leaf_size && leaf_cost <= split_cost)
+						{
+							make_leaf(node, begin, end);
+							return;
+						}
+
+						if(splittable)
+						{
+							float const offset = centroid_bounds.min[best_axis];
+							float const * const c = centroids.data();
+							size_t const last_bin = bin_count - 1;
+							middle = std::partition(order + begin, order + end,
+								[=](uint32_t triangle) {
+									return std::min(last_bin, size_t((c[3 * triangle + best_axis] - offset) * best_scale)) < best_split;
+								}) - order;
+						}
+					} else if(count <= settings.max_leaf_size)
+					{
+						make_leaf(node, begin, end);
+						return;
+					}
+
+					// all centroids coincide, or the tree got too deep.
+					if(middle == begin || middle == end)
+						middle = median_split(begin, end, largest_axis);
+
+					uint32_t const children = next_node.fetch_add(2, std::memory_order_relaxed);
+					node.first = children;
+					node.count = 0;
+
+					if(threads > 1 && settings.parallel_threshold && count >= settings.parallel_threshold)
+					{
+						size_t const left_threads = threads / 2;
+						std::thread left(&Builder::build, this, children, begin, middle, depth + 1, left_threads);
+						build(children + 1, middle, end, depth + 1, threads - left_threads);
+						left.join();
+					} else
+					{
+						build(children, begin, middle, depth + 1, threads);
+						build(children + 1, middle, end, depth + 1, threads);
+					}
+				}
+			};
+
+			/** The reciprocal direction of a ray, for the slab test. */
+			struct SlabRay
+			{
+				float origin[3];
+				float inverse_direction[3];
+
+				SlabRay(
+					Ray<float> const& ray)
+				{
+					origin[0] = ray.position.x;
+					origin[1] = ray.position.y;
+					origin[2] = ray.position.z;
+					inverse_direction[0] = 1.0f / ray.direction.x;
+					inverse_direction[1] = 1.0f / ray.direction.y;
+					inverse_direction[2] = 1.0f / ray.direction.z;
+				}
+
+				/** Returns whether the ray enters a node before `max_distance`, and where. NaNs from rays inside a slab plane are ignored by the order of the min and max arguments. */
+				REIL bool hits(
+					BvhNode const& node,
+					float max_distance,
+					float &distance) const
+				{
+					float t_near = 0.0f, t_far = max_distance;
+					for(size_t a = 0; a < 3; a++)
+					{
+						float const t1 = (node.min[a] - origin[a]) * inverse_direction[a];
+						float const t2 = (node.max[a] - origin[a]) * inverse_direction[a];
+						t_near = std::max(t_near, std::min(t1, t2));
+						t_far = std::min(t_far, std::max(t1, t2));
+					}
+					distance = t_near;
+					return t_near <= t_far && t_near < max_distance;
+				}
+			};
+
+			/** Enough for the depth that the build guarantees. */
+			size_t const k_stack_size = 64;
+		}
+
+		BvhSettings::BvhSettings():
+			max_leaf_size(4),
+			bins(16),
+			parallel_threshold(16384)
+		{
+		}
+
+		BvhSettings::BvhSettings(
+			size_t max_leaf_size,
+			size_t bins,
+			size_t parallel_threshold):
+			max_leaf_size(max_leaf_size),
+			bins(bins),
+			parallel_threshold(parallel_threshold)
+		{
+		}
+
+		Bvh::Bvh()
+		{
+		}
+
+		TriangleArrays Bvh::triangle_arrays(
+			size_t first) const
+		{
+			size_t const n = m_triangles.size();
+			float const * const data = m_triangle_data.data() + first;
+			TriangleArrays const arrays = {
+				data, data + n, data + 2 * n,
+				data + 3 * n, data + 4 * n, data + 5 * n,
+				data + 6 * n, data + 7 * n, data + 8 * n
+			};
+			return arrays;
+		}
+
+		void Bvh::gather_triangles(
+			fvec3_t const * positions,
+			size_t stride,
+			uint32_t const * indices)
+		{
+			size_t const n = m_triangles.size();
+			m_triangle_data.resize(9 * n);
+			float * const data = m_triangle_data.data();
+			for(size_t i = 0; i < n; i++)
+			{
+				fvec3_t corners[3];
+				triangle_corners(positions, stride, indices, m_triangles[i], corners);
+				fvec3_t const edge1 = corners[1] - corners[0];
+				fvec3_t const edge2 = corners[2] - corners[0];
+				data[i] = corners[0].x;
+				data[n + i] = corners[0].y;
+				data[2 * n + i] = corners[0].z;
+				data[3 * n + i] = edge1.x;
+				data[4 * n + i] = edge1.y;
+				data[5 * n + i] = edge1.z;
+				data[6 * n + i] = edge2.x;
+				data[7 * n + i] = edge2.y;
+				data[8 * n + i] = edge2.z;
+			}
+		}
+
+		void Bvh::build(
+			fvec3_t const * positions,
+			size_t stride,
+			uint32_t const * indices,
+			size_t triangle_count,
+			BvhSettings const& settings)
+		{
+			RE_DBG_ASSERT(!triangle_count || positions);
+			RE_DBG_ASSERT(stride >= sizeof(fvec3_t));
+			RE_DBG_ASSERT(triangle_count < (size_t(1) << 24));
+			RE_DBG_ASSERT(settings.max_leaf_size >= 1);
+			RE_DBG_ASSERT(settings.bins >= 2 && settings.bins <= k_max_bins);
+
+			m_nodes.clear();
+			m_triangles.resize(triangle_count);
+			if(!triangle_count)
+			{
+				m_triangle_data.clear();
+				return;
+			}
+
+			Builder builder;
+			builder.settings = settings;
+			builder.bounds.resize(triangle_count);
+			builder.centroids.resize(3 * triangle_count);
+			for(size_t i = 0; i < triangle_count; i++)
+			{
+				fvec3_t corners[3];
+				triangle_corners(positions, stride, indices, i, corners);
+				Bounds &bounds = builder.bounds[i];
+				bounds.clear();
+				for(size_t c = 0; c < 3; c++)
+				{
+					float const corner[3] = { corners[c].x, corners[c].y, corners[c].z };
+					bounds.grow(corner);
+				}
+				for(size_t a = 0; a < 3; a++)
+					builder.centroids[3 * i + a] = 0.5f * (bounds.min[a] + bounds.max[a]);
+				m_triangles[i] = uint32_t(i);
+			}
+
+			// a binary tree with leaves of at least one triangle has at most 2n-1 nodes.
+			m_nodes.resize(2 * triangle_count - 1);
+			builder.order = m_triangles.data();
+			builder.nodes = m_nodes.data();
+			builder.next_node = 1;
+
+			size_t threads = 1;
+			if(settings.parallel_threshold && triangle_count >= settings.parallel_threshold)
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			builder.build(0, 0, triangle_count, 0, threads);
+
+			m_nodes.resize(builder.next_node);
+			m_nodes.shrink_to_fit();
+
+			gather_triangles(positions, stride, indices);
+		}
+
+		void Bvh::refit(
+			fvec3_t const * positions,
+			size_t stride,
+			uint32_t const * indices)
+		{
+			RE_DBG_ASSERT(m_triangles.empty() || positions);
+			RE_DBG_ASSERT(stride >= sizeof(fvec3_t));
+
+			gather_triangles(positions, stride, indices);
+
+			// children are always stored after their parents.
+			size_t const n = m_triangles.size();
+			float const * const data = m_triangle_data.data();
+			for(size_t i = m_nodes.size(); i--;)
+			{
+				BvhNode &node = m_nodes[i];
+				Bounds bounds;
+				bounds.clear();
+				if(node.leaf())
+				{
+					for(size_t t = node.first; t < node.first + node.count; t++)
+					{
+						float const corner[3] = { data[t], data[n + t], data[2 * n + t] };
+						float const corner1[3] = { corner[0] + data[3 * n + t], corner[1] + data[4 * n + t], corner[2] + data[5 * n + t] };
+						float const corner2[3] = { corner[0] + data[6 * n + t], corner[1] + data[7 * n + t], corner[2] + data[8 * n + t] };
+						bounds.grow(corner);
+						bounds.grow(corner1);
+						bounds.grow(corner2);
+					}
+				} else
+				{
+					for(size_t c = node.first; c < node.first + 2; c++)
+					{
+						bounds.grow(m_nodes[c].min);
+						bounds.grow(m_nodes[c].max);
+					}
+				}
+				for(size_t a = 0; a < 3; a++)
+				{
+					node.min[a] = bounds.min[a];
+					node.max[a] = bounds.max[a];
+				}
+			}
+		}
+
+		bool Bvh::intersect_nearest(
+			Ray<float> const& ray,
+			TriangleHit &hit,
+			float max_distance) const
+		{
+			if(m_nodes.empty())
+				return false;
+
+			SlabRay const slab(ray);
+			float entry;
+			if(!slab.hits(m_nodes[0], max_distance, entry))
+				return false;
+
+			uint32_t stack[k_stack_size];
+			size_t size = 0;
+			stack[size++] = 0;
+			bool found = false;
+
+			while(size)
+			{
+				BvhNode const& node = m_nodes[stack[--size]];
+				if(node.leaf())
+				{
+					TriangleHit leaf_hit;
+					if(math::intersect_nearest(ray, triangle_arrays(node.first), node.count, leaf_hit, max_distance))
+					{
+						found = true;
+						max_distance = leaf_hit.distance;
+						hit = leaf_hit;
+						hit.triangle = m_triangles[node.first + leaf_hit.triangle];
+					}
+					continue;
+				}
+
+				float near_entry, far_entry;
+				uint32_t near = node.first, far = node.first + 1;
+				bool const near_hit = slab.hits(m_nodes[near], max_distance, near_entry);
+				bool const far_hit = slab.hits(m_nodes[far], max_distance, far_entry);
+				if(near_hit && far_hit)
+				{
+					if(far_entry < near_entry)
+						std::swap(near, far);
+					// visit the nearer child first, so that hits in it cull the other.
+					stack[size++] = far;
+					stack[size++] = near;
+				} else if(near_hit)
+					stack[size++] = near;
+				else if(far_hit)
+					stack[size++] = far;
+				RE_DBG_ASSERT(size <= k_stack_size);
+			}
+
+			return found;
+		}
+
+		bool Bvh::intersect_any(
+			Ray<float> const& ray,
+			float max_distance) const
+		{
+			if(m_nodes.empty())
+				return false;
+
+			SlabRay const slab(ray);
+			float entry;
+			if(!slab.hits(m_nodes[0], max_distance, entry))
+				return false;
+
+			uint32_t stack[k_stack_size];
+			size_t size = 0;
+			stack[size++] = 0;
+
+			while(size)
+			{
+				BvhNode const& node = m_nodes[stack[--size]];
+				if(node.leaf())
+				{
+					TriangleHit leaf_hit;
+					if(math::intersect_nearest(ray, triangle_arrays(node.first), node.count, leaf_hit, max_distance))
+						return true;
+					continue;
+				}
+
+				for(uint32_t child = node.first; child < node.first + 2; child++)
+					if(slab.hits(m_nodes[child], max_distance, entry))
+						stack[size++] = child;
+				RE_DBG_ASSERT(size <= k_stack_size);
+			}
+
+			return false;
+		}
+
+		faabb_t Bvh::bounds() const
+		{
+			if(m_nodes.empty())
+				return faabb_t(math::empty);
+			BvhNode const& root = m_nodes[0];
+			return faabb_t(
+				fvec3_t(root.min[0], root.min[1], root.min[2]),
+				fvec3_t(root.max[0], root.max[1], root.max[2]));
+		}
+	}
+}
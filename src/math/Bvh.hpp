@@ -0,0 +1,141 @@
+#ifndef __re_math_bvh_hpp_defined
+#define __re_math_bvh_hpp_defined
+
+#include "RayIntersection.hpp"
+#include "../base_types.hpp"
+#include "../LogFile.hpp"
+
+#include <vector>
+#include <limits>
+
+namespace re
+{
+	namespace math
+	{
+		/** A node of a Bvh, packed into 32 bytes. */
+		struct BvhNode
+		{
+			/** The minimum corner of the bounding box. */
+			float min[3];
+			/** For inner nodes, the index of the first child, which is followed by the second child. For leaves, the first triangle, in the order of the leaves. */
+			uint32_t first;
+			/** The maximum corner of the bounding box. */
+			float max[3];
+			/** How many triangles a leaf has, or 0 for inner nodes. */
+			uint32_t count;
+
+			/** Returns whether the node is a leaf. */
+			REIL bool leaf() const;
+		};
+
+		/** Parameters for building a Bvh. */
+		struct BvhSettings
+		{
+			BvhSettings();
+			BvhSettings(
+				size_t max_leaf_size,
+				size_t bins,
+				size_t parallel_threshold);
+
+			/** The most triangles per leaf. */
+			size_t max_leaf_size;
+			/** How many split candidates are evaluated per axis, at most 64. */
+			size_t bins;
+			/** Subtrees with at least this many triangles are built on a thread of their own. 0 builds on the calling thread only. */
+			size_t parallel_threshold;
+		};
+
+		/** A bounding volume hierarchy over a triangle soup, to find ray hits in logarithmic instead of linear time.
+			It is built with the surface area heuristic, evaluated on bins of triangle centroids. The triangles are copied in the order of the leaves, so that the source data need not outlive the Bvh. Deformed meshes with the same triangles can be refitted, which keeps the tree, but updates its bounds. */
+		class Bvh
+		{
+			/** The nodes, the root first. */
+			std::vector<BvhNode> m_nodes;
+			/** The source index of each triangle, in the order of the leaves. */
+			std::vector<uint32_t> m_triangles;
+			/** The corners and edges of the triangles, in the order of the leaves, as 9 consecutive arrays, as used by TriangleArrays. */
+			std::vector<float> m_triangle_data;
+
+			/** Returns the triangles, starting at the given position in the order of the leaves. */
+			TriangleArrays triangle_arrays(
+				size_t first) const;
+			/** Copies the triangles into the order of the leaves. */
+			void gather_triangles(
+				fvec3_t const * positions,
+				size_t stride,
+				uint32_t const * indices);
+		public:
+			/** Creates an empty Bvh, which is never hit. */
+			Bvh();
+
+			/** Builds the Bvh over a triangle soup, replacing the previous contents.
+			@param[in] positions:
+				The first vertex position, such as the position field of the first vertex of a vertex buffer.
+			@param[in] stride:
+				The byte distance between two vertex positions, at least `sizeof(fvec3_t)`.
+			@param[in] indices:
+				Three vertex indices per triangle, or null if every three consecutive vertices form a triangle.
+			@param[in] triangle_count:
+				How many triangles there are, less than 2^24.
+			@param[in] settings:
+				How to build the Bvh. */
+			void build(
+				fvec3_t const * positions,
+				size_t stride,
+				uint32_t const * indices,
+				size_t triangle_count,
+				BvhSettings const& settings = BvhSettings());
+
+			/** Updates the bounds after the vertices moved, keeping the tree. The tree gets less efficient the more the triangles moved since it was built.
+			@param[in] positions:
+				The new first vertex position.
+			@param[in] stride:
+				The byte distance between two vertex positions, at least `sizeof(fvec3_t)`.
+			@param[in] indices:
+				The same indices that the Bvh was built with. */
+			void refit(
+				fvec3_t const * positions,
+				size_t stride,
+				uint32_t const * indices);
+
+			/** Finds the nearest triangle that a ray hits, from either side.
+			@param[in] ray:
+				The ray.
+			@param[out] hit:
+				Receives the nearest hit, if any, with the index of the triangle in the source data.
+			@param[in] max_distance:
+				Hits at or beyond this coordinate on the ray are ignored.
+			@return
+				Whether any triangle was hit. */
+			bool intersect_nearest(
+				Ray<float> const& ray,
+				TriangleHit &hit,
+				float max_distance = std::numeric_limits<float>::infinity()) const;
+
+			/** Returns whether a ray hits any triangle, from either side, such as for occlusion queries. This stops at the first hit found.
+			@param[in] ray:
+				The ray.
+			@param[in] max_distance:
+				Hits at or beyond this coordinate on the ray are ignored. */
+			bool intersect_any(
+				Ray<float> const& ray,
+				float max_distance = std::numeric_limits<float>::infinity()) const;
+
+			/** Returns whether the Bvh has no triangles. */
+			REIL bool empty() const;
+			/** Returns how many triangles the Bvh was built over. */
+			REIL size_t triangle_count() const;
+			/** Returns how many nodes the Bvh has. */
+			REIL size_t node_count() const;
+			/** Returns the given node. The root is node 0. */
+			REIL BvhNode const& node(
+				size_t index) const;
+			/** Returns the bounding box of all triangles. */
+			faabb_t bounds() const;
+		};
+	}
+}
+
+#include "Bvh.inl"
+
+#endif
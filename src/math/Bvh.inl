@@ -0,0 +1,32 @@
+namespace re
+{
+	namespace math
+	{
+		bool BvhNode::leaf() const
+		{
+			return count != 0;
+		}
+
+		bool Bvh::empty() const
+		{
+			return m_nodes.empty();
+		}
+
+		size_t Bvh::triangle_count() const
+		{
+			return m_triangles.size();
+		}
+
+		size_t Bvh::node_count() const
+		{
+			return m_nodes.size();
+		}
+
+		BvhNode const& Bvh::node(
+			size_t index) const
+		{
+			RE_DBG_ASSERT(index < m_nodes.size());
+			return m_nodes[index];
+		}
+	}
+}
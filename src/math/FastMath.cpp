@@ -0,0 +1,59 @@
+#include "FastMath.hpp"
+#include "../LogFile.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		namespace
+		{
+			template<class L, Accuracy k_accuracy>
+			void sincos_batch(
+				float const * x,
+				size_t count,
+				float * sin,
+				float * cos)
+			{
+				size_t i = 0;
+				for(; i + L::k_width <= count; i += L::k_width)
+				{
+					typename L::type s, c;
+					detail::sincos_lanes<L, k_accuracy>(L::load(x + i), s, c);
+					L::store(sin + i, s);
+					L::store(cos + i, c);
+				}
+
+				for(; i < count; i++)
+					math::sincos<k_accuracy>(x[i], sin[i], cos[i]);
+			}
+		}
+
+		void sincos(
+			float const * x,
+			size_t count,
+			float * sin,
+			float * cos,
+			Accuracy accuracy)
+		{
+			RE_DBG_ASSERT(!count || (x && sin && cos));
+			RE_DBG_ASSERT(RE_IN_ENUM(accuracy, Accuracy));
+
+			switch(accuracy)
+			{
+			case Accuracy::Exact:
+				{
+					for(size_t i = 0; i < count; i++)
+						math::sincos<Accuracy::Exact>(x[i], sin[i], cos[i]);
+				} break;
+			case Accuracy::High:
+				{
+					sincos_batch<simd::WideLanes, Accuracy::High>(x, count, sin, cos);
+				} break;
+			case Accuracy::Low:
+				{
+					sincos_batch<simd::WideLanes, Accuracy::Low>(x, count, sin, cos);
+				} break;
+			}
+		}
+	}
+}
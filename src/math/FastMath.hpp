@@ -0,0 +1,96 @@
+#ifndef __re_math_fastmath_hpp_defined
+#define __re_math_fastmath_hpp_defined
+
+#include "SIMD.hpp"
+#include "Vector.hpp"
+#include "Angle.hpp"
+#include "../defines.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		/* Trigonometry and reciprocal square roots with a selectable accuracy, so that hot paths, such as building transformations or updating particles, can explicitly trade precision for speed.
+		The approximated sine and cosine reduce their argument to [-pi/4, pi/4] and evaluate polynomials there. They stay within their error bound for `|x| <= 8192`. */
+
+		/** The accuracy of an approximated function. */
+		enum class Accuracy
+		{
+			/** As precise as the standard library. */
+			Exact,
+			/** An error below 1e-6: absolute for sine and cosine, relative for square roots. */
+			High,
+			/** An error below 1e-3: absolute for sine and cosine, relative for square roots. */
+			RE_LAST(Low)
+		};
+
+		template<Accuracy k_accuracy = Accuracy::Exact>
+		/** Computes the sine and cosine of an angle at once.
+		@param[in] x:
+			The angle, in radians.
+		@param[out] sin:
+			Receives the sine.
+		@param[out] cos:
+			Receives the cosine. */
+		REIL void sincos(float x, float &sin, float &cos);
+		template<Accuracy k_accuracy = Accuracy::Exact>
+		/** Computes the sine and cosine of an angle at once.
+		@param[in] angle:
+			The angle.
+		@param[out] sin:
+			Receives the sine.
+		@param[out] cos:
+			Receives the cosine. */
+		REIL void sincos(Angle const& angle, float &sin, float &cos);
+
+		/** Computes the sines and cosines of many angles, 4 per instruction, or 8 if AVX is enabled.
+		@param[in] x:
+			The angles, in radians, `count`.
+		@param[in] count:
+			How many angles there are.
+		@param[out] sin:
+			Receives the sines, `count`. Must not partially overlap `x`.
+		@param[out] cos:
+			Receives the cosines, `count`. Must not partially overlap `x`.
+		@param[in] accuracy:
+			The accuracy of the results. */
+		void sincos(
+			float const * x,
+			size_t count,
+			float * sin,
+			float * cos,
+			Accuracy accuracy = Accuracy::High);
+
+		template<Accuracy k_accuracy>
+		/** Computes `1 / sqrt(x)`, for positive `x`. */
+		REIL float rsqrt(float x);
+
+		template<Accuracy k_accuracy>
+		/** The length of a vector, via rsqrt(). */
+		REIL float abs(Vec3<float> const& v);
+		template<Accuracy k_accuracy>
+		/** The length of a vector, via rsqrt(). */
+		REIL float abs(Vec4<float> const& v);
+		template<Accuracy k_accuracy>
+		/** Normalises a vector via rsqrt(). Zero vectors are returned as they are. */
+		REIL Vec3<float> norm(Vec3<float> const& v);
+		template<Accuracy k_accuracy>
+		/** Normalises a vector via rsqrt(). Zero vectors are returned as they are. */
+		REIL Vec4<float> norm(Vec4<float> const& v);
+
+		namespace simd
+		{
+			template<Accuracy k_accuracy>
+			/** Computes the sine and cosine of every lane at once, like math::sincos(). */
+			REIL void sincos(float4 x, float4 &sin, float4 &cos);
+
+			template<Accuracy k_accuracy>
+			/** Computes `1 / sqrt(x)` per lane, for positive lanes. */
+			REIL float4 rsqrt(float4 x);
+		}
+	}
+}
+
+#include "FastMath.inl"
+
+#endif
@@ -0,0 +1,160 @@
+#include <cmath>
+
+namespace re
+{
+	namespace math
+	{
+		namespace detail
+		{
+			template<class L, Accuracy k_accuracy>
+			/** Approximates the sine and cosine of every lane. */
+			REIL void sincos_lanes(
+				typename L::type x,
+				typename L::type &sin,
+				typename L::type &cos)
+			{
+				static_assert(k_accuracy != Accuracy::Exact, "exact results are computed per lane.");
+				typedef typename L::type lanes_t;
+
+				// the nearest multiple of pi/2, and the remainder in [-pi/4, pi/4].
+				lanes_t const q = L::round(L::mul(x, L::splat(0.636619772f)));
+				lanes_t r;
+				if(k_accuracy == Accuracy::Low)
+					r = L::madd(q, L::splat(-1.57079637f), x);
+				else
+				{
+					// pi/2 in three parts, whose products with q are exact (Cody-Waite).
+					r = L::madd(q, L::splat(-1.5703125f), x);
+					r = L::madd(q, L::splat(-4.837512969970703125e-4f), r);
+					r = L::madd(q, L::splat(-7.54978995489188216e-8f), r);
+				}
+
+				lanes_t const r2 = L::mul(r, r);
+				lanes_t s, c;
+				if(k_accuracy == Accuracy::Low)
+				{
+					// the Taylor series is precise enough.
+					s = L::mul(r, L::madd(r2, L::madd(r2, L::splat(1.0f / 120.0f), L::splat(-1.0f / 6.0f)), L::splat(1.0f)));
+					c = L::madd(r2, L::madd(r2, L::splat(1.0f / 24.0f), L::splat(-0.5f)), L::splat(1.0f));
+				} else
+				{
+					// the minimax polynomials of Cephes.
+					lanes_t const r3 = L::mul(r2, r);
+					s = L::madd(r3, L::madd(r2, L::madd(r2, L::splat(-1.9515295891e-4f), L::splat(8.3321608736e-3f)), L::splat(-1.6666654611e-1f)), r);
+					lanes_t const r4 = L::mul(r2, r2);
+					c = L::madd(r4, L::madd(r2, L::madd(r2, L::splat(2.443315711809948e-5f), L::splat(-1.388731625493765e-3f)), L::splat(4.166664568298827e-2f)), L::madd(r2, L::splat(-0.5f), L::splat(1.0f)));
+				}
+
+				// the quadrant, modulo 2 in [-1, 1], and modulo 4 in [-2, 2].
+				lanes_t const q2 = L::madd(L::round(L::mul(q, L::splat(0.5f))), L::splat(-2.0f), q);
+				lanes_t const q4 = L::madd(L::round(L::mul(q, L::splat(0.25f))), L::splat(-4.0f), q);
+				lanes_t const odd = L::less(L::splat(0.5f), L::mul(q2, q2));
+				lanes_t const negative_sin = L::bit_or(L::less(q4, L::splat(-0.5f)), L::less(L::splat(1.5f), q4));
+				lanes_t const negative_cos = L::bit_or(L::less(L::splat(0.5f), q4), L::less(q4, L::splat(-1.5f)));
+
+				lanes_t const zero = L::splat(0.0f);
+				lanes_t const abs_sin = L::select(odd, c, s);
+				lanes_t const abs_cos = L::select(odd, s, c);
+				sin = L::select(negative_sin, L::sub(zero, abs_sin), abs_sin);
+				cos = L::select(negative_cos, L::sub(zero, abs_cos), abs_cos);
+			}
+		}
+
+		namespace simd
+		{
+			template<Accuracy k_accuracy>
+			REIL void sincos(float4 x, float4 &sin, float4 &cos)
+			{
+				if(k_accuracy == Accuracy::Exact)
+				{
+					alignas(k_float4_alignment) float lanes[3][4];
+					store(lanes[0], x);
+					for(size_t i = 0; i < 4; i++)
+					{
+						lanes[1][i] = std::sin(lanes[0][i]);
+						lanes[2][i] = std::cos(lanes[0][i]);
+					}
+					sin = load(lanes[1]);
+					cos = load(lanes[2]);
+				} else
+					math::detail::sincos_lanes<Lanes4, k_accuracy == Accuracy::Exact ? Accuracy::High : k_accuracy>(x, sin, cos);
+			}
+
+			template<Accuracy k_accuracy>
+			REIL float4 rsqrt(float4 x)
+			{
+				if(k_accuracy == Accuracy::Exact)
+					return div(splat(1.0f), sqrt(x));
+
+				float4 const r = rsqrt_estimate(x);
+				if(k_accuracy == Accuracy::Low)
+					return r;
+
+				// one Newton-Raphson step: r * (1.5 - 0.5 * x * r * r).
+				return mul(r, madd(mul(mul(x, splat(-0.5f)), r), r, splat(1.5f)));
+			}
+		}
+
+		template<Accuracy k_accuracy>
+		REIL void sincos(float x, float &sin, float &cos)
+		{
+			if(k_accuracy == Accuracy::Exact)
+			{
+				sin = std::sin(x);
+				cos = std::cos(x);
+			} else
+			{
+				simd::float4 s, c;
+				simd::sincos<k_accuracy>(simd::splat(x), s, c);
+				sin = simd::first(s);
+				cos = simd::first(c);
+			}
+		}
+
+		template<Accuracy k_accuracy>
+		REIL void sincos(Angle const& angle, float &sin, float &cos)
+		{
+			sincos<k_accuracy>(angle.rad(), sin, cos);
+		}
+
+		template<Accuracy k_accuracy>
+		REIL float rsqrt(float x)
+		{
+			return k_accuracy == Accuracy::Exact
+				? 1.0f / std::sqrt(x)
+				: simd::first(simd::rsqrt<k_accuracy>(simd::splat(x)));
+		}
+
+		template<Accuracy k_accuracy>
+		REIL float abs(Vec3<float> const& v)
+		{
+			float const sqr = dot(v, v);
+			if(k_accuracy == Accuracy::Exact)
+				return std::sqrt(sqr);
+			return sqr > 0.0f ? sqr * rsqrt<k_accuracy>(sqr) : 0.0f;
+		}
+
+		template<Accuracy k_accuracy>
+		REIL float abs(Vec4<float> const& v)
+		{
+			float const sqr = dot(v, v);
+			if(k_accuracy == Accuracy::Exact)
+				return std::sqrt(sqr);
+			return sqr > 0.0f ? sqr * rsqrt<k_accuracy>(sqr) : 0.0f;
+		}
+
+		template<Accuracy k_accuracy>
+		REIL Vec3<float> norm(Vec3<float> const& v)
+		{
+			float const sqr = dot(v, v);
+			return sqr > 0.0f ? v * rsqrt<k_accuracy>(sqr) : v;
+		}
+
+		template<Accuracy k_accuracy>
+		REIL Vec4<float> norm(Vec4<float> const& v)
+		{
+			float const sqr = dot(v, v);
+			return sqr > 0.0f ? v * rsqrt<k_accuracy>(sqr) : v;
+		}
+	}
+}
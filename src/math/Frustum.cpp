@@ -0,0 +1,307 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+namespace re
+{
+	namespace math
+	{
+		namespace
+		{
+			template<class L>
+			/** The planes of a frustum, with every coefficient splatted across the lanes. */
+			struct PlaneLanes
+			{
+				typename L::type x[RE_COUNT(FrustumPlane)];
+				typename L::type y[RE_COUNT(FrustumPlane)];
+				typename L::type z[RE_COUNT(FrustumPlane)];
+				typename L::type w[RE_COUNT(FrustumPlane)];
+				/** The absolute normals, for box radii. */
+				typename L::type abs_x[RE_COUNT(FrustumPlane)];
+				typename L::type abs_y[RE_COUNT(FrustumPlane)];
+				typename L::type abs_z[RE_COUNT(FrustumPlane)];
+				/** The index of each plane. */
+				typename L::type index[RE_COUNT(FrustumPlane)];
+
+				explicit PlaneLanes(ffrustum_t const& frustum)
+				{
+					for(size_t i = 0; i < RE_COUNT(FrustumPlane); i++)
+					{
+						fvec4_t const& plane = frustum.plane(FrustumPlane(i));
+						x[i] = L::splat(plane.x);
+						y[i] = L::splat(plane.y);
+						z[i] = L::splat(plane.z);
+						w[i] = L::splat(plane.w);
+						abs_x[i] = L::splat(std::fabs(plane.x));
+						abs_y[i] = L::splat(std::fabs(plane.y));
+						abs_z[i] = L::splat(std::fabs(plane.z));
+						index[i] = L::splat(float(i));
+					}
+				}
+			};
+
+			template<class L>
+			/** Boxes, loaded as center and extent. */
+			class BoxLanes
+			{
+				float const * m_min_x, * m_min_y, * m_min_z;
+				float const * m_max_x, * m_max_y, * m_max_z;
+				typename L::type m_extent_x, m_extent_y, m_extent_z;
+			public:
+				typename L::type x, y, z;
+
+				BoxLanes(
+					float const * min_x,
+					float const * min_y,
+					float const * min_z,
+					float const * max_x,
+					float const * max_y,
+					float const * max_z):
+					m_min_x(min_x),
+					m_min_y(min_y),
+					m_min_z(min_z),
+					m_max_x(max_x),
+					m_max_y(max_y),
+					m_max_z(max_z)
+				{
+				}
+
+				/** Loads the boxes starting at `i`. */
+				REIL void load(size_t i)
+				{
+					typename L::type const half = L::splat(0.5f);
+					typename L::type const min_x = L::load(m_min_x + i), max_x = L::load(m_max_x + i);
+					typename L::type const min_y = L::load(m_min_y + i), max_y = L::load(m_max_y + i);
+					typename L::type const min_z = L::load(m_min_z + i), max_z = L::load(m_max_z + i);
+					x = L::mul(L::add(min_x, max_x), half);
+					y = L::mul(L::add(min_y, max_y), half);
+					z = L::mul(L::add(min_z, max_z), half);
+					m_extent_x = L::mul(L::sub(max_x, min_x), half);
+					m_extent_y = L::mul(L::sub(max_y, min_y), half);
+					m_extent_z = L::mul(L::sub(max_z, min_z), half);
+				}
+
+				/** How far the loaded boxes extend towards a plane with the given absolute normal. */
+				REIL typename L::type radius(
+					typename L::type abs_x,
+					typename L::type abs_y,
+					typename L::type abs_z) const
+				{
+					return L::madd(abs_x, m_extent_x, L::madd(abs_y, m_extent_y, L::mul(abs_z, m_extent_z)));
+				}
+
+				/** Classifies a single box, for the remainder of a batch. */
+				REIL Visibility classify(
+					ffrustum_t const& frustum,
+					size_t i,
+					FrustumPlane &cached_plane) const
+				{
+					return frustum.classify(
+						faabb_t(
+							fvec3_t(m_min_x[i], m_min_y[i], m_min_z[i]),
+							fvec3_t(m_max_x[i], m_max_y[i], m_max_z[i])),
+						cached_plane);
+				}
+			};
+
+			template<class L>
+			/** Spheres, loaded as center and radius. */
+			class SphereLanes
+			{
+				float const * m_x, * m_y, * m_z, * m_radius;
+				typename L::type m_loaded_radius;
+			public:
+				typename L::type x, y, z;
+
+				SphereLanes(
+					float const * x,
+					float const * y,
+					float const * z,
+					float const * radius):
+					m_x(x),
+					m_y(y),
+					m_z(z),
+					m_radius(radius)
+				{
+				}
+
+				/** Loads the spheres starting at `i`. */
+				REIL void load(size_t i)
+				{
+					x = L::load(m_x + i);
+					y = L::load(m_y + i);
+					z = L::load(m_z + i);
+					m_loaded_radius = L::load(m_radius + i);
+				}
+
+				/** The radius of the loaded spheres, which is the same towards every plane. */
+				REIL typename L::type radius(
+					typename L::type,
+					typename L::type,
+					typename L::type) const
+				{
+					return m_loaded_radius;
+				}
+
+				/** Classifies a single sphere, for the remainder of a batch. */
+				REIL Visibility classify(
+					ffrustum_t const& frustum,
+					size_t i,
+					FrustumPlane &cached_plane) const
+				{
+					return frustum.classify_sphere(
+						fvec3_t(m_x[i], m_y[i], m_z[i]),
+						m_radius[i],
+						cached_plane);
+				}
+			};
+
+			template<class L, bool k_cached, class Shapes>
+			/** Classifies `count` shapes, `L::k_width` at a time. The rejecting planes are only tracked if `k_cached`. */
+			void classify_lanes(
+				ffrustum_t const& frustum,
+				Shapes &shapes,
+				size_t count,
+				Visibility * visibility,
+				FrustumPlane * cached_planes)
+			{
+				typedef typename L::type lanes_t;
+				RE_DBG_ASSERT(!count || visibility);
+				RE_DBG_ASSERT(!k_cached || !count || cached_planes);
+
+				PlaneLanes<L> const planes(frustum);
+				lanes_t const zero = L::splat(0.0f);
+				int const all = (1 << L::k_width) - 1;
+
+				size_t i = 0;
+				for(; i + L::k_width <= count; i += L::k_width)
+				{
+					shapes.load(i);
+
+					lanes_t outside = zero;
+					lanes_t rejected_by = zero;
+					if(k_cached)
+					{
+						// test every shape against its cached plane first.
+						float x[L::k_width], y[L::k_width], z[L::k_width], w[L::k_width];
+						float abs_x[L::k_width], abs_y[L::k_width], abs_z[L::k_width], index[L::k_width];
+						for(size_t j = 0; j < L::k_width; j++)
+						{
+							RE_DBG_ASSERT(RE_IN_ENUM(cached_planes[i+j], FrustumPlane));
+							fvec4_t const& plane = frustum.plane(cached_planes[i+j]);
+							x[j] = plane.x;
+							y[j] = plane.y;
+							z[j] = plane.z;
+							w[j] = plane.w;
+							abs_x[j] = std::fabs(plane.x);
+							abs_y[j] = std::fabs(plane.y);
+							abs_z[j] = std::fabs(plane.z);
+							index[j] = float(cached_planes[i+j]);
+						}
+
+						lanes_t const distance = L::madd(L::load(x), shapes.x, L::madd(L::load(y), shapes.y, L::madd(L::load(z), shapes.z, L::load(w))));
+						lanes_t const radius = shapes.radius(L::load(abs_x), L::load(abs_y), L::load(abs_z));
+						outside = L::less(L::add(distance, radius), zero);
+						rejected_by = L::load(index);
+
+						// the cached planes stay as they are.
+						if(L::mask_bits(outside) == all)
+						{
+							for(size_t j = 0; j < L::k_width; j++)
+								visibility[i+j] = Visibility::Outside;
+							continue;
+						}
+					}
+
+					lanes_t intersecting = zero;
+					for(size_t p = 0; p < RE_COUNT(FrustumPlane); p++)
+					{
+						lanes_t const distance = L::madd(planes.x[p], shapes.x, L::madd(planes.y[p], shapes.y, L::madd(planes.z[p], shapes.z, planes.w[p])));
+						lanes_t const radius = shapes.radius(planes.abs_x[p], planes.abs_y[p], planes.abs_z[p]);
+						lanes_t const out = L::less(L::add(distance, radius), zero);
+
+						// keep the first plane that rejected a shape.
+						if(k_cached)
+							rejected_by = L::select(outside, rejected_by, L::select(out, planes.index[p], rejected_by));
+						outside = L::bit_or(outside, out);
+						intersecting = L::bit_or(intersecting, L::less(distance, radius));
+
+						if(L::mask_bits(outside) == all)
+							break;
+					}
+
+					// indexed by the outside and intersecting bit of a lane, without branching.
+					static Visibility const k_visibility[4] = {
+						Visibility::Inside,
+						Visibility::Intersecting,
+						Visibility::Outside,
+						Visibility::Outside
+					};
+					int const outside_bits = L::mask_bits(outside);
+					int const intersecting_bits = L::mask_bits(intersecting);
+					for(size_t j = 0; j < L::k_width; j++)
+						visibility[i+j] = k_visibility[((outside_bits >> j) & 1) << 1 | ((intersecting_bits >> j) & 1)];
+
+					if(k_cached && outside_bits)
+					{
+						float rejected[L::k_width];
+						L::store(rejected, rejected_by);
+						for(size_t j = 0; j < L::k_width; j++)
+							if(outside_bits & (1 << j))
+								cached_planes[i+j] = FrustumPlane(rejected[j]);
+					}
+				}
+
+				for(; i < count; i++)
+				{
+					FrustumPlane cached_plane = k_cached
+						? cached_planes[i]
+						: FrustumPlane::Left;
+					visibility[i] = shapes.classify(frustum, i, cached_plane);
+					if(k_cached)
+						cached_planes[i] = cached_plane;
+				}
+			}
+		}
+
+		void classify_boxes(
+			ffrustum_t const& frustum,
+			float const * min_x,
+			float const * min_y,
+			float const * min_z,
+			float const * max_x,
+			float const * max_y,
+			float const * max_z,
+			size_t count,
+			Visibility * visibility,
+			FrustumPlane * cached_planes)
+		{
+			RE_DBG_ASSERT(!count || (min_x && min_y && min_z && max_x && max_y && max_z));
+
+			BoxLanes<simd::WideLanes> boxes(min_x, min_y, min_z, max_x, max_y, max_z);
+			if(cached_planes)
+				classify_lanes<simd::WideLanes, true>(frustum, boxes, count, visibility, cached_planes);
+			else
+				classify_lanes<simd::WideLanes, false>(frustum, boxes, count, visibility, cached_planes);
+		}
+
+		void classify_spheres(
+			ffrustum_t const& frustum,
+			float const * x,
+			float const * y,
+			float const * z,
+			float const * radius,
+			size_t count,
+			Visibility * visibility,
+			FrustumPlane * cached_planes)
+		{
+			RE_DBG_ASSERT(!count || (x && y && z && radius));
+
+			SphereLanes<simd::WideLanes> spheres(x, y, z, radius);
+			if(cached_planes)
+				classify_lanes<simd::WideLanes, true>(frustum, spheres, count, visibility, cached_planes);
+			else
+				classify_lanes<simd::WideLanes, false>(frustum, spheres, count, visibility, cached_planes);
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#ifndef __re_math_frustum_hpp_defined
+#define __re_math_frustum_hpp_defined
+
+#include "Matrix.hpp"
+#include "AxisAlignedBoundingBox.hpp"
+#include "../defines.hpp"
+#include "../LogFile.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		/** How much of an object is visible. */
+		enum class Visibility : uint8_t
+		{
+			Outside,
+			/** Partially visible, or could not be proven to be completely visible. */
+			Intersecting,
+			RE_LAST(Inside)
+		};
+
+		/** The depth range of clip space, which decides where the near plane is. */
+		enum class ClipDepth
+		{
+			/** `-w <= z <= w`, as used by OpenGL. */
+			NegativeOneToOne,
+			/** `0 <= z <= w`, as produced by Mat4x4::perspective. */
+			RE_LAST(ZeroToOne)
+		};
+
+		/** The planes of a Frustum. */
+		enum class FrustumPlane : uint8_t
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			RE_LAST(Far)
+		};
+
+		template<class T>
+		/** The volume that is visible through a view projection matrix, bounded by six planes.
+			Objects are classified against it for culling. When an object is outside, the plane that rejected it can be cached by the caller and is tested first in the next frame, as it most likely rejects the object again. */
+		class Frustum
+		{
+			/** The planes, as `(normal, distance)`, with normalised normals that point inwards. */
+			Vec4<T> m_planes[RE_COUNT(FrustumPlane)];
+		public:
+			/** Extracts the planes of a view projection matrix.
+			@param[in] view_projection:
+				The matrix that transforms into clip space.
+			@param[in] depth:
+				The depth range of the clip space. The OpenGL range is culled less, and is correct for the renderer, which draws via OpenGL. */
+			explicit Frustum(
+				Mat4x4<T> const& view_projection,
+				ClipDepth depth = ClipDepth::NegativeOneToOne);
+
+			/** Returns the given plane, as `(normal, distance)`. A point `p` is inside the plane if `dot(normal, p) + distance >= 0`. */
+			REIL Vec4<T> const& plane(
+				FrustumPlane plane) const;
+
+			/** Returns whether a point is inside the frustum. */
+			bool contains(
+				Vec3<T> const& point) const;
+
+			/** Classifies a bounding box. Empty boxes are outside. */
+			Visibility classify(
+				AxisAlignedBoundingBox<T> const& box) const;
+			/** Classifies a bounding box, testing the cached plane first.
+			@param[in] box:
+				The box to classify. Empty boxes are outside.
+			@param[in,out] cached_plane:
+				The plane that rejected the box the last time, initially 0. If the box is outside, receives the plane that rejected it. */
+			Visibility classify(
+				AxisAlignedBoundingBox<T> const& box,
+				FrustumPlane &cached_plane) const;
+
+			/** Classifies a sphere. */
+			Visibility classify_sphere(
+				Vec3<T> const& center,
+				T radius) const;
+			/** Classifies a sphere, testing the cached plane first.
+			@param[in] center:
+				The center of the sphere.
+			@param[in] radius:
+				The radius of the sphere.
+			@param[in,out] cached_plane:
+				The plane that rejected the sphere the last time, initially 0. If the sphere is outside, receives the plane that rejected it. */
+			Visibility classify_sphere(
+				Vec3<T> const& center,
+				T radius,
+				FrustumPlane &cached_plane) const;
+		};
+
+		typedef Frustum<float> ffrustum_t;
+		typedef Frustum<double> dfrustum_t;
+
+		/** Classifies boxes given as structure of arrays (one array per coordinate of their corners), 4 per instruction, or 8 if AVX is enabled.
+		@param[in] frustum:
+			The frustum to classify against.
+		@param[in] min_x, min_y, min_z:
+			The minimum corners of the boxes, `count` each.
+		@param[in] max_x, max_y, max_z:
+			The maximum corners of the boxes, `count` each. The boxes must not be empty.
+		@param[in] count:
+			How many boxes there are.
+		@param[out] visibility:
+			Receives the visibility of each box.
+		@param[in,out] cached_planes:
+			Null, or the plane that rejected each box the last time, initially 0. Receives the plane that rejected each box that is outside. */
+		void classify_boxes(
+			ffrustum_t const& frustum,
+			float const * min_x,
+			float const * min_y,
+			float const * min_z,
+			float const * max_x,
+			float const * max_y,
+			float const * max_z,
+			size_t count,
+			Visibility * visibility,
+			FrustumPlane * cached_planes = nullptr);
+
+		/** Classifies spheres given as structure of arrays, 4 per instruction, or 8 if AVX is enabled.
+		@param[in] frustum:
+			The frustum to classify against.
+		@param[in] x, y, z:
+			The centers of the spheres, `count` each.
+		@param[in] radius:
+			The radii of the spheres, `count`.
+		@param[in] count:
+			How many spheres there are.
+		@param[out] visibility:
+			Receives the visibility of each sphere.
+		@param[in,out] cached_planes:
+			Null, or the plane that rejected each sphere the last time, initially 0. Receives the plane that rejected each sphere that is outside. */
+		void classify_spheres(
+			ffrustum_t const& frustum,
+			float const * x,
+			float const * y,
+			float const * z,
+			float const * radius,
+			size_t count,
+			Visibility * visibility,
+			FrustumPlane * cached_planes = nullptr);
+	}
+}
+
+#include "Frustum.inl"
+
+#endif
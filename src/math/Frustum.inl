@@ -0,0 +1,185 @@
+#include <cmath>
+
+namespace re
+{
+	namespace math
+	{
+		namespace detail
+		{
+			template<class T>
+			/** The signed distance of a point to a plane. */
+			REIL T plane_distance(
+				Vec4<T> const& plane,
+				Vec3<T> const& point)
+			{
+				return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+			}
+
+			template<class T>
+			/** Classifies a shape that extends `radius` from its center against a single plane. */
+			REIL Visibility classify_plane(
+				T distance,
+				T radius)
+			{
+				if(distance + radius < T(0))
+					return Visibility::Outside;
+				if(distance < radius)
+					return Visibility::Intersecting;
+				return Visibility::Inside;
+			}
+
+			template<class T>
+			/** How far a box extends from its center towards a plane. */
+			REIL T box_radius(
+				Vec4<T> const& plane,
+				Vec3<T> const& extent)
+			{
+				using std::abs;
+				return abs(plane.x) * extent.x + abs(plane.y) * extent.y + abs(plane.z) * extent.z;
+			}
+		}
+
+		template<class T>
+		Frustum<T>::Frustum(
+			Mat4x4<T> const& m,
+			ClipDepth depth)
+		{
+			RE_DBG_ASSERT(RE_IN_ENUM(depth, ClipDepth));
+
+			// the rows of the matrix.
+			Vec4<T> const r0(m.v0.x, m.v1.x, m.v2.x, m.v3.x);
+			Vec4<T> const r1(m.v0.y, m.v1.y, m.v2.y, m.v3.y);
+			Vec4<T> const r2(m.v0.z, m.v1.z, m.v2.z, m.v3.z);
+			Vec4<T> const r3(m.v0.w, m.v1.w, m.v2.w, m.v3.w);
+
+			m_planes[size_t(FrustumPlane::Left)] = r3 + r0;
+			m_planes[size_t(FrustumPlane::Right)] = r3 - r0;
+			m_planes[size_t(FrustumPlane::Bottom)] = r3 + r1;
+			m_planes[size_t(FrustumPlane::Top)] = r3 - r1;
+			m_planes[size_t(FrustumPlane::Near)] = (depth == ClipDepth::NegativeOneToOne)
+				? r3 + r2
+				: r2;
+			m_planes[size_t(FrustumPlane::Far)] = r3 - r2;
+
+			for(Vec4<T> &plane : m_planes)
+			{
+				T const length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+				// infinite far planes have no normal.
+				if(length > T(0))
+					plane = plane * (T(1) / length);
+			}
+		}
+
+		template<class T>
+		Vec4<T> const& Frustum<T>::plane(
+			FrustumPlane plane) const
+		{
+			RE_DBG_ASSERT(RE_IN_ENUM(plane, FrustumPlane));
+			return m_planes[size_t(plane)];
+		}
+
+		template<class T>
+		bool Frustum<T>::contains(
+			Vec3<T> const& point) const
+		{
+			for(Vec4<T> const& plane : m_planes)
+				if(detail::plane_distance(plane, point) < T(0))
+					return false;
+			return true;
+		}
+
+		template<class T>
+		Visibility Frustum<T>::classify(
+			AxisAlignedBoundingBox<T> const& box) const
+		{
+			FrustumPlane cached_plane = FrustumPlane::Left;
+			return classify(box, cached_plane);
+		}
+
+		template<class T>
+		Visibility Frustum<T>::classify(
+			AxisAlignedBoundingBox<T> const& box,
+			FrustumPlane &cached_plane) const
+		{
+			RE_DBG_ASSERT(RE_IN_ENUM(cached_plane, FrustumPlane));
+
+			if(box.empty())
+				return Visibility::Outside;
+
+			Vec3<T> const center = (box.min() + box.max()) * T(0.5);
+			Vec3<T> const extent = (box.max() - box.min()) * T(0.5);
+
+			Vec4<T> const& cached = m_planes[size_t(cached_plane)];
+			if(detail::plane_distance(cached, center) + detail::box_radius(cached, extent) < T(0))
+				return Visibility::Outside;
+
+			Visibility result = Visibility::Inside;
+			for(size_t i = 0; i < RE_COUNT(FrustumPlane); i++)
+			{
+				Vec4<T> const& plane = m_planes[i];
+				switch(detail::classify_plane(
+					detail::plane_distance(plane, center),
+					detail::box_radius(plane, extent)))
+				{
+				case Visibility::Outside:
+					{
+						cached_plane = FrustumPlane(i);
+						return Visibility::Outside;
+					}
+				case Visibility::Intersecting:
+					{
+						result = Visibility::Intersecting;
+					} break;
+				case Visibility::Inside:
+					break;
+				}
+			}
+
+			return result;
+		}
+
+		template<class T>
+		Visibility Frustum<T>::classify_sphere(
+			Vec3<T> const& center,
+			T radius) const
+		{
+			FrustumPlane cached_plane = FrustumPlane::Left;
+			return classify_sphere(center, radius, cached_plane);
+		}
+
+		template<class T>
+		Visibility Frustum<T>::classify_sphere(
+			Vec3<T> const& center,
+			T radius,
+			FrustumPlane &cached_plane) const
+		{
+			RE_DBG_ASSERT(RE_IN_ENUM(cached_plane, FrustumPlane));
+
+			if(detail::plane_distance(m_planes[size_t(cached_plane)], center) + radius < T(0))
+				return Visibility::Outside;
+
+			Visibility result = Visibility::Inside;
+			for(size_t i = 0; i < RE_COUNT(FrustumPlane); i++)
+			{
+				switch(detail::classify_plane(
+					detail::plane_distance(m_planes[i], center),
+					radius))
+				{
+				case Visibility::Outside:
+					{
+						cached_plane = FrustumPlane(i);
+						return Visibility::Outside;
+					}
+				case Visibility::Intersecting:
+					{
+						result = Visibility::Intersecting;
+					} break;
+				case Visibility::Inside:
+					break;
+				}
+			}
+
+			return result;
+		}
+	}
+}
@@ -3,7 +3,10 @@
 
 #include "Plane.hpp"
 #include "Ray.hpp"
+#include "AxisAlignedBoundingBox.hpp"
 #include <cfloat>
+#include <cmath>
+#include <limits>
 
 namespace re
 {
@@ -53,6 +56,99 @@ namespace re
 
 			return true;
 		}
+
+		template<class T>
+		/** Intersects a Ray with a triangle, from both sides (Moeller-Trumbore).
+		@param[in] ray:
+			the Ray to intersect with the triangle.
+		@param[in] a, b, c:
+			the corners of the triangle.
+		@param[in] max_distance:
+			hits at or beyond this coordinate on the Ray are ignored.
+		@param[out] distance:
+			receives the coordinate of the hit on the Ray, relative to the direction vector of the ray.
+		@param[out] u, v:
+			receive the barycentric coordinates of the hit, which are the weights of `b` and `c`.
+		@return
+			whether the Ray hits the triangle at a non-negative coordinate below `max_distance`. */
+		bool intersect(
+			Ray<T> const& ray,
+			Vec3<T> const& a,
+			Vec3<T> const& b,
+			Vec3<T> const& c,
+			T max_distance,
+			T &distance,
+			T &u,
+			T &v)
+		{
+			Vec3<T> const edge1 = b - a;
+			Vec3<T> const edge2 = c - a;
+			Vec3<T> const p = cross(ray.direction, edge2);
+			T const determinant = dot(edge1, p);
+
+			// degenerate triangles and parallel rays.
+			if(!(std::abs(determinant) > std::numeric_limits<T>::min()))
+				return false;
+
+			T const inverse_determinant = T(1) / determinant;
+			Vec3<T> const s = ray.position - a;
+			T const hit_u = dot(s, p) * inverse_determinant;
+			Vec3<T> const q = cross(s, edge1);
+			T const hit_v = dot(ray.direction, q) * inverse_determinant;
+			T const hit_distance = dot(edge2, q) * inverse_determinant;
+
+			if(hit_u < T(0) || hit_v < T(0) || T(1) < hit_u + hit_v
+			|| hit_distance < T(0) || !(hit_distance < max_distance))
+				return false;
+
+			distance = hit_distance;
+			u = hit_u;
+			v = hit_v;
+			return true;
+		}
+
+		template<class T>
+		/** Intersects a Ray with a box (slab test).
+		@param[in] ray:
+			the Ray to intersect with the box.
+		@param[in] box:
+			the box. Empty boxes are never hit.
+		@param[in] max_distance:
+			hits at or beyond this coordinate on the Ray are ignored.
+		@param[out] distance:
+			receives the coordinate on the Ray where it enters the box, relative to the direction vector of the ray. It is 0 if the Ray starts inside the box.
+		@return
+			whether the Ray hits the box at a coordinate below `max_distance`. */
+		bool intersect(
+			Ray<T> const& ray,
+			AxisAlignedBoundingBox<T> const& box,
+			T max_distance,
+			T &distance)
+		{
+			if(box.empty())
+				return false;
+
+			T t_near = T(0);
+			T t_far = max_distance;
+			T const origin[3] = { ray.position.x, ray.position.y, ray.position.z };
+			T const direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+			T const min[3] = { box.min().x, box.min().y, box.min().z };
+			T const max[3] = { box.max().x, box.max().y, box.max().z };
+			for(size_t axis = 0; axis < 3; axis++)
+			{
+				T const inverse = T(1) / direction[axis];
+				T const t1 = (min[axis] - origin[axis]) * inverse;
+				T const t2 = (max[axis] - origin[axis]) * inverse;
+				t_near = math::max(t_near, math::min(t1, t2));
+				t_far = math::min(t_far, math::max(t1, t2));
+			}
+
+			if(!(t_near <= t_far) || !(t_near < max_distance))
+				return false;
+
+			distance = t_near;
+			return true;
+		}
 	}
 }
 
@@ -3,6 +3,7 @@
 
 #include "Vector.hpp"
 #include "Angle.hpp"
+#include "Quaternion.hpp"
 #include "Ray.hpp"
 
 namespace re
@@ -149,6 +150,10 @@ namespace re
 			static Mat4x4<T> rotation(Vec3<Angle> const& rotation);
 			static Mat4x4<T> scaling(Vec3<T> const& scaling);
 			static Mat4x4<T> transformation(Vec3<T> const& position, Vec3<Angle> const& rotation, Vec3<T> const& scaling);
+			/** Creates the rotation matrix of a quaternion. Non-unit quaternions are normalised implicitly. */
+			static Mat4x4<T> rotation(Quat<T> const& rotation);
+			/** Creates the matrix that scales, then rotates, then translates, directly from the quaternion, without multiplying matrices. Non-unit quaternions are normalised implicitly. */
+			static Mat4x4<T> transformation(Vec3<T> const& position, Quat<T> const& rotation, Vec3<T> const& scaling);
 			/** Kind of hacky, but works. Also, does not use inverse matrix method. maybe inverse is faster but idk. */
 			static Mat4x4<T> inverse_look_at(Mat4x4<T> const& look_at);
 
@@ -160,6 +165,27 @@ namespace re
 
 		template<class T>
 		Mat4x4<T> operator*(float a, Mat4x4<T> const& b);
+
+		template<class T>
+		/** Swaps the rows and columns of the given matrix. */
+		Mat4x4<T> transpose(Mat4x4<T> const& m);
+
+		template<class T>
+		/** Inverts the given matrix. Singular matrices yield non-finite elements. */
+		Mat4x4<T> inverse(Mat4x4<T> const& m);
+		template<class T>
+		/** Inverts the given matrix, whose last row must be `(0, 0, 0, 1)`, such as any combination of translations, rotations and scalings. This is cheaper than inverse(). Singular matrices yield non-finite elements. */
+		Mat4x4<T> affine_inverse(Mat4x4<T> const& m);
+		template<class T>
+		/** Computes the inverse transpose of the upper left 3x3 part of the given matrix, which transforms normals. Singular matrices yield non-finite elements. */
+		Mat3x3<T> inverse_transpose3x3(Mat4x4<T> const& m);
+
+		template<class T>
+		/** Inverts the given matrix. Singular matrices yield non-finite elements. */
+		Mat3x3<T> inverse(Mat3x3<T> const& m);
+		template<class T>
+		/** Computes the inverse transpose of the given matrix, which transforms normals. Singular matrices yield non-finite elements. */
+		Mat3x3<T> inverse_transpose(Mat3x3<T> const& m);
 	}
 }
 
@@ -307,6 +333,100 @@ namespace re
 			return Mat4x4<T>(a*b.v0, a*b.v1, a*b.v2, a*b.v3);
 		}
 
+		template<class T>
+		Mat4x4<T> transpose(Mat4x4<T> const& m)
+		{
+			return Mat4x4<T>(
+				Vec4<T>(m.v0.x, m.v1.x, m.v2.x, m.v3.x),
+				Vec4<T>(m.v0.y, m.v1.y, m.v2.y, m.v3.y),
+				Vec4<T>(m.v0.z, m.v1.z, m.v2.z, m.v3.z),
+				Vec4<T>(m.v0.w, m.v1.w, m.v2.w, m.v3.w));
+		}
+
+		template<class T>
+		Mat4x4<T> inverse(Mat4x4<T> const& m)
+		{
+			// Laplace expansion over the 2x2 sub-determinants of the upper and lower two rows.
+			T const s0 = m.v0.x * m.v1.y - m.v0.y * m.v1.x;
+			T const s1 = m.v0.x * m.v2.y - m.v0.y * m.v2.x;
+			T const s2 = m.v0.x * m.v3.y - m.v0.y * m.v3.x;
+			T const s3 = m.v1.x * m.v2.y - m.v1.y * m.v2.x;
+			T const s4 = m.v1.x * m.v3.y - m.v1.y * m.v3.x;
+			T const s5 = m.v2.x * m.v3.y - m.v2.y * m.v3.x;
+
+			T const c5 = m.v2.z * m.v3.w - m.v2.w * m.v3.z;
+			T const c4 = m.v1.z * m.v3.w - m.v1.w * m.v3.z;
+			T const c3 = m.v1.z * m.v2.w - m.v1.w * m.v2.z;
+			T const c2 = m.v0.z * m.v3.w - m.v0.w * m.v3.z;
+			T const c1 = m.v0.z * m.v2.w - m.v0.w * m.v2.z;
+			T const c0 = m.v0.z * m.v1.w - m.v0.w * m.v1.z;
+
+			T const inv = T(1) / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+			return Mat4x4<T>(
+				Vec4<T>(
+					( m.v1.y * c5 - m.v2.y * c4 + m.v3.y * c3) * inv,
+					(-m.v0.y * c5 + m.v2.y * c2 - m.v3.y * c1) * inv,
+					( m.v0.y * c4 - m.v1.y * c2 + m.v3.y * c0) * inv,
+					(-m.v0.y * c3 + m.v1.y * c1 - m.v2.y * c0) * inv),
+				Vec4<T>(
+					(-m.v1.x * c5 + m.v2.x * c4 - m.v3.x * c3) * inv,
+					( m.v0.x * c5 - m.v2.x * c2 + m.v3.x * c1) * inv,
+					(-m.v0.x * c4 + m.v1.x * c2 - m.v3.x * c0) * inv,
+					( m.v0.x * c3 - m.v1.x * c1 + m.v2.x * c0) * inv),
+				Vec4<T>(
+					( m.v1.w * s5 - m.v2.w * s4 + m.v3.w * s3) * inv,
+					(-m.v0.w * s5 + m.v2.w * s2 - m.v3.w * s1) * inv,
+					( m.v0.w * s4 - m.v1.w * s2 + m.v3.w * s0) * inv,
+					(-m.v0.w * s3 + m.v1.w * s1 - m.v2.w * s0) * inv),
+				Vec4<T>(
+					(-m.v1.z * s5 + m.v2.z * s4 - m.v3.z * s3) * inv,
+					( m.v0.z * s5 - m.v2.z * s2 + m.v3.z * s1) * inv,
+					(-m.v0.z * s4 + m.v1.z * s2 - m.v3.z * s0) * inv,
+					( m.v0.z * s3 - m.v1.z * s1 + m.v2.z * s0) * inv));
+		}
+
+		template<class T>
+		Mat4x4<T> affine_inverse(Mat4x4<T> const& m)
+		{
+			Mat3x3<T> const inv = inverse(Mat3x3<T>(Vec3<T>(m.v0), Vec3<T>(m.v1), Vec3<T>(m.v2)));
+			Vec3<T> const translation = inv * Vec3<T>(m.v3);
+
+			return Mat4x4<T>(
+				Vec4<T>(inv.v0, T(0)),
+				Vec4<T>(inv.v1, T(0)),
+				Vec4<T>(inv.v2, T(0)),
+				Vec4<T>(-translation.x, -translation.y, -translation.z, T(1)));
+		}
+
+		template<class T>
+		Mat3x3<T> inverse_transpose3x3(Mat4x4<T> const& m)
+		{
+			return inverse_transpose(Mat3x3<T>(Vec3<T>(m.v0), Vec3<T>(m.v1), Vec3<T>(m.v2)));
+		}
+
+		template<class T>
+		Mat3x3<T> inverse(Mat3x3<T> const& m)
+		{
+			Mat3x3<T> const it = inverse_transpose(m);
+			return Mat3x3<T>(
+				Vec3<T>(it.v0.x, it.v1.x, it.v2.x),
+				Vec3<T>(it.v0.y, it.v1.y, it.v2.y),
+				Vec3<T>(it.v0.z, it.v1.z, it.v2.z));
+		}
+
+		template<class T>
+		Mat3x3<T> inverse_transpose(Mat3x3<T> const& m)
+		{
+			// the cofactor matrix, divided by the determinant.
+			Vec3<T> const c0 = cross(m.v1, m.v2);
+			Vec3<T> const c1 = cross(m.v2, m.v0);
+			Vec3<T> const c2 = cross(m.v0, m.v1);
+			T const inv = T(1) / dot(m.v0, c0);
+
+			return Mat3x3<T>(c0 * inv, c1 * inv, c2 * inv);
+		}
+
 
 		template<class T>
 		bool Mat2x2<T>::operator==(Mat2x2<T> const& other) const
@@ -505,6 +625,29 @@ namespace re
 			return translation(position) * Mat4x4<T>::rotation(rotation) * Mat4x4<T>::scaling(scaling);
 		}
 
+		template<class T>
+		Mat4x4<T> Mat4x4<T>::rotation(Quat<T> const& rotation)
+		{
+			return transformation(Vec3<T>(), rotation, Vec3<T>(1, 1, 1));
+		}
+
+		template<class T>
+		Mat4x4<T> Mat4x4<T>::transformation(Vec3<T> const& position, Quat<T> const& rotation, Vec3<T> const& scaling)
+		{
+			// dividing by the squared length normalises the quaternion without a square root.
+			T const s = T(2) / dot(rotation, rotation);
+			T const xs = rotation.x * s, ys = rotation.y * s, zs = rotation.z * s;
+			T const xx = rotation.x * xs, yy = rotation.y * ys, zz = rotation.z * zs;
+			T const xy = rotation.x * ys, xz = rotation.x * zs, yz = rotation.y * zs;
+			T const wx = rotation.w * xs, wy = rotation.w * ys, wz = rotation.w * zs;
+
+			return Mat4x4<T>(
+				Vec4<T>((T(1) - (yy + zz)) * scaling.x, (xy + wz) * scaling.x, (xz - wy) * scaling.x, T(0)),
+				Vec4<T>((xy - wz) * scaling.y, (T(1) - (xx + zz)) * scaling.y, (yz + wx) * scaling.y, T(0)),
+				Vec4<T>((xz + wy) * scaling.z, (yz - wx) * scaling.z, (T(1) - (xx + yy)) * scaling.z, T(0)),
+				Vec4<T>(position.x, position.y, position.z, T(1)));
+		}
+
 		template<class T>
 		Mat4x4<T> Mat4x4<T>::inverse_look_at(Mat4x4<T> const& look_at)
 		{
@@ -520,4 +663,6 @@ namespace re
 
 #pragma endregion
 
+#include "MatrixSIMD.inl"
+
 #endif
@@ -0,0 +1,231 @@
+#ifndef RE_SIMD_SCALAR
+
+/* Vectorised specialisations for Mat4x4<float> and Mat3x3<float>. The templates remain the reference implementation, and are used instead if RE_SIMD_SCALAR is defined. transpose() has no specialisation, as re_simd_ops measures the shuffles to be no faster than the template's element copies. */
+
+namespace re
+{
+	namespace math
+	{
+		namespace detail
+		{
+			/** Multiplies a matrix, given as columns, with a column vector. */
+			REIL simd::float4 mul_columns(
+				simd::float4 c0,
+				simd::float4 c1,
+				simd::float4 c2,
+				simd::float4 c3,
+				simd::float4 v)
+			{
+				simd::float4 r = simd::mul(c0, simd::broadcast<0>(v));
+				r = simd::madd(c1, simd::broadcast<1>(v), r);
+				r = simd::madd(c2, simd::broadcast<2>(v), r);
+				return simd::madd(c3, simd::broadcast<3>(v), r);
+			}
+
+			/** Multiplies two 2x2 matrices, stored row-wise in the lanes. */
+			REIL simd::float4 mat2_mul(simd::float4 a, simd::float4 b)
+			{
+				return simd::madd(
+					a, simd::shuffle<0,3,0,3>(b, b),
+					simd::mul(simd::shuffle<1,0,3,2>(a, a), simd::shuffle<2,1,2,1>(b, b)));
+			}
+
+			/** Multiplies the adjugate of a 2x2 matrix with another 2x2 matrix. */
+			REIL simd::float4 mat2_adj_mul(simd::float4 a, simd::float4 b)
+			{
+				return simd::sub(
+					simd::mul(simd::shuffle<3,3,0,0>(a, a), b),
+					simd::mul(simd::shuffle<1,1,2,2>(a, a), simd::shuffle<2,3,0,1>(b, b)));
+			}
+
+			/** Multiplies a 2x2 matrix with the adjugate of another 2x2 matrix. */
+			REIL simd::float4 mat2_mul_adj(simd::float4 a, simd::float4 b)
+			{
+				return simd::sub(
+					simd::mul(a, simd::shuffle<3,0,3,0>(b, b)),
+					simd::mul(simd::shuffle<1,0,3,2>(a, a), simd::shuffle<2,1,2,1>(b, b)));
+			}
+
+			/** The rows of the inverse of the 3x3 matrix with the columns `a`, `b` and `c`, up to the determinant, which is returned in all lanes. Their fourth lanes are 0 for finite matrices, the fourth lanes of the columns are ignored. */
+			REIL simd::float4 cofactors3x3(
+				simd::float4 a,
+				simd::float4 b,
+				simd::float4 c,
+				simd::float4 &r0,
+				simd::float4 &r1,
+				simd::float4 &r2)
+			{
+				r0 = simd::cross3(b, c);
+				r1 = simd::cross3(c, a);
+				r2 = simd::cross3(a, b);
+				return simd::dot4(a, r0);
+			}
+
+			/** The rows of the inverse of the upper left 3x3 part of a matrix, up to the determinant, which is returned in all lanes. */
+			REIL simd::float4 cofactors3x3(
+				Mat4x4<float> const& m,
+				simd::float4 &r0,
+				simd::float4 &r1,
+				simd::float4 &r2)
+			{
+				return cofactors3x3(simd::load(m.v0), simd::load(m.v1), simd::load(m.v2), r0, r1, r2);
+			}
+
+			/** The rows of the inverse transpose of a matrix, up to the determinant, which is returned in all lanes. */
+			REIL simd::float4 cofactors3x3(
+				Mat3x3<float> const& m,
+				simd::float4 &r0,
+				simd::float4 &r1,
+				simd::float4 &r2)
+			{
+				// the columns are packed, so the last one is loaded from one element before it, to not read past the matrix.
+				simd::float4 const c = simd::loadu(&m.v1.z);
+				return cofactors3x3(
+					simd::loadu(&m.v0.x),
+					simd::loadu(&m.v1.x),
+					simd::shuffle<1,2,3,3>(c, c),
+					r0, r1, r2);
+			}
+
+			/** Stores the first three lanes of the columns into a 3x3 matrix. */
+			REIL Mat3x3<float> to_mat3x3(
+				simd::float4 c0,
+				simd::float4 c1,
+				simd::float4 c2)
+			{
+				static_assert(sizeof(Mat3x3<float>) == 9 * sizeof(float), "The columns of a Mat3x3<float> must be packed.");
+				Mat3x3<float> result = Mat3x3<float>(Vec3<float>(), Vec3<float>(), Vec3<float>());
+				// the columns are packed, so the stores overlap, and the last one is stored from one element before it.
+				simd::storeu(&result.v0.x, c0);
+				simd::storeu(&result.v1.x, c1);
+				simd::float4 const c1_z = simd::shuffle<2,2,0,0>(c1, c2);
+				simd::storeu(&result.v1.z, simd::shuffle<0,2,1,2>(c1_z, c2));
+				return result;
+			}
+		}
+
+		template<>
+		REIL Mat4x4<float> Mat4x4<float>::operator*(Mat4x4<float> const& rval) const
+		{
+			simd::float4 const c0 = simd::load(v0);
+			simd::float4 const c1 = simd::load(v1);
+			simd::float4 const c2 = simd::load(v2);
+			simd::float4 const c3 = simd::load(v3);
+
+			return Mat4x4<float>(
+				simd::to_vec4(detail::mul_columns(c0, c1, c2, c3, simd::load(rval.v0))),
+				simd::to_vec4(detail::mul_columns(c0, c1, c2, c3, simd::load(rval.v1))),
+				simd::to_vec4(detail::mul_columns(c0, c1, c2, c3, simd::load(rval.v2))),
+				simd::to_vec4(detail::mul_columns(c0, c1, c2, c3, simd::load(rval.v3))));
+		}
+
+		template<>
+		REIL Vec4<float> Mat4x4<float>::operator*(Vec4<float> const& rval) const
+		{
+			return simd::to_vec4(detail::mul_columns(
+				simd::load(v0),
+				simd::load(v1),
+				simd::load(v2),
+				simd::load(v3),
+				simd::load(rval)));
+		}
+
+		REIL Mat4x4<float> inverse(Mat4x4<float> const& m)
+		{
+			// the block method on the 2x2 sub matrices. The columns are used as the rows of the transpose, whose inverse has the columns of the inverse as rows.
+			simd::float4 const r0 = simd::load(m.v0);
+			simd::float4 const r1 = simd::load(m.v1);
+			simd::float4 const r2 = simd::load(m.v2);
+			simd::float4 const r3 = simd::load(m.v3);
+
+			simd::float4 const a = simd::shuffle<0,1,0,1>(r0, r1);
+			simd::float4 const b = simd::shuffle<2,3,2,3>(r0, r1);
+			simd::float4 const c = simd::shuffle<0,1,0,1>(r2, r3);
+			simd::float4 const d = simd::shuffle<2,3,2,3>(r2, r3);
+
+			// (|a|, |b|, |c|, |d|).
+			simd::float4 const det_sub = simd::sub(
+				simd::mul(simd::shuffle<0,2,0,2>(r0, r2), simd::shuffle<1,3,1,3>(r1, r3)),
+				simd::mul(simd::shuffle<1,3,1,3>(r0, r2), simd::shuffle<0,2,0,2>(r1, r3)));
+			simd::float4 const det_a = simd::broadcast<0>(det_sub);
+			simd::float4 const det_b = simd::broadcast<1>(det_sub);
+			simd::float4 const det_c = simd::broadcast<2>(det_sub);
+			simd::float4 const det_d = simd::broadcast<3>(det_sub);
+
+			simd::float4 const d_c = detail::mat2_adj_mul(d, c);
+			simd::float4 const a_b = detail::mat2_adj_mul(a, b);
+
+			// the adjugates of the blocks of the inverse.
+			simd::float4 x = simd::sub(simd::mul(det_d, a), detail::mat2_mul(b, d_c));
+			simd::float4 w = simd::sub(simd::mul(det_a, d), detail::mat2_mul(c, a_b));
+			simd::float4 y = simd::sub(simd::mul(det_b, c), detail::mat2_mul_adj(d, a_b));
+			simd::float4 z = simd::sub(simd::mul(det_c, b), detail::mat2_mul_adj(a, d_c));
+
+			simd::float4 const det = simd::sub(
+				simd::madd(det_a, det_d, simd::mul(det_b, det_c)),
+				simd::dot4(a_b, simd::shuffle<0,2,1,3>(d_c, d_c)));
+			// the signs of the adjugate.
+			simd::float4 const inv = simd::div(simd::set(1.0f, -1.0f, -1.0f, 1.0f), det);
+			x = simd::mul(x, inv);
+			y = simd::mul(y, inv);
+			z = simd::mul(z, inv);
+			w = simd::mul(w, inv);
+
+			return Mat4x4<float>(
+				simd::to_vec4(simd::shuffle<3,1,3,1>(x, y)),
+				simd::to_vec4(simd::shuffle<2,0,2,0>(x, y)),
+				simd::to_vec4(simd::shuffle<3,1,3,1>(z, w)),
+				simd::to_vec4(simd::shuffle<2,0,2,0>(z, w)));
+		}
+
+		REIL Mat4x4<float> affine_inverse(Mat4x4<float> const& m)
+		{
+			simd::float4 r0, r1, r2;
+			simd::float4 const inv = simd::div(simd::splat(1.0f), detail::cofactors3x3(m, r0, r1, r2));
+			r0 = simd::mul(r0, inv);
+			r1 = simd::mul(r1, inv);
+			r2 = simd::mul(r2, inv);
+			simd::float4 r3 = simd::zero();
+			simd::transpose(r0, r1, r2, r3);
+
+			simd::float4 const t = simd::load(m.v3);
+			simd::float4 const translation = simd::sub(
+				simd::set(0.0f, 0.0f, 0.0f, 1.0f),
+				simd::madd(r0, simd::broadcast<0>(t), simd::madd(r1, simd::broadcast<1>(t), simd::mul(r2, simd::broadcast<2>(t)))));
+
+			return Mat4x4<float>(
+				simd::to_vec4(r0),
+				simd::to_vec4(r1),
+				simd::to_vec4(r2),
+				simd::to_vec4(translation));
+		}
+
+		REIL Mat3x3<float> inverse_transpose3x3(Mat4x4<float> const& m)
+		{
+			simd::float4 r0, r1, r2;
+			simd::float4 const inv = simd::div(simd::splat(1.0f), detail::cofactors3x3(m, r0, r1, r2));
+			return detail::to_mat3x3(simd::mul(r0, inv), simd::mul(r1, inv), simd::mul(r2, inv));
+		}
+
+		REIL Mat3x3<float> inverse(Mat3x3<float> const& m)
+		{
+			simd::float4 r0, r1, r2;
+			simd::float4 const inv = simd::div(simd::splat(1.0f), detail::cofactors3x3(m, r0, r1, r2));
+			r0 = simd::mul(r0, inv);
+			r1 = simd::mul(r1, inv);
+			r2 = simd::mul(r2, inv);
+			simd::float4 r3 = simd::zero();
+			simd::transpose(r0, r1, r2, r3);
+			return detail::to_mat3x3(r0, r1, r2);
+		}
+
+		REIL Mat3x3<float> inverse_transpose(Mat3x3<float> const& m)
+		{
+			simd::float4 r0, r1, r2;
+			simd::float4 const inv = simd::div(simd::splat(1.0f), detail::cofactors3x3(m, r0, r1, r2));
+			return detail::to_mat3x3(simd::mul(r0, inv), simd::mul(r1, inv), simd::mul(r2, inv));
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,393 @@
+#include "NumericFormat.hpp"
+#include "SIMD.hpp"
+#include "../LogFile.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		namespace
+		{
+#if defined(RE_SIMD_SSE)
+			/** Clamps, scales and rounds four floats to normalised integers, like `detail::to_norm()`. */
+			REIL __m128i to_norm(__m128 x, __m128 min, __m128 scale)
+			{
+				// the second operand is returned for NaN.
+				return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, min), _mm_set1_ps(1.0f)), scale));
+			}
+
+			REIL __m128i select(__m128i mask, __m128i a, __m128i b)
+			{
+				return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+			}
+
+			/** Converts four floats to halves in the low 16 bits of each lane, without the sign, like `to_half()`. */
+			REIL __m128i to_half_bits(__m128i bits)
+			{
+				__m128i const magic = _mm_set1_epi32((127 - 15 + 23 - 10 + 1) << 23);
+				__m128i const subnormal = _mm_sub_epi32(
+					_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(magic))),
+					magic);
+
+				__m128i const odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+				__m128i const normal = _mm_srli_epi32(
+					_mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), odd),
+					13);
+
+				__m128i const special = select(
+					_mm_cmpgt_epi32(bits, _mm_set1_epi32(0x7f800000)),
+					_mm_set1_epi32(0x7e00),
+					_mm_set1_epi32(0x7c00));
+
+				__m128i const finite = select(_mm_cmplt_epi32(bits, _mm_set1_epi32((127 - 14) << 23)), subnormal, normal);
+				return select(_mm_cmpgt_epi32(bits, _mm_set1_epi32(((127 + 16) << 23) - 1)), special, finite);
+			}
+
+			/** Converts four halves in the low 16 bits of each lane to floats, like `from_half()`. */
+			REIL __m128 from_half_bits(__m128i half)
+			{
+				__m128i const exponent = _mm_set1_epi32(0x7c00 << 13);
+				__m128i bits = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7fff)), 13);
+				__m128i const shifted_exponent = _mm_and_si128(bits, exponent);
+				__m128i const rebias = _mm_set1_epi32((127 - 15) << 23);
+				bits = _mm_add_epi32(bits, rebias);
+
+				// infinity or NaN: the same offset again.
+				bits = _mm_add_epi32(bits, _mm_and_si128(_mm_cmpeq_epi32(shifted_exponent, exponent), rebias));
+				__m128 const subnormal = _mm_sub_ps(
+					_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))),
+					_mm_castsi128_ps(_mm_set1_epi32((127 - 14) << 23)));
+				bits = select(_mm_cmpeq_epi32(shifted_exponent, _mm_setzero_si128()), _mm_castps_si128(subnormal), bits);
+
+				return _mm_castsi128_ps(_mm_or_si128(bits,
+					_mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16)));
+			}
+
+			/** Sign-extends the low four shorts to ints. */
+			REIL __m128i extend_low(__m128i shorts)
+			{
+				return _mm_srai_epi32(_mm_unpacklo_epi16(shorts, shorts), 16);
+			}
+
+			/** Sign-extends the high four shorts to ints. */
+			REIL __m128i extend_high(__m128i shorts)
+			{
+				return _mm_srai_epi32(_mm_unpackhi_epi16(shorts, shorts), 16);
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			/** Clamps, scales and rounds four floats to normalised integers, like `detail::to_norm()`. */
+			REIL int32x4_t to_norm(float32x4_t x, float32x4_t min, float32x4_t scale)
+			{
+				// returns the number for NaN.
+				return vcvtnq_s32_f32(vmulq_f32(vminq_f32(vmaxnmq_f32(x, min), vdupq_n_f32(1.0f)), scale));
+			}
+#endif
+		}
+
+		void to_half(
+			float const * in,
+			size_t count,
+			half_t * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_F16C)
+			for(; i + 8 <= count; i += 8)
+				_mm_storeu_si128(
+					reinterpret_cast<__m128i *>(out + i),
+					_mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(RE_SIMD_SSE)
+			__m128i const sign_mask = _mm_set1_epi32(int32_t(0x80000000u));
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const bits0 = _mm_castps_si128(_mm_loadu_ps(in + i));
+				__m128i const bits1 = _mm_castps_si128(_mm_loadu_ps(in + i + 4));
+				__m128i const sign0 = _mm_and_si128(bits0, sign_mask);
+				__m128i const sign1 = _mm_and_si128(bits1, sign_mask);
+				// the halves fit into signed shorts without their sign, and the shifted signs saturate to 0x8000.
+				__m128i const half = _mm_packs_epi32(
+					to_half_bits(_mm_xor_si128(bits0, sign0)),
+					to_half_bits(_mm_xor_si128(bits1, sign1)));
+				__m128i const sign = _mm_packs_epi32(_mm_srai_epi32(sign0, 16), _mm_srai_epi32(sign1, 16));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(half, sign));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			for(; i + 4 <= count; i += 4)
+				vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+#endif
+			for(; i < count; i++)
+				out[i] = to_half(in[i]);
+		}
+
+		void from_half(
+			half_t const * in,
+			size_t count,
+			float * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_F16C)
+			for(; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(out + i,
+					_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i))));
+#elif defined(RE_SIMD_SSE)
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const half = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+				_mm_storeu_ps(out + i, from_half_bits(_mm_unpacklo_epi16(half, _mm_setzero_si128())));
+				_mm_storeu_ps(out + i + 4, from_half_bits(_mm_unpackhi_epi16(half, _mm_setzero_si128())));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			for(; i + 4 <= count; i += 4)
+				vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+#endif
+			for(; i < count; i++)
+				out[i] = from_half(in[i]);
+		}
+
+		void to_snorm8(
+			float const * in,
+			size_t count,
+			int8_t * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(127.0f);
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i const low = _mm_packs_epi32(
+					to_norm(_mm_loadu_ps(in + i), min, scale),
+					to_norm(_mm_loadu_ps(in + i + 4), min, scale));
+				__m128i const high = _mm_packs_epi32(
+					to_norm(_mm_loadu_ps(in + i + 8), min, scale),
+					to_norm(_mm_loadu_ps(in + i + 12), min, scale));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi16(low, high));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(-1.0f), scale = vdupq_n_f32(127.0f);
+			for(; i + 8 <= count; i += 8)
+				vst1_s8(out + i, vqmovn_s16(vcombine_s16(
+					vqmovn_s32(to_norm(vld1q_f32(in + i), min, scale)),
+					vqmovn_s32(to_norm(vld1q_f32(in + i + 4), min, scale)))));
+#endif
+			for(; i < count; i++)
+				out[i] = to_snorm8(in[i]);
+		}
+
+		void from_snorm8(
+			int8_t const * in,
+			size_t count,
+			float * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(127.0f);
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+				__m128i const shorts[2] = {
+					_mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8),
+					_mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8)
+				};
+				for(size_t j = 0; j < 2; j++)
+				{
+					_mm_storeu_ps(out + i + 8*j, _mm_max_ps(min, _mm_div_ps(_mm_cvtepi32_ps(extend_low(shorts[j])), scale)));
+					_mm_storeu_ps(out + i + 8*j + 4, _mm_max_ps(min, _mm_div_ps(_mm_cvtepi32_ps(extend_high(shorts[j])), scale)));
+				}
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(-1.0f), scale = vdupq_n_f32(127.0f);
+			for(; i + 8 <= count; i += 8)
+			{
+				int16x8_t const shorts = vmovl_s8(vld1_s8(in + i));
+				vst1q_f32(out + i, vmaxq_f32(min, vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(shorts))), scale)));
+				vst1q_f32(out + i + 4, vmaxq_f32(min, vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(shorts))), scale)));
+			}
+#endif
+			for(; i < count; i++)
+				out[i] = from_snorm8(in[i]);
+		}
+
+		void to_unorm8(
+			float const * in,
+			size_t count,
+			uint8_t * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_setzero_ps(), scale = _mm_set1_ps(255.0f);
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i const low = _mm_packs_epi32(
+					to_norm(_mm_loadu_ps(in + i), min, scale),
+					to_norm(_mm_loadu_ps(in + i + 4), min, scale));
+				__m128i const high = _mm_packs_epi32(
+					to_norm(_mm_loadu_ps(in + i + 8), min, scale),
+					to_norm(_mm_loadu_ps(in + i + 12), min, scale));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(0.0f), scale = vdupq_n_f32(255.0f);
+			for(; i + 8 <= count; i += 8)
+				vst1_u8(out + i, vqmovn_u16(vcombine_u16(
+					vqmovun_s32(to_norm(vld1q_f32(in + i), min, scale)),
+					vqmovun_s32(to_norm(vld1q_f32(in + i + 4), min, scale)))));
+#endif
+			for(; i < count; i++)
+				out[i] = to_unorm8(in[i]);
+		}
+
+		void from_unorm8(
+			uint8_t const * in,
+			size_t count,
+			float * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const scale = _mm_set1_ps(255.0f);
+			__m128i const zero = _mm_setzero_si128();
+			for(; i + 16 <= count; i += 16)
+			{
+				__m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+				__m128i const shorts[2] = {
+					_mm_unpacklo_epi8(bytes, zero),
+					_mm_unpackhi_epi8(bytes, zero)
+				};
+				for(size_t j = 0; j < 2; j++)
+				{
+					_mm_storeu_ps(out + i + 8*j, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(shorts[j], zero)), scale));
+					_mm_storeu_ps(out + i + 8*j + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(shorts[j], zero)), scale));
+				}
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const scale = vdupq_n_f32(255.0f);
+			for(; i + 8 <= count; i += 8)
+			{
+				uint16x8_t const shorts = vmovl_u8(vld1_u8(in + i));
+				vst1q_f32(out + i, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(shorts))), scale));
+				vst1q_f32(out + i + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(shorts))), scale));
+			}
+#endif
+			for(; i < count; i++)
+				out[i] = from_unorm8(in[i]);
+		}
+
+		void to_snorm16(
+			float const * in,
+			size_t count,
+			int16_t * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+			for(; i + 8 <= count; i += 8)
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(
+					to_norm(_mm_loadu_ps(in + i), min, scale),
+					to_norm(_mm_loadu_ps(in + i + 4), min, scale)));
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(-1.0f), scale = vdupq_n_f32(32767.0f);
+			for(; i + 4 <= count; i += 4)
+				vst1_s16(out + i, vqmovn_s32(to_norm(vld1q_f32(in + i), min, scale)));
+#endif
+			for(; i < count; i++)
+				out[i] = to_snorm16(in[i]);
+		}
+
+		void from_snorm16(
+			int16_t const * in,
+			size_t count,
+			float * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_set1_ps(-1.0f), scale = _mm_set1_ps(32767.0f);
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const shorts = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+				_mm_storeu_ps(out + i, _mm_max_ps(min, _mm_div_ps(_mm_cvtepi32_ps(extend_low(shorts)), scale)));
+				_mm_storeu_ps(out + i + 4, _mm_max_ps(min, _mm_div_ps(_mm_cvtepi32_ps(extend_high(shorts)), scale)));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(-1.0f), scale = vdupq_n_f32(32767.0f);
+			for(; i + 4 <= count; i += 4)
+				vst1q_f32(out + i, vmaxq_f32(min, vdivq_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(in + i))), scale)));
+#endif
+			for(; i < count; i++)
+				out[i] = from_snorm16(in[i]);
+		}
+
+		void to_unorm16(
+			float const * in,
+			size_t count,
+			uint16_t * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const min = _mm_setzero_ps(), scale = _mm_set1_ps(65535.0f);
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const low = to_norm(_mm_loadu_ps(in + i), min, scale);
+				__m128i const high = to_norm(_mm_loadu_ps(in + i + 4), min, scale);
+#ifdef RE_SIMD_SSE41
+				__m128i const shorts = _mm_packus_epi32(low, high);
+#else
+				// without unsigned saturation, the values are packed as signed, offset by 2^15.
+				__m128i const offset = _mm_set1_epi32(0x8000);
+				__m128i const shorts = _mm_xor_si128(
+					_mm_packs_epi32(_mm_sub_epi32(low, offset), _mm_sub_epi32(high, offset)),
+					_mm_set1_epi16(int16_t(0x8000)));
+#endif
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), shorts);
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const min = vdupq_n_f32(0.0f), scale = vdupq_n_f32(65535.0f);
+			for(; i + 4 <= count; i += 4)
+				vst1_u16(out + i, vqmovun_s32(to_norm(vld1q_f32(in + i), min, scale)));
+#endif
+			for(; i < count; i++)
+				out[i] = to_unorm16(in[i]);
+		}
+
+		void from_unorm16(
+			uint16_t const * in,
+			size_t count,
+			float * out)
+		{
+			RE_DBG_ASSERT(!count || (in && out));
+
+			size_t i = 0;
+#if defined(RE_SIMD_SSE)
+			__m128 const scale = _mm_set1_ps(65535.0f);
+			__m128i const zero = _mm_setzero_si128();
+			for(; i + 8 <= count; i += 8)
+			{
+				__m128i const shorts = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+				_mm_storeu_ps(out + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(shorts, zero)), scale));
+				_mm_storeu_ps(out + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(shorts, zero)), scale));
+			}
+#elif defined(RE_SIMD_NEON) && defined(__aarch64__)
+			float32x4_t const scale = vdupq_n_f32(65535.0f);
+			for(; i + 4 <= count; i += 4)
+				vst1q_f32(out + i, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vld1_u16(in + i))), scale));
+#endif
+			for(; i < count; i++)
+				out[i] = from_unorm16(in[i]);
+		}
+	}
+}
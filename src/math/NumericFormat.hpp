@@ -0,0 +1,108 @@
+#ifndef __re_math_numericformat_hpp_defined
+#define __re_math_numericformat_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		/* Conversions between floats and compact numeric formats, so that vertex data, bitmaps and assets can be stored and uploaded at half or a quarter of their size.
+		The array conversions use F16C or SSE2 on x86 and NEON on AArch64, and the scalar conversions for the remainder, with identical results.
+		Normalised integers follow OpenGL: unsigned formats map [0, 1] to [0, 2^n-1], and signed formats map [-1, 1] to [-(2^(n-1)-1), 2^(n-1)-1]. Floats are clamped and rounded to the nearest integer, and NaN becomes the lowest value. */
+
+		/** The bits of an IEEE 754 half-precision float. Not to be confused with `hvec*_t`, which hold shorts. */
+		typedef uint16_t half_t;
+
+		/** Converts a float to a half, rounding to the nearest half. Values beyond the half range become infinities, and NaNs stay NaNs. */
+		REIL half_t to_half(float x);
+		/** Converts a half to a float, exactly. */
+		REIL float from_half(half_t x);
+
+		/** Converts a float in [-1, 1] to a signed normalised byte. */
+		REIL int8_t to_snorm8(float x);
+		/** Converts a signed normalised byte to a float in [-1, 1]. */
+		REIL float from_snorm8(int8_t x);
+		/** Converts a float in [0, 1] to an unsigned normalised byte. */
+		REIL uint8_t to_unorm8(float x);
+		/** Converts an unsigned normalised byte to a float in [0, 1]. */
+		REIL float from_unorm8(uint8_t x);
+		/** Converts a float in [-1, 1] to a signed normalised short. */
+		REIL int16_t to_snorm16(float x);
+		/** Converts a signed normalised short to a float in [-1, 1]. */
+		REIL float from_snorm16(int16_t x);
+		/** Converts a float in [0, 1] to an unsigned normalised short. */
+		REIL uint16_t to_unorm16(float x);
+		/** Converts an unsigned normalised short to a float in [0, 1]. */
+		REIL float from_unorm16(uint16_t x);
+
+		/** Converts floats to halves.
+		@param[in] in:
+			The floats.
+		@param[in] count:
+			How many values to convert.
+		@param[out] out:
+			Receives the halves. Must not overlap `in`. */
+		void to_half(
+			float const * in,
+			size_t count,
+			half_t * out);
+		/** Converts halves to floats.
+		@param[in] in:
+			The halves.
+		@param[in] count:
+			How many values to convert.
+		@param[out] out:
+			Receives the floats. Must not overlap `in`. */
+		void from_half(
+			half_t const * in,
+			size_t count,
+			float * out);
+
+		/** Converts floats to signed normalised bytes. Arguments as for `to_half()`. */
+		void to_snorm8(
+			float const * in,
+			size_t count,
+			int8_t * out);
+		/** Converts signed normalised bytes to floats. Arguments as for `from_half()`. */
+		void from_snorm8(
+			int8_t const * in,
+			size_t count,
+			float * out);
+		/** Converts floats to unsigned normalised bytes. Arguments as for `to_half()`. */
+		void to_unorm8(
+			float const * in,
+			size_t count,
+			uint8_t * out);
+		/** Converts unsigned normalised bytes to floats. Arguments as for `from_half()`. */
+		void from_unorm8(
+			uint8_t const * in,
+			size_t count,
+			float * out);
+		/** Converts floats to signed normalised shorts. Arguments as for `to_half()`. */
+		void to_snorm16(
+			float const * in,
+			size_t count,
+			int16_t * out);
+		/** Converts signed normalised shorts to floats. Arguments as for `from_half()`. */
+		void from_snorm16(
+			int16_t const * in,
+			size_t count,
+			float * out);
+		/** Converts floats to unsigned normalised shorts. Arguments as for `to_half()`. */
+		void to_unorm16(
+			float const * in,
+			size_t count,
+			uint16_t * out);
+		/** Converts unsigned normalised shorts to floats. Arguments as for `from_half()`. */
+		void from_unorm16(
+			uint16_t const * in,
+			size_t count,
+			float * out);
+	}
+}
+
+#include "NumericFormat.inl"
+
+#endif
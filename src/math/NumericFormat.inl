@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cstring>
+
+namespace re
+{
+	namespace math
+	{
+		namespace detail
+		{
+			REIL uint32_t float_bits(float x)
+			{
+				uint32_t bits;
+				std::memcpy(&bits, &x, sizeof(bits));
+				return bits;
+			}
+
+			REIL float bits_float(uint32_t bits)
+			{
+				float x;
+				std::memcpy(&x, &bits, sizeof(x));
+				return x;
+			}
+
+			/** Clamps, scales and rounds a float to a normalised integer. `std::max` is called so that NaN becomes `min`. */
+			REIL int32_t to_norm(float x, float min, float scale)
+			{
+				float const scaled = std::min(1.0f, std::max(min, x)) * scale;
+				// adding 1.5 * 2^23 rounds to the nearest even integer, like the SIMD conversions, but without a library call.
+				return int32_t((scaled + 12582912.0f) - 12582912.0f);
+			}
+		}
+
+		half_t to_half(float x)
+		{
+			// rounds to nearest even by adding to the bits that get cut off (Giesen).
+			uint32_t bits = detail::float_bits(x);
+			uint32_t const sign = bits & 0x80000000u;
+			bits ^= sign;
+
+			uint32_t half;
+			if(bits >= (127u + 16u) << 23)
+				// too large, infinity, or NaN.
+				half = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+			else if(bits < (127u - 14u) << 23)
+			{
+				// subnormal or zero: the float addition aligns and rounds the mantissa.
+				uint32_t const magic = (127u - 15u + 23u - 10u + 1u) << 23;
+				half = detail::float_bits(detail::bits_float(bits) + detail::bits_float(magic)) - magic;
+			} else
+			{
+				uint32_t const odd = (bits >> 13) & 1u;
+				bits += ((15u - 127u) << 23) + 0xfffu + odd;
+				half = bits >> 13;
+			}
+
+			return half_t(half | (sign >> 16));
+		}
+
+		float from_half(half_t x)
+		{
+			uint32_t const exponent = 0x7c00u << 13;
+			uint32_t bits = uint32_t(x & 0x7fffu) << 13;
+			uint32_t const shifted_exponent = bits & exponent;
+			bits += (127u - 15u) << 23;
+
+			if(shifted_exponent == exponent)
+				// infinity or NaN.
+				bits += (128u - 16u) << 23;
+			else if(!shifted_exponent)
+			{
+				// subnormal or zero: renormalised by a float subtraction.
+				bits += 1u << 23;
+				bits = detail::float_bits(detail::bits_float(bits) - detail::bits_float((127u - 14u) << 23));
+			}
+
+			return detail::bits_float(bits | (uint32_t(x & 0x8000u) << 16));
+		}
+
+		int8_t to_snorm8(float x)
+		{
+			return int8_t(detail::to_norm(x, -1.0f, 127.0f));
+		}
+
+		float from_snorm8(int8_t x)
+		{
+			return std::max(-1.0f, float(x) / 127.0f);
+		}
+
+		uint8_t to_unorm8(float x)
+		{
+			return uint8_t(detail::to_norm(x, 0.0f, 255.0f));
+		}
+
+		float from_unorm8(uint8_t x)
+		{
+			return float(x) / 255.0f;
+		}
+
+		int16_t to_snorm16(float x)
+		{
+			return int16_t(detail::to_norm(x, -1.0f, 32767.0f));
+		}
+
+		float from_snorm16(int16_t x)
+		{
+			return std::max(-1.0f, float(x) / 32767.0f);
+		}
+
+		uint16_t to_unorm16(float x)
+		{
+			return uint16_t(detail::to_norm(x, 0.0f, 65535.0f));
+		}
+
+		float from_unorm16(uint16_t x)
+		{
+			return float(x) / 65535.0f;
+		}
+	}
+}
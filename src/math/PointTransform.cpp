@@ -0,0 +1,397 @@
+#include "PointTransform.hpp"
+#include "../LogFile.hpp"
+
+#include <limits>
+
+namespace re
+{
+	namespace math
+	{
+		namespace
+		{
+			template<class L>
+			/** The matrix, with every element splatted across the lanes. */
+			struct Splatted
+			{
+				typename L::type m[4][4];
+
+				explicit Splatted(fmat4x4_t const& mat)
+				{
+					fvec4_t const * const columns[4] = { &mat.v0, &mat.v1, &mat.v2, &mat.v3 };
+					for(size_t column = 0; column < 4; column++)
+					{
+						m[column][0] = L::splat(columns[column]->x);
+						m[column][1] = L::splat(columns[column]->y);
+						m[column][2] = L::splat(columns[column]->z);
+						m[column][3] = L::splat(columns[column]->w);
+					}
+				}
+
+				/** Computes a row of the matrix times `(x, y, z, 1)`. */
+				template<size_t row>
+				REIL typename L::type apply(
+					typename L::type x,
+					typename L::type y,
+					typename L::type z) const
+				{
+					return L::madd(m[0][row], x, L::madd(m[1][row], y, L::madd(m[2][row], z, m[3][row])));
+				}
+
+				template<bool k_projective>
+				/** Transforms the given points in place. */
+				REIL void transform(
+					typename L::type &x,
+					typename L::type &y,
+					typename L::type &z) const
+				{
+					typename L::type const rx = apply<0>(x, y, z);
+					typename L::type const ry = apply<1>(x, y, z);
+					typename L::type const rz = apply<2>(x, y, z);
+					if(k_projective)
+					{
+						typename L::type const w = apply<3>(x, y, z);
+						x = L::div(rx, w);
+						y = L::div(ry, w);
+						z = L::div(rz, w);
+					} else
+					{
+						x = rx;
+						y = ry;
+						z = rz;
+					}
+				}
+			};
+
+			template<bool k_projective>
+			/** Transforms a single point, for the remainder of a batch. */
+			REIL fvec3_t transform_point(
+				fmat4x4_t const& m,
+				float x,
+				float y,
+				float z)
+			{
+				fvec3_t const r(
+					m.v0.x * x + m.v1.x * y + m.v2.x * z + m.v3.x,
+					m.v0.y * x + m.v1.y * y + m.v2.y * z + m.v3.y,
+					m.v0.z * x + m.v1.z * y + m.v2.z * z + m.v3.z);
+
+				if(!k_projective)
+					return r;
+
+				float const w = m.v0.w * x + m.v1.w * y + m.v2.w * z + m.v3.w;
+				return fvec3_t(r.x / w, r.y / w, r.z / w);
+			}
+
+			REIL float const * point_at(fvec3_t const * first, size_t stride, size_t i)
+			{
+				return reinterpret_cast<float const *>(reinterpret_cast<char const *>(first) + i * stride);
+			}
+
+			REIL float * point_at(fvec3_t * first, size_t stride, size_t i)
+			{
+				return reinterpret_cast<float *>(reinterpret_cast<char *>(first) + i * stride);
+			}
+
+			/** Loads the strided points `i` to `i+3` and transposes them into coordinate registers. The points are loaded 16 bytes at a time, so the point `i+4` must exist. */
+			REIL void load_strided(
+				fvec3_t const * in,
+				size_t stride,
+				size_t i,
+				simd::float4 &x,
+				simd::float4 &y,
+				simd::float4 &z)
+			{
+				x = simd::loadu(point_at(in, stride, i));
+				y = simd::loadu(point_at(in, stride, i+1));
+				z = simd::loadu(point_at(in, stride, i+2));
+				simd::float4 w = simd::loadu(point_at(in, stride, i+3));
+				simd::transpose(x, y, z, w);
+			}
+
+			template<class L, bool k_projective>
+			void transform_soa(
+				fmat4x4_t const& m,
+				float const * x,
+				float const * y,
+				float const * z,
+				size_t count,
+				float * out_x,
+				float * out_y,
+				float * out_z)
+			{
+				RE_DBG_ASSERT(!count || (x && y && z && out_x && out_y && out_z));
+
+				Splatted<L> const splatted(m);
+
+				size_t i = 0;
+				for(; i + L::k_width <= count; i += L::k_width)
+				{
+					typename L::type px = L::load(x + i);
+					typename L::type py = L::load(y + i);
+					typename L::type pz = L::load(z + i);
+					splatted.template transform<k_projective>(px, py, pz);
+					L::store(out_x + i, px);
+					L::store(out_y + i, py);
+					L::store(out_z + i, pz);
+				}
+
+				for(; i < count; i++)
+				{
+					fvec3_t const p = transform_point<k_projective>(m, x[i], y[i], z[i]);
+					out_x[i] = p.x;
+					out_y[i] = p.y;
+					out_z[i] = p.z;
+				}
+			}
+
+			template<bool k_projective>
+			void transform_strided(
+				fmat4x4_t const& m,
+				fvec3_t const * in,
+				size_t in_stride,
+				size_t count,
+				fvec3_t * out,
+				size_t out_stride)
+			{
+				RE_DBG_ASSERT(!count || (in && out));
+				RE_DBG_ASSERT(in_stride >= sizeof(fvec3_t));
+				RE_DBG_ASSERT(out_stride >= sizeof(fvec3_t));
+
+				Splatted<simd::Lanes4> const splatted(m);
+
+				size_t i = 0;
+				// the last point is not loaded 16 bytes wide.
+				for(; i + 4 < count; i += 4)
+				{
+					simd::float4 x, y, z;
+					load_strided(in, in_stride, i, x, y, z);
+					splatted.transform<k_projective>(x, y, z);
+
+					// transpose back, and only write the 12 bytes of each point.
+					simd::float4 w = simd::zero();
+					simd::transpose(x, y, z, w);
+					alignas(simd::k_float4_alignment) float points[4][4];
+					simd::store(points[0], x);
+					simd::store(points[1], y);
+					simd::store(points[2], z);
+					simd::store(points[3], w);
+					for(size_t j = 0; j < 4; j++)
+					{
+						float * const p = point_at(out, out_stride, i+j);
+						p[0] = points[j][0];
+						p[1] = points[j][1];
+						p[2] = points[j][2];
+					}
+				}
+
+				for(; i < count; i++)
+				{
+					float const * const p = point_at(in, in_stride, i);
+					fvec3_t const r = transform_point<k_projective>(m, p[0], p[1], p[2]);
+					float * const o = point_at(out, out_stride, i);
+					o[0] = r.x;
+					o[1] = r.y;
+					o[2] = r.z;
+				}
+			}
+
+			template<class L>
+			/** Accumulates a bounding box in registers. */
+			struct Bounds
+			{
+				typename L::type min_x, min_y, min_z;
+				typename L::type max_x, max_y, max_z;
+
+				Bounds():
+					min_x(L::splat(std::numeric_limits<float>::infinity())),
+					min_y(min_x),
+					min_z(min_x),
+					max_x(L::splat(-std::numeric_limits<float>::infinity())),
+					max_y(max_x),
+					max_z(max_x)
+				{
+				}
+
+				REIL void add(
+					typename L::type x,
+					typename L::type y,
+					typename L::type z)
+				{
+					min_x = L::min(min_x, x);
+					min_y = L::min(min_y, y);
+					min_z = L::min(min_z, z);
+					max_x = L::max(max_x, x);
+					max_y = L::max(max_y, y);
+					max_z = L::max(max_z, z);
+				}
+
+				/** Reduces the lanes into a box. */
+				faabb_t reduce() const
+				{
+					float lanes[6][L::k_width];
+					L::store(lanes[0], min_x);
+					L::store(lanes[1], min_y);
+					L::store(lanes[2], min_z);
+					L::store(lanes[3], max_x);
+					L::store(lanes[4], max_y);
+					L::store(lanes[5], max_z);
+
+					fvec3_t min(lanes[0][0], lanes[1][0], lanes[2][0]);
+					fvec3_t max(lanes[3][0], lanes[4][0], lanes[5][0]);
+					for(size_t i = 1; i < L::k_width; i++)
+					{
+						min = fvec3_t(math::min(min.x, lanes[0][i]), math::min(min.y, lanes[1][i]), math::min(min.z, lanes[2][i]));
+						max = fvec3_t(math::max(max.x, lanes[3][i]), math::max(max.y, lanes[4][i]), math::max(max.z, lanes[5][i]));
+					}
+					return faabb_t(min, max);
+				}
+			};
+		}
+
+		void transform_points(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count,
+			float * out_x,
+			float * out_y,
+			float * out_z)
+		{
+			transform_soa<simd::WideLanes, false>(m, x, y, z, count, out_x, out_y, out_z);
+		}
+
+		void transform_points_projective(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count,
+			float * out_x,
+			float * out_y,
+			float * out_z)
+		{
+			transform_soa<simd::WideLanes, true>(m, x, y, z, count, out_x, out_y, out_z);
+		}
+
+		void transform_points(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count,
+			fvec3_t * out,
+			size_t out_stride)
+		{
+			transform_strided<false>(m, in, in_stride, count, out, out_stride);
+		}
+
+		void transform_points_projective(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count,
+			fvec3_t * out,
+			size_t out_stride)
+		{
+			transform_strided<true>(m, in, in_stride, count, out, out_stride);
+		}
+
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count)
+		{
+			RE_DBG_ASSERT(!count || (x && y && z));
+
+			if(!count)
+				return faabb_t(empty);
+
+			typedef simd::WideLanes L;
+			Splatted<L> const splatted(m);
+			Bounds<L> bounds;
+
+			size_t i = 0;
+			for(; i + L::k_width <= count; i += L::k_width)
+			{
+				L::type px = L::load(x + i);
+				L::type py = L::load(y + i);
+				L::type pz = L::load(z + i);
+				splatted.transform<false>(px, py, pz);
+				bounds.add(px, py, pz);
+			}
+
+			faabb_t box = i ? bounds.reduce() : faabb_t(empty);
+			for(; i < count; i++)
+				box |= transform_point<false>(m, x[i], y[i], z[i]);
+
+			return box;
+		}
+
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count)
+		{
+			RE_DBG_ASSERT(!count || in);
+			RE_DBG_ASSERT(in_stride >= sizeof(fvec3_t));
+
+			if(!count)
+				return faabb_t(empty);
+
+			Splatted<simd::Lanes4> const splatted(m);
+			Bounds<simd::Lanes4> bounds;
+
+			size_t i = 0;
+			// the last point is not loaded 16 bytes wide.
+			for(; i + 4 < count; i += 4)
+			{
+				simd::float4 x, y, z;
+				load_strided(in, in_stride, i, x, y, z);
+				splatted.transform<false>(x, y, z);
+				bounds.add(x, y, z);
+			}
+
+			faabb_t box = i ? bounds.reduce() : faabb_t(empty);
+			for(; i < count; i++)
+			{
+				float const * const p = point_at(in, in_stride, i);
+				box |= transform_point<false>(m, p[0], p[1], p[2]);
+			}
+
+			return box;
+		}
+
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			faabb_t const& box)
+		{
+			if(box.empty())
+				return box;
+
+			// sums up the smaller and larger contribution of each axis.
+			simd::float4 lo = simd::set(m.v3.x, m.v3.y, m.v3.z, 0.0f);
+			simd::float4 hi = lo;
+			fvec4_t const * const columns[3] = { &m.v0, &m.v1, &m.v2 };
+			float const min[3] = { box.min().x, box.min().y, box.min().z };
+			float const max[3] = { box.max().x, box.max().y, box.max().z };
+			for(size_t axis = 0; axis < 3; axis++)
+			{
+				simd::float4 const column = simd::load(&columns[axis]->x);
+				simd::float4 const a = simd::mul(column, simd::splat(min[axis]));
+				simd::float4 const b = simd::mul(column, simd::splat(max[axis]));
+				lo = simd::add(lo, simd::min(a, b));
+				hi = simd::add(hi, simd::max(a, b));
+			}
+
+			alignas(simd::k_float4_alignment) float bounds[2][4];
+			simd::store(bounds[0], lo);
+			simd::store(bounds[1], hi);
+			return faabb_t(
+				fvec3_t(bounds[0][0], bounds[0][1], bounds[0][2]),
+				fvec3_t(bounds[1][0], bounds[1][1], bounds[1][2]));
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#ifndef __re_math_pointtransform_hpp_defined
+#define __re_math_pointtransform_hpp_defined
+
+#include "Matrix.hpp"
+#include "AxisAlignedBoundingBox.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		/* Batched kernels that transform many points by one matrix.
+		The points are either given as structure of arrays (one array per coordinate), or strided, as positions embedded in an array of larger structures, such as vertices. Structure of arrays is processed 4 points per instruction, or 8 if AVX is enabled. Strided points are processed 4 at a time, as they are transposed in registers.
+		All output may be written to the input, but must not partially overlap it. */
+
+		/** Transforms points by an affine matrix, whose last row is assumed to be `(0, 0, 0, 1)`.
+		@param[in] m:
+			The affine matrix.
+		@param[in] x, y, z:
+			The coordinates of the points, `count` each.
+		@param[in] count:
+			How many points to transform.
+		@param[out] out_x, out_y, out_z:
+			Receive the transformed coordinates, `count` each. */
+		void transform_points(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count,
+			float * out_x,
+			float * out_y,
+			float * out_z);
+
+		/** Transforms points by a projective matrix, and divides the results by their w coordinate.
+		@param[in] m:
+			The projective matrix.
+		@param[in] x, y, z:
+			The coordinates of the points, `count` each.
+		@param[in] count:
+			How many points to transform.
+		@param[out] out_x, out_y, out_z:
+			Receive the transformed coordinates, `count` each. */
+		void transform_points_projective(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count,
+			float * out_x,
+			float * out_y,
+			float * out_z);
+
+		/** Transforms strided points by an affine matrix, whose last row is assumed to be `(0, 0, 0, 1)`. Only the points are written, the bytes between them are left untouched.
+		@param[in] m:
+			The affine matrix.
+		@param[in] in:
+			The first point.
+		@param[in] in_stride:
+			The byte distance between two input points, at least `sizeof(fvec3_t)`.
+		@param[in] count:
+			How many points to transform.
+		@param[out] out:
+			Receives the first transformed point.
+		@param[in] out_stride:
+			The byte distance between two output points, at least `sizeof(fvec3_t)`. */
+		void transform_points(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count,
+			fvec3_t * out,
+			size_t out_stride);
+
+		/** Transforms strided points by a projective matrix, and divides the results by their w coordinate. Only the points are written, the bytes between them are left untouched.
+		@param[in] m:
+			The projective matrix.
+		@param[in] in:
+			The first point.
+		@param[in] in_stride:
+			The byte distance between two input points, at least `sizeof(fvec3_t)`.
+		@param[in] count:
+			How many points to transform.
+		@param[out] out:
+			Receives the first transformed point.
+		@param[in] out_stride:
+			The byte distance between two output points, at least `sizeof(fvec3_t)`. */
+		void transform_points_projective(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count,
+			fvec3_t * out,
+			size_t out_stride);
+
+		/** Computes the bounding box of points transformed by an affine matrix, without storing the transformed points.
+		@param[in] m:
+			The affine matrix.
+		@param[in] x, y, z:
+			The coordinates of the points, `count` each.
+		@param[in] count:
+			How many points there are.
+		@return
+			The bounding box of the transformed points, or an empty box if `count` is 0. */
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			float const * x,
+			float const * y,
+			float const * z,
+			size_t count);
+
+		/** Computes the bounding box of strided points transformed by an affine matrix, without storing the transformed points.
+		@param[in] m:
+			The affine matrix.
+		@param[in] in:
+			The first point.
+		@param[in] in_stride:
+			The byte distance between two points, at least `sizeof(fvec3_t)`.
+		@param[in] count:
+			How many points there are.
+		@return
+			The bounding box of the transformed points, or an empty box if `count` is 0. */
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			fvec3_t const * in,
+			size_t in_stride,
+			size_t count);
+
+		/** Computes the bounding box of a bounding box transformed by an affine matrix. This is exact for the corners of the box, but only needs the box, not the points it was built from.
+		@param[in] m:
+			The affine matrix.
+		@param[in] box:
+			The box to transform.
+		@return
+			The bounding box of the transformed box, which is empty if `box` is empty. */
+		faabb_t transformed_aabb(
+			fmat4x4_t const& m,
+			faabb_t const& box);
+	}
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef __re_math_quaternion_hpp_defined
+#define __re_math_quaternion_hpp_defined
+
+#include "Vector.hpp"
+#include "Angle.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		template<class T>
+		/** A quaternion `w + xi + yj + zk`.
+			Unit quaternions represent rotations. Unlike Euler angles, they compose without gimbal lock, interpolate smoothly, and convert to a matrix without trigonometry. */
+		struct Quat
+		{
+			/** Creates the identity rotation. */
+			RECX Quat();
+			/** Creates a quaternion with the given elements. */
+			RECX Quat(copy_arg_t<T> x, copy_arg_t<T> y, copy_arg_t<T> z, copy_arg_t<T> w);
+			/** Creates a quaternion with the given vector and scalar part. */
+			RECX Quat(Vec3<T> const& xyz, copy_arg_t<T> w);
+
+			/** Creates the rotation around an axis.
+			@param[in] axis:
+				The normalised axis to rotate around.
+			@param[in] angle:
+				The counter-clockwise angle to rotate by. */
+			static Quat<T> axis_angle(Vec3<T> const& axis, Angle const& angle);
+			/** Creates the rotation that Mat4x4::rotation() creates from the same Euler angles, that is, rotating around the z axis by `rotation.x`, then around the y axis by `rotation.y`, then around the x axis by `rotation.z`. */
+			static Quat<T> euler(Vec3<Angle> const& rotation);
+
+			/** Returns the vector part. */
+			RECX Vec3<T> xyz() const;
+
+			/** The vector part. */
+			T x, y, z;
+			/** The scalar part. */
+			T w;
+		};
+
+		typedef Quat<float> fquat_t;
+		typedef Quat<double> dquat_t;
+
+		template<class T> bool operator==(Quat<T> const& a, Quat<T> const& b);
+		template<class T> bool operator!=(Quat<T> const& a, Quat<T> const& b);
+		template<class T> Quat<T> operator+(Quat<T> const& a, Quat<T> const& b);
+		template<class T> Quat<T> operator-(Quat<T> const& a, Quat<T> const& b);
+		template<class T> Quat<T> operator-(Quat<T> const& a);
+		template<class T> Quat<T> operator*(Quat<T> const& a, copy_arg_t<T> b);
+		template<class T> Quat<T> operator*(copy_arg_t<T> a, Quat<T> const& b);
+		/** Composes two rotations: `a * b` rotates by `b` first, then by `a`. */
+		template<class T> Quat<T> operator*(Quat<T> const& a, Quat<T> const& b);
+		/** Rotates a vector by a unit quaternion. */
+		template<class T> Vec3<T> operator*(Quat<T> const& q, Vec3<T> const& v);
+
+		template<class T> T dot(Quat<T> const& a, Quat<T> const& b);
+		template<class T> T abs(Quat<T> const& q);
+		template<class T> Quat<T> norm(Quat<T> const& q);
+		/** Negates the vector part. For unit quaternions, this is the inverse rotation. */
+		template<class T> Quat<T> conjugate(Quat<T> const& q);
+		/** Inverts any non-zero quaternion. */
+		template<class T> Quat<T> inverse(Quat<T> const& q);
+
+		template<class T>
+		/** Interpolates linearly and normalises the result, along the shorter arc. This is cheaper than slerp(), but does not move at constant angular velocity.
+		@param[in] a:
+			The unit rotation at `t = 0`.
+		@param[in] b:
+			The unit rotation at `t = 1`.
+		@param[in] t:
+			The interpolation factor. */
+		Quat<T> nlerp(Quat<T> const& a, Quat<T> const& b, copy_arg_t<T> t);
+		template<class T>
+		/** Interpolates spherically, at constant angular velocity along the shorter arc.
+		@param[in] a:
+			The unit rotation at `t = 0`.
+		@param[in] b:
+			The unit rotation at `t = 1`.
+		@param[in] t:
+			The interpolation factor. */
+		Quat<T> slerp(Quat<T> const& a, Quat<T> const& b, copy_arg_t<T> t);
+
+		template<class T>
+		/** Converts a unit quaternion back to the Euler angles that Quat::euler() and Mat4x4::rotation() take. At the poles, where the Euler angles are ambiguous, `rotation.x` is 0. */
+		Vec3<Angle> euler(Quat<T> const& q);
+	}
+}
+
+#include "Quaternion.inl"
+
+#endif
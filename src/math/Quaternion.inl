@@ -0,0 +1,225 @@
+#include <cmath>
+
+namespace re
+{
+	namespace math
+	{
+		template<class T>
+		RECX Quat<T>::Quat():
+			x(0),
+			y(0),
+			z(0),
+			w(1)
+		{
+		}
+
+		template<class T>
+		RECX Quat<T>::Quat(
+			copy_arg_t<T> x,
+			copy_arg_t<T> y,
+			copy_arg_t<T> z,
+			copy_arg_t<T> w):
+			x(x),
+			y(y),
+			z(z),
+			w(w)
+		{
+		}
+
+		template<class T>
+		RECX Quat<T>::Quat(
+			Vec3<T> const& xyz,
+			copy_arg_t<T> w):
+			x(xyz.x),
+			y(xyz.y),
+			z(xyz.z),
+			w(w)
+		{
+		}
+
+		template<class T>
+		Quat<T> Quat<T>::axis_angle(
+			Vec3<T> const& axis,
+			Angle const& angle)
+		{
+			T const half = T(angle.rad()) * T(0.5);
+			T const s = std::sin(half);
+			return Quat<T>(axis.x * s, axis.y * s, axis.z * s, std::cos(half));
+		}
+
+		template<class T>
+		Quat<T> Quat<T>::euler(
+			Vec3<Angle> const& rotation)
+		{
+			T const hz = T(rotation.x.rad()) * T(0.5);
+			T const hy = T(rotation.y.rad()) * T(0.5);
+			T const hx = T(rotation.z.rad()) * T(0.5);
+			T const cz = std::cos(hz), sz = std::sin(hz);
+			T const cy = std::cos(hy), sy = std::sin(hy);
+			T const cx = std::cos(hx), sx = std::sin(hx);
+
+			// expanded from qx * qy * qz.
+			return Quat<T>(
+				sx * cy * cz + cx * sy * sz,
+				cx * sy * cz - sx * cy * sz,
+				cx * cy * sz + sx * sy * cz,
+				cx * cy * cz - sx * sy * sz);
+		}
+
+		template<class T>
+		RECX Vec3<T> Quat<T>::xyz() const
+		{
+			return Vec3<T>(x, y, z);
+		}
+
+		template<class T>
+		bool operator==(Quat<T> const& a, Quat<T> const& b)
+		{
+			return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+		}
+
+		template<class T>
+		bool operator!=(Quat<T> const& a, Quat<T> const& b)
+		{
+			return !(a == b);
+		}
+
+		template<class T>
+		Quat<T> operator+(Quat<T> const& a, Quat<T> const& b)
+		{
+			return Quat<T>(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+		}
+
+		template<class T>
+		Quat<T> operator-(Quat<T> const& a, Quat<T> const& b)
+		{
+			return Quat<T>(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+		}
+
+		template<class T>
+		Quat<T> operator-(Quat<T> const& a)
+		{
+			return Quat<T>(-a.x, -a.y, -a.z, -a.w);
+		}
+
+		template<class T>
+		Quat<T> operator*(Quat<T> const& a, copy_arg_t<T> b)
+		{
+			return Quat<T>(a.x * b, a.y * b, a.z * b, a.w * b);
+		}
+
+		template<class T>
+		Quat<T> operator*(copy_arg_t<T> a, Quat<T> const& b)
+		{
+			return b * a;
+		}
+
+		template<class T>
+		Quat<T> operator*(Quat<T> const& a, Quat<T> const& b)
+		{
+			return Quat<T>(
+				a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+				a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+				a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+				a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+		}
+
+		template<class T>
+		Vec3<T> operator*(Quat<T> const& q, Vec3<T> const& v)
+		{
+			// v + 2w(u x v) + 2u x (u x v), with two cross products instead of two quaternion products.
+			Vec3<T> const u = q.xyz();
+			Vec3<T> const t = cross(u, v) * T(2);
+			return v + t * q.w + cross(u, t);
+		}
+
+		template<class T>
+		T dot(Quat<T> const& a, Quat<T> const& b)
+		{
+			return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		}
+
+		template<class T>
+		T abs(Quat<T> const& q)
+		{
+			return std::sqrt(dot(q, q));
+		}
+
+		template<class T>
+		Quat<T> norm(Quat<T> const& q)
+		{
+			return q * (T(1) / abs(q));
+		}
+
+		template<class T>
+		Quat<T> conjugate(Quat<T> const& q)
+		{
+			return Quat<T>(-q.x, -q.y, -q.z, q.w);
+		}
+
+		template<class T>
+		Quat<T> inverse(Quat<T> const& q)
+		{
+			return conjugate(q) * (T(1) / dot(q, q));
+		}
+
+		template<class T>
+		Quat<T> nlerp(
+			Quat<T> const& a,
+			Quat<T> const& b,
+			copy_arg_t<T> t)
+		{
+			// q and -q are the same rotation, so the closer one is taken.
+			T const u = dot(a, b) < T(0) ? -t : t;
+			return norm(a * (T(1) - t) + b * u);
+		}
+
+		template<class T>
+		Quat<T> slerp(
+			Quat<T> const& a,
+			Quat<T> const& b,
+			copy_arg_t<T> t)
+		{
+			T cos_angle = dot(a, b);
+			T sign = T(1);
+			if(cos_angle < T(0))
+			{
+				cos_angle = -cos_angle;
+				sign = T(-1);
+			}
+
+			// for close rotations, the sine is too imprecise, but lerping is exact enough.
+			if(cos_angle > T(0.9995))
+				return nlerp(a, b, t);
+
+			T const angle = std::acos(cos_angle);
+			T const inv_sin = T(1) / std::sin(angle);
+			return a * (std::sin((T(1) - t) * angle) * inv_sin)
+				+ b * (sign * std::sin(t * angle) * inv_sin);
+		}
+
+		template<class T>
+		Vec3<Angle> euler(Quat<T> const& q)
+		{
+			// the needed elements of the rotation matrix rx * ry * rz, as (row, column).
+			T const m00 = T(1) - T(2) * (q.y * q.y + q.z * q.z);
+			T const m01 = T(2) * (q.x * q.y - q.z * q.w);
+			T const m02 = T(2) * (q.x * q.z + q.y * q.w);
+			T const m10 = T(2) * (q.x * q.y + q.z * q.w);
+			T const m11 = T(1) - T(2) * (q.x * q.x + q.z * q.z);
+			T const m20 = T(2) * (q.x * q.z - q.y * q.w);
+			T const m21 = T(2) * (q.y * q.z + q.x * q.w);
+
+			// near the poles, m00 and m01 vanish and only determine the z rotation imprecisely, so the x rotation is computed from the larger elements and the z rotation, keeping the combined rotation exact. At the poles, the z rotation is 0.
+			T const z = std::atan2(-m01, m00);
+			T const sin_z = std::sin(z), cos_z = std::cos(z);
+			T const y = std::atan2(m02, std::sqrt(m00 * m00 + m01 * m01));
+			T const x = std::atan2(m20 * sin_z + m21 * cos_z, m10 * sin_z + m11 * cos_z);
+
+			return Vec3<Angle>(
+				rad(float(z)),
+				rad(float(y)),
+				rad(float(x)));
+		}
+	}
+}
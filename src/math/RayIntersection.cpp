@@ -0,0 +1,270 @@
+#include "RayIntersection.hpp"
+#include "../LogFile.hpp"
+
+namespace re
+{
+	namespace math
+	{
+		namespace
+		{
+			template<class L>
+			/** The nearest hits found so far, per lane. */
+			struct NearestLanes
+			{
+				typename L::type distance, u, v, triangle;
+			};
+
+			template<class L>
+			/** Intersects one ray with the triangles starting at `i`, and keeps the nearer hits.
+			@param[in] ray:
+				The origin and direction coordinates of the ray, splatted.
+			@param[in] triangles:
+				The triangles.
+			@param[in] i:
+				The first triangle to test.
+			@param[in] index:
+				The indices of the tested triangles.
+			@param[in,out] nearest:
+				The nearest hits so far. */
+			REIL void intersect_lanes(
+				typename L::type const (&ray)[6],
+				TriangleArrays const& triangles,
+				size_t i,
+				typename L::type index,
+				NearestLanes<L> &nearest)
+			{
+				typedef typename L::type lanes_t;
+				lanes_t const &ox = ray[0], &oy = ray[1], &oz = ray[2];
+				lanes_t const &dx = ray[3], &dy = ray[4], &dz = ray[5];
+				lanes_t const zero = L::splat(0.0f);
+
+				lanes_t const e1x = L::load(triangles.edge1_x + i);
+				lanes_t const e1y = L::load(triangles.edge1_y + i);
+				lanes_t const e1z = L::load(triangles.edge1_z + i);
+				lanes_t const e2x = L::load(triangles.edge2_x + i);
+				lanes_t const e2y = L::load(triangles.edge2_y + i);
+				lanes_t const e2z = L::load(triangles.edge2_z + i);
+
+				// p = direction x edge2.
+				lanes_t const px = L::sub(L::mul(dy, e2z), L::mul(dz, e2y));
+				lanes_t const py = L::sub(L::mul(dz, e2x), L::mul(dx, e2z));
+				lanes_t const pz = L::sub(L::mul(dx, e2y), L::mul(dy, e2x));
+				lanes_t const determinant = L::madd(e1x, px, L::madd(e1y, py, L::mul(e1z, pz)));
+				lanes_t const inverse_determinant = L::div(L::splat(1.0f), determinant);
+
+				lanes_t const sx = L::sub(ox, L::load(triangles.x + i));
+				lanes_t const sy = L::sub(oy, L::load(triangles.y + i));
+				lanes_t const sz = L::sub(oz, L::load(triangles.z + i));
+				lanes_t const u = L::mul(L::madd(sx, px, L::madd(sy, py, L::mul(sz, pz))), inverse_determinant);
+
+				// q = s x edge1.
+				lanes_t const qx = L::sub(L::mul(sy, e1z), L::mul(sz, e1y));
+				lanes_t const qy = L::sub(L::mul(sz, e1x), L::mul(sx, e1z));
+				lanes_t const qz = L::sub(L::mul(sx, e1y), L::mul(sy, e1x));
+				lanes_t const v = L::mul(L::madd(dx, qx, L::madd(dy, qy, L::mul(dz, qz))), inverse_determinant);
+				lanes_t const t = L::mul(L::madd(e2x, qx, L::madd(e2y, qy, L::mul(e2z, qz))), inverse_determinant);
+
+				// degenerate triangles and parallel rays.
+				lanes_t const valid = L::less(L::splat(std::numeric_limits<float>::min()), L::max(determinant, L::sub(zero, determinant)));
+				lanes_t const miss = L::bit_or(
+					L::bit_or(L::less(u, zero), L::less(v, zero)),
+					L::bit_or(L::less(L::splat(1.0f), L::add(u, v)), L::less(t, zero)));
+				lanes_t const hit = L::select(miss, zero, L::select(valid, L::less(t, nearest.distance), zero));
+
+				nearest.distance = L::select(hit, t, nearest.distance);
+				nearest.u = L::select(hit, u, nearest.u);
+				nearest.v = L::select(hit, v, nearest.v);
+				nearest.triangle = L::select(hit, index, nearest.triangle);
+			}
+
+			template<class L>
+			bool intersect_nearest_lanes(
+				Ray<float> const& ray,
+				TriangleArrays const& triangles,
+				size_t count,
+				TriangleHit &hit,
+				float max_distance)
+			{
+				typedef typename L::type lanes_t;
+				RE_DBG_ASSERT(!count || (
+					triangles.x && triangles.y && triangles.z
+					&& triangles.edge1_x && triangles.edge1_y && triangles.edge1_z
+					&& triangles.edge2_x && triangles.edge2_y && triangles.edge2_z));
+				// the indices are tracked in float lanes.
+				RE_DBG_ASSERT(count < (size_t(1) << 24));
+
+				lanes_t const splatted[6] = {
+					L::splat(ray.position.x), L::splat(ray.position.y), L::splat(ray.position.z),
+					L::splat(ray.direction.x), L::splat(ray.direction.y), L::splat(ray.direction.z)
+				};
+
+				NearestLanes<L> nearest;
+				nearest.distance = L::splat(max_distance);
+				nearest.u = L::splat(0.0f);
+				nearest.v = nearest.u;
+				nearest.triangle = L::splat(-1.0f);
+
+				float first_index[L::k_width];
+				for(size_t j = 0; j < L::k_width; j++)
+					first_index[j] = float(j);
+				lanes_t index = L::load(first_index);
+				lanes_t const step = L::splat(float(L::k_width));
+
+				size_t i = 0;
+				for(; i + L::k_width <= count; i += L::k_width, index = L::add(index, step))
+					intersect_lanes<L>(splatted, triangles, i, index, nearest);
+
+				if(i < count)
+				{
+					// the remainder is padded with degenerate triangles, which are never hit.
+					float padded[9][L::k_width] = {};
+					float const * const arrays[9] = {
+						triangles.x, triangles.y, triangles.z,
+						triangles.edge1_x, triangles.edge1_y, triangles.edge1_z,
+						triangles.edge2_x, triangles.edge2_y, triangles.edge2_z
+					};
+					for(size_t a = 0; a < 9; a++)
+						for(size_t j = i; j < count; j++)
+							padded[a][j-i] = arrays[a][j];
+
+					TriangleArrays const remainder = {
+						padded[0], padded[1], padded[2],
+						padded[3], padded[4], padded[5],
+						padded[6], padded[7], padded[8]
+					};
+					intersect_lanes<L>(splatted, remainder, 0, index, nearest);
+				}
+
+				float lanes[4][L::k_width];
+				L::store(lanes[0], nearest.distance);
+				L::store(lanes[1], nearest.u);
+				L::store(lanes[2], nearest.v);
+				L::store(lanes[3], nearest.triangle);
+
+				bool found = false;
+				for(size_t j = 0; j < L::k_width; j++)
+					if(lanes[3][j] >= 0.0f && (!found || lanes[0][j] < hit.distance))
+					{
+						found = true;
+						hit.triangle = size_t(lanes[3][j]);
+						hit.distance = lanes[0][j];
+						hit.u = lanes[1][j];
+						hit.v = lanes[2][j];
+					}
+
+				return found;
+			}
+
+			template<class L>
+			/** Intersects the rays starting at `i` with a box, and returns the mask of the rays that hit it. */
+			REIL int intersect_box_lanes(
+				RayArrays const& rays,
+				size_t i,
+				typename L::type const (&box)[6],
+				typename L::type max_distance,
+				float * distance)
+			{
+				typedef typename L::type lanes_t;
+				lanes_t const ox = L::load(rays.x + i);
+				lanes_t const oy = L::load(rays.y + i);
+				lanes_t const oz = L::load(rays.z + i);
+				lanes_t const ix = L::load(rays.inverse_direction_x + i);
+				lanes_t const iy = L::load(rays.inverse_direction_y + i);
+				lanes_t const iz = L::load(rays.inverse_direction_z + i);
+
+				lanes_t const x1 = L::mul(L::sub(box[0], ox), ix), x2 = L::mul(L::sub(box[3], ox), ix);
+				lanes_t const y1 = L::mul(L::sub(box[1], oy), iy), y2 = L::mul(L::sub(box[4], oy), iy);
+				lanes_t const z1 = L::mul(L::sub(box[2], oz), iz), z2 = L::mul(L::sub(box[5], oz), iz);
+
+				// where the ray is inside all slabs.
+				lanes_t const zero = L::splat(0.0f);
+				lanes_t const entry = L::max(
+					L::max(L::min(x1, x2), L::min(y1, y2)),
+					L::max(L::min(z1, z2), zero));
+				lanes_t const exit = L::min(
+					L::min(L::max(x1, x2), L::max(y1, y2)),
+					L::min(L::max(z1, z2), max_distance));
+
+				lanes_t const hit = L::select(L::less(exit, entry), zero, L::less(entry, max_distance));
+				L::store(distance, L::select(hit, entry, L::splat(std::numeric_limits<float>::infinity())));
+				return L::mask_bits(hit);
+			}
+
+			REIL size_t bit_count(int bits)
+			{
+				size_t count = 0;
+				for(; bits; bits &= bits - 1)
+					count++;
+				return count;
+			}
+		}
+
+		bool intersect_nearest(
+			Ray<float> const& ray,
+			TriangleArrays const& triangles,
+			size_t count,
+			TriangleHit &hit,
+			float max_distance)
+		{
+			return intersect_nearest_lanes<simd::WideLanes>(ray, triangles, count, hit, max_distance);
+		}
+
+		size_t intersect_box(
+			RayArrays const& rays,
+			size_t count,
+			faabb_t const& box,
+			float * distance,
+			float max_distance)
+		{
+			typedef simd::WideLanes L;
+			RE_DBG_ASSERT(!count || (
+				rays.x && rays.y && rays.z
+				&& rays.inverse_direction_x && rays.inverse_direction_y && rays.inverse_direction_z
+				&& distance));
+
+			if(box.empty())
+			{
+				for(size_t i = 0; i < count; i++)
+					distance[i] = std::numeric_limits<float>::infinity();
+				return 0;
+			}
+
+			L::type const splatted[6] = {
+				L::splat(box.min().x), L::splat(box.min().y), L::splat(box.min().z),
+				L::splat(box.max().x), L::splat(box.max().y), L::splat(box.max().z)
+			};
+			L::type const max = L::splat(max_distance);
+
+			size_t hits = 0;
+			size_t i = 0;
+			for(; i + L::k_width <= count; i += L::k_width)
+				hits += bit_count(intersect_box_lanes<L>(rays, i, splatted, max, distance + i));
+
+			if(i < count)
+			{
+				// the remainder is padded with rays from the origin, whose results are dropped.
+				float padded[6][L::k_width] = {};
+				float const * const arrays[6] = {
+					rays.x, rays.y, rays.z,
+					rays.inverse_direction_x, rays.inverse_direction_y, rays.inverse_direction_z
+				};
+				for(size_t a = 0; a < 6; a++)
+					for(size_t j = i; j < count; j++)
+						padded[a][j-i] = arrays[a][j];
+
+				RayArrays const remainder = {
+					padded[0], padded[1], padded[2],
+					padded[3], padded[4], padded[5]
+				};
+				float remainder_distance[L::k_width];
+				int const mask = intersect_box_lanes<L>(remainder, 0, splatted, max, remainder_distance)
+					& ((1 << (count - i)) - 1);
+				hits += bit_count(mask);
+				for(size_t j = i; j < count; j++)
+					distance[j] = remainder_distance[j-i];
+			}
+
+			return hits;
+		}
+	}
+}
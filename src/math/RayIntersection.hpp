@@ -0,0 +1,88 @@
+#ifndef __re_math_rayintersection_hpp_defined
+#define __re_math_rayintersection_hpp_defined
+
+#include "Intersection.hpp"
+
+#include <limits>
+
+namespace re
+{
+	namespace math
+	{
+		/* Batched intersection kernels, for picking against meshes and for visibility queries on the CPU.
+		One ray is tested against 4 triangles per instruction, or 8 if AVX is enabled, and as many rays against one box. The scalar intersect() overloads are the reference. The remainder of a batch is padded to a full vector, with degenerate triangles, which are never hit, or with rays from the origin, whose results are dropped. */
+
+		/** Triangles, stored as structure of arrays, with one array per coordinate of their first corner and of the two edges from it, as they are used by the Moeller-Trumbore test. */
+		struct TriangleArrays
+		{
+			/** The first corners. */
+			float const * x, * y, * z;
+			/** The second corners, minus the first corners. */
+			float const * edge1_x, * edge1_y, * edge1_z;
+			/** The third corners, minus the first corners. */
+			float const * edge2_x, * edge2_y, * edge2_z;
+		};
+
+		/** Rays, stored as structure of arrays, with the reciprocals of their directions, as they are used by the slab test. */
+		struct RayArrays
+		{
+			/** The origins. */
+			float const * x, * y, * z;
+			/** `1 / direction` per coordinate. Zero coordinates become infinities. */
+			float const * inverse_direction_x, * inverse_direction_y, * inverse_direction_z;
+		};
+
+		/** The nearest intersection of a ray with triangles. */
+		struct TriangleHit
+		{
+			/** The index of the triangle that was hit. */
+			size_t triangle;
+			/** The coordinate of the hit on the ray, relative to its direction vector. */
+			float distance;
+			/** The barycentric coordinates of the hit, which are the weights of the second and third corner. */
+			float u, v;
+		};
+
+		/** Finds the nearest triangle that a ray hits, from either side.
+		@param[in] ray:
+			The ray.
+		@param[in] triangles:
+			The triangles, `count` per array.
+		@param[in] count:
+			How many triangles there are, less than 2^24.
+		@param[out] hit:
+			Receives the nearest hit, if any.
+		@param[in] max_distance:
+			Hits at or beyond this coordinate on the ray are ignored.
+		@return
+			Whether any triangle was hit. */
+		bool intersect_nearest(
+			Ray<float> const& ray,
+			TriangleArrays const& triangles,
+			size_t count,
+			TriangleHit &hit,
+			float max_distance = std::numeric_limits<float>::infinity());
+
+		/** Intersects rays with a box.
+		@param[in] rays:
+			The rays, `count` per array.
+		@param[in] count:
+			How many rays there are.
+		@param[in] box:
+			The box. Empty boxes are never hit.
+		@param[out] distance:
+			Receives, per ray, the coordinate where it enters the box, 0 if it starts inside the box, or infinity if it misses.
+		@param[in] max_distance:
+			Hits at or beyond this coordinate on a ray are ignored.
+		@return
+			How many rays hit the box. */
+		size_t intersect_box(
+			RayArrays const& rays,
+			size_t count,
+			faabb_t const& box,
+			float * distance,
+			float max_distance = std::numeric_limits<float>::infinity());
+	}
+}
+
+#endif
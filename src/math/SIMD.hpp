@@ -0,0 +1,184 @@
+#ifndef __re_math_simd_hpp_defined
+#define __re_math_simd_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+/** Define RE_NO_SIMD to use the scalar fallback even where SIMD instructions are available. */
+#if defined(RE_NO_SIMD)
+	/** Defined when no SIMD instruction set is used. */
+	#define RE_SIMD_SCALAR
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	/** Defined when SSE2 is used. */
+	#define RE_SIMD_SSE
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		/** Defined when SSE4.1 is used. */
+		#define RE_SIMD_SSE41
+	#endif
+	#ifdef __AVX__
+		/** Defined when AVX is used. */
+		#define RE_SIMD_AVX
+	#endif
+	#ifdef __FMA__
+		/** Defined when fused multiply-add is used. */
+		#define RE_SIMD_FMA
+	#endif
+	#if defined(__F16C__) && defined(__AVX__)
+		/** Defined when the half-float conversion instructions are used. */
+		#define RE_SIMD_F16C
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	/** Defined when NEON is used. */
+	#define RE_SIMD_NEON
+#else
+	#define RE_SIMD_SCALAR
+#endif
+
+#if defined(RE_SIMD_AVX) || defined(RE_SIMD_FMA) || defined(RE_SIMD_F16C)
+#include <immintrin.h>
+#elif defined(RE_SIMD_SSE41)
+#include <smmintrin.h>
+#elif defined(RE_SIMD_SSE)
+#include <emmintrin.h>
+#elif defined(RE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace re
+{
+	namespace math
+	{
+		/** A thin abstraction over the SIMD instruction set of the target, so that vectorised code is written once for SSE, NEON and the scalar fallback.
+			The functions map to single instructions where possible. */
+		namespace simd
+		{
+#if defined(RE_SIMD_SSE)
+			/** Four floats in a SIMD register. */
+			typedef __m128 float4;
+#elif defined(RE_SIMD_NEON)
+			typedef float32x4_t float4;
+#else
+			struct float4
+			{
+				float m[4];
+			};
+#endif
+
+			/** The alignment of memory that `load()` and `store()` access. */
+			static size_t const k_float4_alignment = 16;
+
+			/** Loads four floats from memory aligned to k_float4_alignment. */
+			REIL float4 load(float const * mem);
+			/** Loads four floats from memory of any alignment. */
+			REIL float4 loadu(float const * mem);
+			/** Stores four floats to memory aligned to k_float4_alignment. */
+			REIL void store(float * mem, float4 v);
+			/** Stores four floats to memory of any alignment. */
+			REIL void storeu(float * mem, float4 v);
+
+			/** `(x, y, z, w)`. */
+			REIL float4 set(float x, float y, float z, float w);
+			/** `(v, v, v, v)`. */
+			REIL float4 splat(float v);
+			REIL float4 zero();
+
+			template<size_t i>
+			/** Copies the lane `i` to all lanes. */
+			REIL float4 broadcast(float4 v);
+			/** The first lane. */
+			REIL float first(float4 v);
+			template<size_t x, size_t y, size_t z, size_t w>
+			/** `(a[x], a[y], b[z], b[w])`. */
+			REIL float4 shuffle(float4 a, float4 b);
+
+			REIL float4 add(float4 a, float4 b);
+			REIL float4 sub(float4 a, float4 b);
+			REIL float4 mul(float4 a, float4 b);
+			REIL float4 div(float4 a, float4 b);
+			/** `a * b + c`, fused where supported. */
+			REIL float4 madd(float4 a, float4 b, float4 c);
+			REIL float4 min(float4 a, float4 b);
+			REIL float4 max(float4 a, float4 b);
+			REIL float4 sqrt(float4 v);
+			REIL float4 abs(float4 v);
+			/** Rounds to the nearest integer. `|v|` must be below 2^22. */
+			REIL float4 round(float4 v);
+			/** An estimate of `1 / sqrt(v)`, with a relative error below 2^-11. */
+			REIL float4 rsqrt_estimate(float4 v);
+
+			/** `a < b` per lane, as a mask of all bits set or clear. */
+			REIL float4 less(float4 a, float4 b);
+			REIL float4 bit_and(float4 a, float4 b);
+			REIL float4 bit_or(float4 a, float4 b);
+			/** Per lane, `a` where `mask` is set, `b` otherwise. */
+			REIL float4 select(float4 mask, float4 a, float4 b);
+			/** Packs a mask into the lowest 4 bits, the first lane being the lowest bit. */
+			REIL int mask_bits(float4 mask);
+
+			/** The dot product of all four lanes, in all lanes. */
+			REIL float4 dot4(float4 a, float4 b);
+			/** The cross product of the first three lanes. The fourth lane is 0 for finite inputs. */
+			REIL float4 cross3(float4 a, float4 b);
+			/** Transposes the 4x4 matrix whose rows (or columns) are given. */
+			REIL void transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3);
+
+			/** The float4 functions, wrapped for batched kernels that are written once for any lane count. Memory is accessed unaligned. */
+			struct Lanes4
+			{
+				typedef float4 type;
+				static size_t const k_width = 4;
+
+				static REIL type load(float const * mem);
+				static REIL void store(float * mem, type v);
+				static REIL type splat(float v);
+				static REIL type add(type a, type b);
+				static REIL type sub(type a, type b);
+				static REIL type mul(type a, type b);
+				static REIL type div(type a, type b);
+				static REIL type madd(type a, type b, type c);
+				static REIL type min(type a, type b);
+				static REIL type max(type a, type b);
+				static REIL type round(type v);
+				static REIL type less(type a, type b);
+				static REIL type bit_or(type a, type b);
+				static REIL type select(type mask, type a, type b);
+				static REIL int mask_bits(type mask);
+			};
+
+#ifdef RE_SIMD_AVX
+			/** Like Lanes4, but processes 8 lanes at once via AVX. */
+			struct Lanes8
+			{
+				typedef __m256 type;
+				static size_t const k_width = 8;
+
+				static REIL type load(float const * mem);
+				static REIL void store(float * mem, type v);
+				static REIL type splat(float v);
+				static REIL type add(type a, type b);
+				static REIL type sub(type a, type b);
+				static REIL type mul(type a, type b);
+				static REIL type div(type a, type b);
+				static REIL type madd(type a, type b, type c);
+				static REIL type min(type a, type b);
+				static REIL type max(type a, type b);
+				static REIL type round(type v);
+				static REIL type less(type a, type b);
+				static REIL type bit_or(type a, type b);
+				static REIL type select(type mask, type a, type b);
+				static REIL int mask_bits(type mask);
+			};
+
+			/** The widest lanes available. */
+			typedef Lanes8 WideLanes;
+#else
+			/** The widest lanes available. */
+			typedef Lanes4 WideLanes;
+#endif
+		}
+	}
+}
+
+#include "SIMD.inl"
+
+#endif
@@ -0,0 +1,629 @@
+#include <math.h>
+#include <cstring>
+
+namespace re
+{
+	namespace math
+	{
+		namespace simd
+		{
+#if defined(RE_SIMD_SSE)
+
+			float4 load(float const * mem)
+			{
+				return _mm_load_ps(mem);
+			}
+
+			float4 loadu(float const * mem)
+			{
+				return _mm_loadu_ps(mem);
+			}
+
+			void store(float * mem, float4 v)
+			{
+				_mm_store_ps(mem, v);
+			}
+
+			void storeu(float * mem, float4 v)
+			{
+				_mm_storeu_ps(mem, v);
+			}
+
+			float4 set(float x, float y, float z, float w)
+			{
+				return _mm_setr_ps(x, y, z, w);
+			}
+
+			float4 splat(float v)
+			{
+				return _mm_set1_ps(v);
+			}
+
+			float4 zero()
+			{
+				return _mm_setzero_ps();
+			}
+
+			template<size_t i>
+			float4 broadcast(float4 v)
+			{
+				return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+			}
+
+			float first(float4 v)
+			{
+				return _mm_cvtss_f32(v);
+			}
+
+			template<size_t x, size_t y, size_t z, size_t w>
+			float4 shuffle(float4 a, float4 b)
+			{
+				return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+			}
+
+			float4 add(float4 a, float4 b)
+			{
+				return _mm_add_ps(a, b);
+			}
+
+			float4 sub(float4 a, float4 b)
+			{
+				return _mm_sub_ps(a, b);
+			}
+
+			float4 mul(float4 a, float4 b)
+			{
+				return _mm_mul_ps(a, b);
+			}
+
+			float4 div(float4 a, float4 b)
+			{
+				return _mm_div_ps(a, b);
+			}
+
+			float4 madd(float4 a, float4 b, float4 c)
+			{
+#ifdef RE_SIMD_FMA
+				return _mm_fmadd_ps(a, b, c);
+#else
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+			}
+
+			float4 min(float4 a, float4 b)
+			{
+				return _mm_min_ps(a, b);
+			}
+
+			float4 max(float4 a, float4 b)
+			{
+				return _mm_max_ps(a, b);
+			}
+
+			float4 sqrt(float4 v)
+			{
+				return _mm_sqrt_ps(v);
+			}
+
+			float4 abs(float4 v)
+			{
+				return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+			}
+
+			float4 round(float4 v)
+			{
+#ifdef RE_SIMD_SSE41
+				return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+				return _mm_cvtepi32_ps(_mm_cvtps_epi32(v));
+#endif
+			}
+
+			float4 rsqrt_estimate(float4 v)
+			{
+				return _mm_rsqrt_ps(v);
+			}
+
+			float4 less(float4 a, float4 b)
+			{
+				return _mm_cmplt_ps(a, b);
+			}
+
+			float4 bit_and(float4 a, float4 b)
+			{
+				return _mm_and_ps(a, b);
+			}
+
+			float4 bit_or(float4 a, float4 b)
+			{
+				return _mm_or_ps(a, b);
+			}
+
+			float4 select(float4 mask, float4 a, float4 b)
+			{
+#ifdef RE_SIMD_SSE41
+				return _mm_blendv_ps(b, a, mask);
+#else
+				return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#endif
+			}
+
+			int mask_bits(float4 mask)
+			{
+				return _mm_movemask_ps(mask);
+			}
+
+			float4 dot4(float4 a, float4 b)
+			{
+				// _mm_dp_ps is slower than two shuffles on most CPUs.
+				float4 const m = _mm_mul_ps(a, b);
+				float4 const s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+				return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+			}
+
+			float4 cross3(float4 a, float4 b)
+			{
+				float4 const a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+				float4 const b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+				// a.yzx * b.zxy - a.zxy * b.yzx, with one shuffle less.
+				float4 const c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+				return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+			}
+
+			void transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+			{
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			}
+
+#elif defined(RE_SIMD_NEON)
+
+			float4 load(float const * mem)
+			{
+				return vld1q_f32(mem);
+			}
+
+			float4 loadu(float const * mem)
+			{
+				return vld1q_f32(mem);
+			}
+
+			void store(float * mem, float4 v)
+			{
+				vst1q_f32(mem, v);
+			}
+
+			void storeu(float * mem, float4 v)
+			{
+				vst1q_f32(mem, v);
+			}
+
+			float4 set(float x, float y, float z, float w)
+			{
+				float const v[4] = { x, y, z, w };
+				return vld1q_f32(v);
+			}
+
+			float4 splat(float v)
+			{
+				return vdupq_n_f32(v);
+			}
+
+			float4 zero()
+			{
+				return vdupq_n_f32(0.0f);
+			}
+
+			template<size_t i>
+			float4 broadcast(float4 v)
+			{
+#ifdef __aarch64__
+				return vdupq_laneq_f32(v, i);
+#else
+				return vdupq_n_f32(vgetq_lane_f32(v, i));
+#endif
+			}
+
+			float first(float4 v)
+			{
+				return vgetq_lane_f32(v, 0);
+			}
+
+			template<size_t x, size_t y, size_t z, size_t w>
+			float4 shuffle(float4 a, float4 b)
+			{
+#ifdef __clang__
+				return __builtin_shufflevector(a, b, x, y, z+4, w+4);
+#else
+				return set(vgetq_lane_f32(a, x), vgetq_lane_f32(a, y), vgetq_lane_f32(b, z), vgetq_lane_f32(b, w));
+#endif
+			}
+
+			float4 add(float4 a, float4 b)
+			{
+				return vaddq_f32(a, b);
+			}
+
+			float4 sub(float4 a, float4 b)
+			{
+				return vsubq_f32(a, b);
+			}
+
+			float4 mul(float4 a, float4 b)
+			{
+				return vmulq_f32(a, b);
+			}
+
+			float4 div(float4 a, float4 b)
+			{
+#ifdef __aarch64__
+				return vdivq_f32(a, b);
+#else
+				// two Newton-Raphson steps on the reciprocal estimate.
+				float4 r = vrecpeq_f32(b);
+				r = vmulq_f32(vrecpsq_f32(b, r), r);
+				r = vmulq_f32(vrecpsq_f32(b, r), r);
+				return vmulq_f32(a, r);
+#endif
+			}
+
+			float4 madd(float4 a, float4 b, float4 c)
+			{
+#ifdef __aarch64__
+				return vfmaq_f32(c, a, b);
+#else
+				return vmlaq_f32(c, a, b);
+#endif
+			}
+
+			float4 min(float4 a, float4 b)
+			{
+				return vminq_f32(a, b);
+			}
+
+			float4 max(float4 a, float4 b)
+			{
+				return vmaxq_f32(a, b);
+			}
+
+			float4 sqrt(float4 v)
+			{
+#ifdef __aarch64__
+				return vsqrtq_f32(v);
+#else
+				// v * rsqrt(v), with two Newton-Raphson steps, and 0 kept as 0.
+				float4 r = vrsqrteq_f32(v);
+				r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+				r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+				return vbslq_f32(vceqq_f32(v, vdupq_n_f32(0.0f)), v, vmulq_f32(v, r));
+#endif
+			}
+
+			float4 abs(float4 v)
+			{
+				return vabsq_f32(v);
+			}
+
+			float4 round(float4 v)
+			{
+#ifdef __aarch64__
+				return vrndnq_f32(v);
+#else
+				// adding 1.5 * 2^23 pushes the fraction out of the mantissa.
+				float4 const magic = vdupq_n_f32(12582912.0f);
+				return vsubq_f32(vaddq_f32(v, magic), magic);
+#endif
+			}
+
+			float4 rsqrt_estimate(float4 v)
+			{
+				// the estimate has only 8 bits, so one Newton-Raphson step is added.
+				float4 const r = vrsqrteq_f32(v);
+				return vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+			}
+
+			float4 less(float4 a, float4 b)
+			{
+				return vreinterpretq_f32_u32(vcltq_f32(a, b));
+			}
+
+			float4 bit_and(float4 a, float4 b)
+			{
+				return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+			}
+
+			float4 bit_or(float4 a, float4 b)
+			{
+				return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+			}
+
+			float4 select(float4 mask, float4 a, float4 b)
+			{
+				return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+			}
+
+			int mask_bits(float4 mask)
+			{
+				static uint32_t const k_bits[4] = { 1, 2, 4, 8 };
+				uint32x4_t const bits = vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(k_bits));
+#ifdef __aarch64__
+				return int(vaddvq_u32(bits));
+#else
+				uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+				sum = vpadd_u32(sum, sum);
+				return int(vget_lane_u32(sum, 0));
+#endif
+			}
+
+			float4 dot4(float4 a, float4 b)
+			{
+				float4 const m = vmulq_f32(a, b);
+#ifdef __aarch64__
+				return vdupq_n_f32(vaddvq_f32(m));
+#else
+				float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+				s = vpadd_f32(s, s);
+				return vcombine_f32(s, s);
+#endif
+			}
+
+			float4 cross3(float4 a, float4 b)
+			{
+				float const ax = vgetq_lane_f32(a, 0), ay = vgetq_lane_f32(a, 1), az = vgetq_lane_f32(a, 2);
+				float const bx = vgetq_lane_f32(b, 0), by = vgetq_lane_f32(b, 1), bz = vgetq_lane_f32(b, 2);
+				return vsubq_f32(
+					vmulq_f32(set(ay, az, ax, vgetq_lane_f32(a, 3)), set(bz, bx, by, vgetq_lane_f32(b, 3))),
+					vmulq_f32(set(az, ax, ay, vgetq_lane_f32(a, 3)), set(by, bz, bx, vgetq_lane_f32(b, 3))));
+			}
+
+			void transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+			{
+				float32x4x2_t const t01 = vtrnq_f32(r0, r1);
+				float32x4x2_t const t23 = vtrnq_f32(r2, r3);
+				r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+				r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+				r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+				r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+			}
+
+#else
+
+			float4 load(float const * mem)
+			{
+				return float4{{ mem[0], mem[1], mem[2], mem[3] }};
+			}
+
+			float4 loadu(float const * mem)
+			{
+				return load(mem);
+			}
+
+			void store(float * mem, float4 v)
+			{
+				for(size_t i = 0; i < 4; i++)
+					mem[i] = v.m[i];
+			}
+
+			void storeu(float * mem, float4 v)
+			{
+				store(mem, v);
+			}
+
+			float4 set(float x, float y, float z, float w)
+			{
+				return float4{{ x, y, z, w }};
+			}
+
+			float4 splat(float v)
+			{
+				return float4{{ v, v, v, v }};
+			}
+
+			float4 zero()
+			{
+				return splat(0.0f);
+			}
+
+			template<size_t i>
+			float4 broadcast(float4 v)
+			{
+				return splat(v.m[i]);
+			}
+
+			float first(float4 v)
+			{
+				return v.m[0];
+			}
+
+			template<size_t x, size_t y, size_t z, size_t w>
+			float4 shuffle(float4 a, float4 b)
+			{
+				return set(a.m[x], a.m[y], b.m[z], b.m[w]);
+			}
+
+			float4 add(float4 a, float4 b)
+			{
+				return float4{{ a.m[0] + b.m[0], a.m[1] + b.m[1], a.m[2] + b.m[2], a.m[3] + b.m[3] }};
+			}
+
+			float4 sub(float4 a, float4 b)
+			{
+				return float4{{ a.m[0] - b.m[0], a.m[1] - b.m[1], a.m[2] - b.m[2], a.m[3] - b.m[3] }};
+			}
+
+			float4 mul(float4 a, float4 b)
+			{
+				return float4{{ a.m[0] * b.m[0], a.m[1] * b.m[1], a.m[2] * b.m[2], a.m[3] * b.m[3] }};
+			}
+
+			float4 div(float4 a, float4 b)
+			{
+				return float4{{ a.m[0] / b.m[0], a.m[1] / b.m[1], a.m[2] / b.m[2], a.m[3] / b.m[3] }};
+			}
+
+			float4 madd(float4 a, float4 b, float4 c)
+			{
+				return add(mul(a, b), c);
+			}
+
+			float4 min(float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = a.m[i] < b.m[i] ? a.m[i] : b.m[i];
+				return r;
+			}
+
+			float4 max(float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = a.m[i] > b.m[i] ? a.m[i] : b.m[i];
+				return r;
+			}
+
+			float4 sqrt(float4 v)
+			{
+				return float4{{ sqrtf(v.m[0]), sqrtf(v.m[1]), sqrtf(v.m[2]), sqrtf(v.m[3]) }};
+			}
+
+			float4 abs(float4 v)
+			{
+				return float4{{ fabsf(v.m[0]), fabsf(v.m[1]), fabsf(v.m[2]), fabsf(v.m[3]) }};
+			}
+
+			float4 round(float4 v)
+			{
+				return float4{{ rintf(v.m[0]), rintf(v.m[1]), rintf(v.m[2]), rintf(v.m[3]) }};
+			}
+
+			float4 rsqrt_estimate(float4 v)
+			{
+				return float4{{ 1.0f / sqrtf(v.m[0]), 1.0f / sqrtf(v.m[1]), 1.0f / sqrtf(v.m[2]), 1.0f / sqrtf(v.m[3]) }};
+			}
+
+			namespace detail
+			{
+				REIL float from_bits(uint32_t bits)
+				{
+					float lane;
+					std::memcpy(&lane, &bits, sizeof(lane));
+					return lane;
+				}
+
+				REIL uint32_t lane_bits(float lane)
+				{
+					uint32_t bits;
+					std::memcpy(&bits, &lane, sizeof(bits));
+					return bits;
+				}
+			}
+
+			float4 less(float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = detail::from_bits(a.m[i] < b.m[i] ? ~uint32_t(0) : 0);
+				return r;
+			}
+
+			float4 bit_and(float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = detail::from_bits(detail::lane_bits(a.m[i]) & detail::lane_bits(b.m[i]));
+				return r;
+			}
+
+			float4 bit_or(float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = detail::from_bits(detail::lane_bits(a.m[i]) | detail::lane_bits(b.m[i]));
+				return r;
+			}
+
+			float4 select(float4 mask, float4 a, float4 b)
+			{
+				float4 r;
+				for(size_t i = 0; i < 4; i++)
+					r.m[i] = detail::lane_bits(mask.m[i]) ? a.m[i] : b.m[i];
+				return r;
+			}
+
+			int mask_bits(float4 mask)
+			{
+				int bits = 0;
+				for(size_t i = 0; i < 4; i++)
+					if(detail::lane_bits(mask.m[i]))
+						bits |= 1 << i;
+				return bits;
+			}
+
+			float4 dot4(float4 a, float4 b)
+			{
+				return splat(a.m[0] * b.m[0] + a.m[1] * b.m[1] + a.m[2] * b.m[2] + a.m[3] * b.m[3]);
+			}
+
+			float4 cross3(float4 a, float4 b)
+			{
+				return float4{{
+					a.m[1] * b.m[2] - a.m[2] * b.m[1],
+					a.m[2] * b.m[0] - a.m[0] * b.m[2],
+					a.m[0] * b.m[1] - a.m[1] * b.m[0],
+					a.m[3] * b.m[3] - a.m[3] * b.m[3] }};
+			}
+
+			void transpose(float4 &r0, float4 &r1, float4 &r2, float4 &r3)
+			{
+				float4 const c0 = r0, c1 = r1, c2 = r2, c3 = r3;
+				r0 = set(c0.m[0], c1.m[0], c2.m[0], c3.m[0]);
+				r1 = set(c0.m[1], c1.m[1], c2.m[1], c3.m[1]);
+				r2 = set(c0.m[2], c1.m[2], c2.m[2], c3.m[2]);
+				r3 = set(c0.m[3], c1.m[3], c2.m[3], c3.m[3]);
+			}
+
+#endif
+
+			float4 Lanes4::load(float const * mem) { return loadu(mem); }
+			void Lanes4::store(float * mem, float4 v) { storeu(mem, v); }
+			float4 Lanes4::splat(float v) { return simd::splat(v); }
+			float4 Lanes4::add(float4 a, float4 b) { return simd::add(a, b); }
+			float4 Lanes4::sub(float4 a, float4 b) { return simd::sub(a, b); }
+			float4 Lanes4::mul(float4 a, float4 b) { return simd::mul(a, b); }
+			float4 Lanes4::div(float4 a, float4 b) { return simd::div(a, b); }
+			float4 Lanes4::madd(float4 a, float4 b, float4 c) { return simd::madd(a, b, c); }
+			float4 Lanes4::min(float4 a, float4 b) { return simd::min(a, b); }
+			float4 Lanes4::max(float4 a, float4 b) { return simd::max(a, b); }
+			float4 Lanes4::round(float4 v) { return simd::round(v); }
+			float4 Lanes4::less(float4 a, float4 b) { return simd::less(a, b); }
+			float4 Lanes4::bit_or(float4 a, float4 b) { return simd::bit_or(a, b); }
+			float4 Lanes4::select(float4 mask, float4 a, float4 b) { return simd::select(mask, a, b); }
+			int Lanes4::mask_bits(float4 mask) { return simd::mask_bits(mask); }
+
+#ifdef RE_SIMD_AVX
+			__m256 Lanes8::load(float const * mem) { return _mm256_loadu_ps(mem); }
+			void Lanes8::store(float * mem, __m256 v) { _mm256_storeu_ps(mem, v); }
+			__m256 Lanes8::splat(float v) { return _mm256_set1_ps(v); }
+			__m256 Lanes8::add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+			__m256 Lanes8::sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+			__m256 Lanes8::mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+			__m256 Lanes8::div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+			__m256 Lanes8::madd(__m256 a, __m256 b, __m256 c)
+			{
+#ifdef RE_SIMD_FMA
+				return _mm256_fmadd_ps(a, b, c);
+#else
+				return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+			}
+			__m256 Lanes8::min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+			__m256 Lanes8::max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+			__m256 Lanes8::round(__m256 v) { return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+			__m256 Lanes8::less(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+			__m256 Lanes8::bit_or(__m256 a, __m256 b) { return _mm256_or_ps(a, b); }
+			__m256 Lanes8::select(__m256 mask, __m256 a, __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+			int Lanes8::mask_bits(__m256 mask) { return _mm256_movemask_ps(mask); }
+#endif
+		}
+	}
+}
@@ -4,6 +4,7 @@
 #include <math.h>
 #include "../defines.hpp"
 #include "../base_types.hpp"
+#include "SIMD.hpp"
 #include <array>
 
 namespace re
@@ -192,10 +193,28 @@ namespace re
 		Vec3<T> abs(std::array<Vec3<T>, sz> const&);
 
 
+		namespace detail
+		{
+			template<class T>
+			/** The alignment of Vec4<T>. */
+			struct Vec4Alignment
+			{
+				static size_t const value = alignof(T);
+			};
+
+			template<>
+			/** Float vectors are aligned for SIMD loads. */
+			struct Vec4Alignment<float>
+			{
+				static size_t const value = simd::k_float4_alignment;
+			};
+		}
+
 		template<class T>
 		/** Template 4-dimensional vector class.
-			Supports conversion to element pointer, for easier passing to C functions. */
-		struct Vec4
+			Supports conversion to element pointer, for easier passing to C functions.
+			`Vec4<float>` is aligned for SIMD loads, and its operations are vectorised where SIMD instructions are available. */
+		struct alignas(detail::Vec4Alignment<T>::value) Vec4
 		{
 			template<class U>
 			RECX explicit operator Vec4<U>() const;
@@ -259,6 +278,8 @@ namespace re
 		template<class T> float absf(Vec4<T> const& v);
 		/** Divides the given vector by its length. */
 		template<class T> Vec4<T> norm(Vec4<T> const& a);
+		/** Calculates the cross product of the first three coordinates of the given vectors. The fourth coordinate is 0. */
+		template<class T> Vec4<T> cross(Vec4<T> const& a, Vec4<T> const& b);
 
 		template<class T, size_t sz>
 		Vec4<T> avg(std::array<Vec4<T>, sz> const&);
@@ -266,5 +287,6 @@ namespace re
 }
 
 #include "Vector.inl"
+#include "VectorSIMD.inl"
 
 #endif
\ No newline at end of file
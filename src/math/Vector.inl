@@ -523,5 +523,15 @@ namespace re
 				return a;
 		}
 
+		template<class T>
+		Vec4<T> cross(Vec4<T> const& a, Vec4<T> const& b)
+		{
+			return Vec4<T>(
+				a.y*b.z-a.z*b.y,
+				a.z*b.x-a.x*b.z,
+				a.x*b.y-a.y*b.x,
+				T(0));
+		}
+
 	}
 }
@@ -0,0 +1,53 @@
+#ifndef RE_SIMD_SCALAR
+
+/* Vectorised overloads for Vec4<float>. They are preferred over the templates, which remain the reference implementation, and are used instead if RE_SIMD_SCALAR is defined. Only the operations that re_simd_ops measures to be faster than their template have an overload: the element-wise operations and cross() compile to code that is as fast as the loads and stores around a vector register. */
+
+namespace re
+{
+	namespace math
+	{
+		namespace simd
+		{
+			/** Loads a vector into a register. */
+			REIL float4 load(Vec4<float> const& v)
+			{
+				return load(&v.x);
+			}
+
+			/** Stores a register into a vector. */
+			REIL Vec4<float> to_vec4(float4 v)
+			{
+				Vec4<float> result;
+				store(&result.x, v);
+				return result;
+			}
+		}
+
+		REIL float dot(Vec4<float> const& a, Vec4<float> const& b)
+		{
+			return simd::first(simd::dot4(simd::load(a), simd::load(b)));
+		}
+
+		REIL float dotf(Vec4<float> const& a, Vec4<float> const& b)
+		{
+			return dot(a, b);
+		}
+
+		REIL float absf(Vec4<float> const& v)
+		{
+			simd::float4 const r = simd::load(v);
+			return simd::first(simd::sqrt(simd::dot4(r, r)));
+		}
+
+		REIL Vec4<float> norm(Vec4<float> const& a)
+		{
+			simd::float4 const r = simd::load(a);
+			simd::float4 const sqr = simd::dot4(r, r);
+			return simd::first(sqr) != 0.0f
+				? simd::to_vec4(simd::div(r, simd::sqrt(sqr)))
+				: a;
+		}
+	}
+}
+
+#endif
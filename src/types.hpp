@@ -16,6 +16,8 @@ namespace re
 	using re::util::NotNull;
 	using re::util::Delegate;
 	using re::util::Shared;
+	using re::util::AtomicShared;
+	using re::util::Borrowed;
 	using re::util::Auto;
 }
 
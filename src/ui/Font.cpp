@@ -2,8 +2,10 @@
 #include "Label.hpp"
 
 #include "../util/AllocationBuffer.hpp"
+#include "../util/FrameArena.hpp"
 
 #include <cmath>
+#include <new>
 
 namespace re
 {
@@ -113,18 +115,32 @@ namespace re
 			string8_t const& text,
 			FontSettings const& settings) const
 		{
-			return size(to_u32(text), settings);
+			util::FrameArena::Scope scope(util::FrameArena::local());
+			return size(
+				to_u32(text, scope.arena()),
+				text.length(),
+				settings);
 		}
 		math::fvec2_t Font::size(
 			string32_t const& text,
 			FontSettings const& settings) const
+		{
+			return size(
+				text.data(),
+				text.length(),
+				settings);
+		}
+		math::fvec2_t Font::size(
+			utf32_t const * text,
+			size_t length,
+			FontSettings const& settings) const
 		{
 			if(settings.orientation == TextOrientation::Horizontal)
 			{
 				math::fvec2_t max(0,-m_line_height*settings.lineHeight);
 				math::fvec2_t pen(0,-m_line_height*settings.lineHeight);
 
-				for(size_t i = 0; i<text.length(); i++)
+				for(size_t i = 0; i<length; i++)
 				{
 					const auto c = text[i];
 					switch(c)
@@ -189,8 +205,10 @@ namespace re
 			math::fvec2_t &pen_position,
 			VertexArray &out) const
 		{
+			util::FrameArena::Scope scope(util::FrameArena::local());
 			compile(
-				to_u32(text),
+				to_u32(text, scope.arena()),
+				text.length(),
 				settings,
 				pen_position,
 				out);
@@ -201,6 +219,21 @@ namespace re
 			FontSettings const& settings,
 			math::fvec2_t &pen_position,
 			VertexArray &out) const
+		{
+			compile(
+				text.data(),
+				text.length(),
+				settings,
+				pen_position,
+				out);
+		}
+
+		void Font::compile(
+			utf32_t const * text,
+			size_t length,
+			FontSettings const& settings,
+			math::fvec2_t &pen_position,
+			VertexArray &out) const
 		{
 			if(!out.exists())
 			{
@@ -208,20 +241,23 @@ namespace re
 				VertexArray::alloc(&addr, 1);
 			}
 
-			std::vector<Vertex> vertices;
-			std::vector<uint32_t> indices;
-			size_t const renderable_count = renderables(text);
-			vertices.reserve(renderable_count*4);
-			indices.reserve(renderable_count*6);
+			// the geometry is only needed until it is uploaded.
+			util::FrameArena::Scope scope(util::FrameArena::local());
+
+			size_t const renderable_count = renderables(text, length);
+			Vertex * const vertices = scope.arena().allocate_array<Vertex>(renderable_count*4);
+			graphics::gl::index_t * const indices = scope.arena().allocate_array<graphics::gl::index_t>(renderable_count*6);
+			size_t vertex_count = 0;
+			size_t index_count = 0;
 
 
-			const math::fvec2_t bounds = size(text, settings);
+			const math::fvec2_t bounds = size(text, length, settings);
 
 			pen_position = (settings.orientation == TextOrientation::Horizontal)
 				? math::fvec2_t(0, -m_line_height * settings.lineHeight)
 				: math::fvec2_t(0,0);
 
-				for(size_t i = 0; i<text.length(); i++)
+				for(size_t i = 0; i<length; i++)
 				{
 					const auto c = text[i];
 					switch(c)
@@ -261,47 +297,48 @@ namespace re
 							math::fvec2_t const pos_o(settings.size * math::fvec2_t(pen_position.x+entry.bearing_h.x, pen_position.y+entry.bearing_h.y));
 							math::fvec2_t const pos_t(settings.size * math::fvec2_t(pos_o.x+entry.size.x, pos_o.y-entry.size.y));
 
-							vertices.reserve(vertices.size() + 4);
-							size_t const base_index = vertices.size();
+							size_t const base_index = vertex_count;
 							/* Vertex data is passed as follows:
 							2---1
 							|  /|
 							| / |
 							|/  |
 							0---3. */
-							vertices.emplace_back(
+							new (&vertices[vertex_count++]) Vertex(
 								math::fvec3_t(pos_o.x, pos_t.y, 0),
 								math::fvec2_t(tex_o.x, tex_t.y),
 								settings.color);
-							vertices.emplace_back(
+							new (&vertices[vertex_count++]) Vertex(
 								math::fvec3_t(pos_t.x, pos_o.y, 0),
 								math::fvec2_t(tex_t.x, tex_o.y),
 								settings.color);
-							vertices.emplace_back(
+							new (&vertices[vertex_count++]) Vertex(
 								math::fvec3_t(pos_o.x, pos_o.y, 0),
 								math::fvec2_t(tex_o.x, tex_o.y),
 								settings.color);
-							vertices.emplace_back(
+							new (&vertices[vertex_count++]) Vertex(
 								math::fvec3_t(pos_t.x, pos_t.y, 0),
 								math::fvec2_t(tex_t.x, tex_t.y),
 								settings.color);
 
-							indices.push_back(base_index + 0);
-							indices.push_back(base_index + 1);
-							indices.push_back(base_index + 2);
+							indices[index_count++] = base_index + 0;
+							indices[index_count++] = base_index + 1;
+							indices[index_count++] = base_index + 2;
 
-							indices.push_back(base_index + 0);
-							indices.push_back(base_index + 3);
-							indices.push_back(base_index + 1);
+							indices[index_count++] = base_index + 0;
+							indices[index_count++] = base_index + 3;
+							indices[index_count++] = base_index + 1;
 
 							pen_position.x += entry.advance.x + settings.letterSpacing;
 						} break;
 					}
 				}
 			out.set_data(
-				std::move(vertices),
+				vertices,
+				vertex_count,
 				graphics::gl::RenderMode::Triangles,
-				std::move(indices));
+				indices,
+				index_count);
 		}
 
 		size_t Font::renderables(string8_t const& text)
@@ -314,12 +351,17 @@ namespace re
 		}
 
 		size_t Font::renderables(string32_t const& text)
+		{
+			return renderables(text.data(), text.length());
+		}
+
+		size_t Font::renderables(utf32_t const * text, size_t length)
 		{
 			size_t count = 0;
-			for(size_t i = text.length(); i-->0;)
+			for(size_t i = length; i-->0;)
 				if(!renderable(text[i]))
 					count++;
-			return text.length()-count;
+			return length-count;
 		}
 
 		bool Font::renderable(uint32_t codepoint)
@@ -340,5 +382,14 @@ namespace re
 
 			return data;
 		}
+
+		utf32_t * Font::to_u32(string8_t const& str, util::FrameArena &arena)
+		{
+			utf32_t * const data = arena.allocate_array<utf32_t>(str.length());
+			for(size_t i = 0; i<str.length(); i++)
+				data[i] = str[i];
+
+			return data;
+		}
 	}
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../graphics/gl/Texture.hpp"
 #include "../types.hpp"
 #include "../defines.hpp"
+#include "../util/FrameArena.hpp"
 
 #include "Rendering.hpp"
 
@@ -85,6 +86,22 @@ namespace re
 			uint_t m_tab_width;
 			/** How wide (in text coordinates) the space character should be. */
 			uint_t m_space_width;
+
+			math::fvec2_t size(
+				utf32_t const * text,
+				size_t length,
+				FontSettings const& settings) const;
+
+			void compile(
+				utf32_t const * text,
+				size_t length,
+				FontSettings const& settings,
+				math::fvec2_t &pen_position,
+				VertexArray & out) const;
+
+			static size_t renderables(
+				utf32_t const * text,
+				size_t length);
 		public:
 			/** Creates font object.
 			@param[in] atlas:
@@ -141,6 +158,12 @@ namespace re
 				uint32_t codepoint);
 
 			static string32_t to_u32(string8_t const& text);
+			/** Converts the text into a temporary array that lives until the arena is rewound.
+			@return
+				The converted text, with `text.length()` elements. */
+			static utf32_t * to_u32(
+				string8_t const& text,
+				util::FrameArena &arena);
 		};
 	}
 }
@@ -21,7 +21,7 @@ namespace re
 			string32_t text)
 		{
 			m_label.set_text(std::move(text));
-			m_label.set_font(UINode::font());
+			m_label.set_font(UINode::inherited_font().share());
 			m_label.update();
 			update_bounds();
 		}
@@ -39,10 +39,10 @@ namespace re
 
 		void TextNode::update()
 		{
-			Shared<Font> const& temp_font = UINode::font();
-			if(m_label.font() != temp_font)
+			Borrowed<Font> const font = UINode::inherited_font();
+			if(font != m_label.font())
 			{
-				m_label.set_font(temp_font);
+				m_label.set_font(font.share());
 				m_label.update();
 			}
 
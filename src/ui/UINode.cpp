@@ -125,12 +125,16 @@ namespace re
 		}
 		Shared<Font> const& UINode::font() const
 		{
-			for(UINode const * node = this; node->m_parent != nullptr; node = node->m_parent)
+			return m_font;
+		}
+
+		Borrowed<Font> UINode::inherited_font() const
+		{
+			for(UINode const * node = this; node; node = node->m_parent)
 				if(node->m_font)
 					return node->m_font;
 
-			// must not return nullptr here, because a reference is required.
-			return m_font; // == nullptr
+			return nullptr;
 		}
 
 
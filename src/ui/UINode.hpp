@@ -10,6 +10,7 @@
 #include "../graphics/RenderSession.hpp"
 
 #include "../util/Delegate.hpp"
+#include "../util/ObjectPool.hpp"
 #include "../input/Input.hpp"
 
 namespace re
@@ -119,10 +120,10 @@ namespace re
 				Null, if no font is set for this node, otherwise, this node's font. */
 			Shared<Font> const& font() const;
 			/** Retrieves the font inherited by the closest ancestor, or self.
-				Finds the closest ancestor that has a font set, and returns its font.
+				Finds the closest ancestor that has a font set, and returns its font without copying it.
 			@return
 				The font that is set for this node, or null, if no font was set. */
-			Shared<Font> inherited_font() const;
+			Borrowed<Font> inherited_font() const;
 
 			/** @retunr This node's children. */
 			std::vector<Auto<UINode>> const& children() const;
@@ -134,6 +135,14 @@ namespace re
 			void add_child(
 				Auto<UINode> node);
 
+			template<class Node, class ... Args>
+			/** Allocates a node from the shared pool of its type, to be passed to `add_child()`.
+				Building and tearing down large trees then does not go through the Heap. Pooled nodes are freed like any other node, when their owning Auto is destroyed.
+			@param[in] args:
+				The arguments to be used when constructing the node. */
+			static Node * alloc(
+				Args && ... args);
+
 			/** Finds a child by name.
 			@return the child with the requested name, or null. */
 			UINode * find_child(
@@ -269,5 +278,6 @@ namespace re
 	}
 }
 
+#include "UINode.inl"
 
 #endif
\ No newline at end of file
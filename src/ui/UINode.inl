@@ -0,0 +1,14 @@
+#include "../Singleton.hpp"
+
+namespace re
+{
+	namespace ui
+	{
+		template<class Node, class ... Args>
+		Node * UINode::alloc(
+			Args && ... args)
+		{
+			return singleton<util::ObjectPool<Node>>().alloc(std::forward<Args>(args)...);
+		}
+	}
+}
@@ -137,13 +137,14 @@ namespace re
 						m_texture_scale.y)
 				};
 
-				std::vector<Vertex> vertices = {
+				// a quad has a fixed size, so it is built on the stack instead of the heap.
+				Vertex const vertices[] = {
 					Vertex(m_position, tex_origin, m_color),
 					Vertex({m_position.x, end.y}, {tex_origin.x, tex_end.y}, m_color),
 					Vertex({end.x, m_position.y}, {tex_end.x, tex_origin.y}, m_color),
 					Vertex(end, tex_end, m_color)
 				};
-				std::vector<graphics::gl::index_t> indices = {
+				static graphics::gl::index_t const indices[] = {
 					0, 1, 2,
 					2, 1, 3
 				};
@@ -152,9 +153,11 @@ namespace re
 					m_model.alloc();
 
 				m_model.set_data(
-					std::move(vertices),
+					vertices,
+					sizeof(vertices) / sizeof(*vertices),
 					graphics::gl::RenderMode::Triangles,
-					std::move(indices));
+					indices,
+					sizeof(indices) / sizeof(*indices));
 			}
 
 			void Image::draw() const
@@ -0,0 +1,54 @@
+#ifndef __re_util_alignedallocator_hpp_defined
+#define __re_util_alignedallocator_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+#include "Heap.hpp"
+
+#include <vector>
+
+namespace re
+{
+	namespace util
+	{
+		template<class T, size_t Alignment = k_cache_line>
+		/** STL-compatible allocator that allocates via `re::aligned_malloc()`.
+			The alignment is at least `alignof(T)`. */
+		class AlignedAllocator
+		{
+			static_assert(Alignment && !(Alignment & (Alignment - 1)),
+				"alignment must be a power of two.");
+		public:
+			typedef T value_type;
+
+			template<class U>
+			struct rebind
+			{
+				typedef AlignedAllocator<U, Alignment> other;
+			};
+
+			/** The alignment of allocated memory. */
+			static RECX size_t alignment();
+
+			AlignedAllocator() = default;
+			template<class U>
+			REIL AlignedAllocator(AlignedAllocator<U, Alignment> const&);
+
+			REIL T * allocate(size_t count);
+			REIL void deallocate(T * data, size_t);
+
+			template<class U>
+			RECX bool operator==(AlignedAllocator<U, Alignment> const&) const;
+			template<class U>
+			RECX bool operator!=(AlignedAllocator<U, Alignment> const&) const;
+		};
+
+		template<class T, size_t Alignment = k_cache_line>
+		/** A vector whose elements are aligned for SIMD access. */
+		using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+	}
+}
+
+#include "AlignedAllocator.inl"
+
+#endif
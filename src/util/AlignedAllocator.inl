@@ -0,0 +1,51 @@
+#include <new>
+
+namespace re
+{
+	namespace util
+	{
+		template<class T, size_t Alignment>
+		RECX size_t AlignedAllocator<T, Alignment>::alignment()
+		{
+			return Alignment < alignof(T)
+				? alignof(T)
+				: Alignment;
+		}
+
+		template<class T, size_t Alignment>
+		template<class U>
+		AlignedAllocator<T, Alignment>::AlignedAllocator(AlignedAllocator<U, Alignment> const&)
+		{
+		}
+
+		template<class T, size_t Alignment>
+		T * AlignedAllocator<T, Alignment>::allocate(size_t count)
+		{
+			if(void * const data = re::aligned_malloc(sizeof(T) * count, alignment()))
+				return static_cast<T *>(data);
+
+			throw std::bad_alloc();
+		}
+
+		template<class T, size_t Alignment>
+		void AlignedAllocator<T, Alignment>::deallocate(T * data, size_t)
+		{
+			if(data)
+				re::free(data);
+		}
+
+		template<class T, size_t Alignment>
+		template<class U>
+		RECX bool AlignedAllocator<T, Alignment>::operator==(AlignedAllocator<U, Alignment> const&) const
+		{
+			return true;
+		}
+
+		template<class T, size_t Alignment>
+		template<class U>
+		RECX bool AlignedAllocator<T, Alignment>::operator!=(AlignedAllocator<U, Alignment> const&) const
+		{
+			return false;
+		}
+	}
+}
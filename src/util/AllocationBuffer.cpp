@@ -0,0 +1,55 @@
+#include "AllocationBuffer.hpp"
+
+namespace re
+{
+	namespace util
+	{
+		AllocationStack::AllocationStack():
+			m_arena(k_capacity),
+			m_depth(0),
+			m_used(0),
+			m_peak(0),
+			m_calm(0)
+		{
+		}
+
+		AllocationStack &AllocationStack::local()
+		{
+			thread_local AllocationStack stack;
+			return stack;
+		}
+
+		void * AllocationStack::push(size_t size, size_t alignment)
+		{
+			++m_depth;
+			if((m_used += size) > m_peak)
+				m_peak = m_used;
+
+			return m_arena.allocate(size, alignment);
+		}
+
+		void AllocationStack::pop(FrameArena::Mark const& mark, size_t size)
+		{
+			RE_DBG_ASSERT(m_depth
+				&& "AllocationBuffer released twice.");
+			RE_DBG_ASSERT((m_arena.mark().m_chunk != mark.m_chunk || m_arena.mark().m_top >= mark.m_top)
+				&& "AllocationBuffers released out of order.");
+
+			m_arena.rewind(mark);
+			m_used -= size;
+
+			if(--m_depth)
+				return;
+
+			// an outermost batch ended, check whether a spike is over.
+			if(m_peak > k_capacity)
+				m_calm = 0;
+			else if(m_arena.capacity() > k_capacity && ++m_calm >= k_trim_delay)
+			{
+				m_arena.trim(k_capacity);
+				m_calm = 0;
+			}
+			m_peak = 0;
+		}
+	}
+}
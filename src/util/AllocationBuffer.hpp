@@ -2,36 +2,91 @@
 #define __re_util_allocationbuffer_hpp_defined
 
 #include "../defines.hpp"
-#include <vector>
+#include "../base_types.hpp"
+#include "FrameArena.hpp"
+
+#include <type_traits>
 
 namespace re
 {
 	namespace util
 	{
-		namespace detail
+		/** The thread-local stack that AllocationBuffers are allocated from.
+			It is separate from `FrameArena::local()`, so that batches work at any point of a frame. After a spike, once enough batches in a row fit into the default capacity again, the extra memory is returned. */
+		class AllocationStack
 		{
 			template<class T>
-			/** Holds the buffer used by allocation_buffer and free_allocation_buffer. */
-			struct AllocationBufferStorage
-			{
-				static std::vector<T> buffer;
-			};
-		}
+			friend class AllocationBuffer;
 
-		template<class T>
-		/** Returns a reusable Buffer of the given size.
-		@param[in] count:
-			How many elements to allocate.
-		@return
-			The allocated buffer.
-		@important The returned buffer is invalidated after the next call to allocation_buffer. */
-		T * allocation_buffer(size_t count);
+			/** The memory of the stack. */
+			FrameArena m_arena;
+			/** How many AllocationBuffers are currently alive. */
+			size_t m_depth;
+			/** The bytes currently allocated. */
+			size_t m_used;
+			/** The highest `m_used` of the current outermost batch. */
+			size_t m_peak;
+			/** How many outermost batches in a row fit into k_capacity. */
+			size_t m_calm;
+
+			AllocationStack();
+
+			/** Allocates memory for a new AllocationBuffer. */
+			void * push(size_t size, size_t alignment);
+			/** Releases the memory of the most recent AllocationBuffer. */
+			void pop(FrameArena::Mark const& mark, size_t size);
+		public:
+			/** The capacity the stack is trimmed back to. */
+			static size_t const k_capacity = 16 * 1024;
+			/** After how many outermost batches that fit into k_capacity the stack is trimmed. */
+			static size_t const k_trim_delay = 32;
+
+			AllocationStack(AllocationStack const&) = delete;
+			AllocationStack &operator=(AllocationStack const&) = delete;
+
+			/** The stack of the calling thread. */
+			static AllocationStack &local();
+
+			/** The byte size of the memory held by the stack. */
+			REIL size_t capacity() const;
+			/** How many AllocationBuffers are currently alive on this stack. */
+			REIL size_t depth() const;
+		};
 
 		template<class T>
-		/** For manually releasing the memory held by AllocationBufferStorage<T>::buffer.
-			This function is optional.
-		@side Frees the memory held by AllocationBufferStorage<T>::buffer. */
-		void free_allocation_buffer();
+		/** Scratch array that lives until the end of its scope.
+			It is allocated from the calling thread's AllocationStack, and released when it is destroyed. AllocationBuffers must therefore be destroyed in reverse order of creation, which holds for local variables. Nested batches and different threads each get their own memory.
+			The elements are not initialised. */
+		class AllocationBuffer
+		{
+			static_assert(std::is_trivially_destructible<T>::value,
+				"AllocationBuffer elements are never destroyed.");
+
+			/** Where the stack was before the buffer was allocated. */
+			FrameArena::Mark const m_mark;
+			/** The elements. */
+			T * const m_data;
+			/** The element count. */
+			size_t const m_size;
+		public:
+			/** Allocates a buffer.
+			@param[in] count:
+				How many elements to allocate. */
+			explicit AllocationBuffer(size_t count);
+			/** Releases the buffer.
+			@assert
+				The buffer must be the most recent one of its thread. */
+			~AllocationBuffer();
+
+			AllocationBuffer(AllocationBuffer const&) = delete;
+			AllocationBuffer &operator=(AllocationBuffer const&) = delete;
+
+			/** The elements. */
+			REIL T * data() const;
+			/** The element count. */
+			REIL size_t size() const;
+			REIL T &operator[](size_t i) const;
+		};
 	}
 }
 
@@ -1,23 +1,50 @@
+#include "../LogFile.hpp"
+
 namespace re
 {
 	namespace util
 	{
+		size_t AllocationStack::capacity() const
+		{
+			return m_arena.capacity();
+		}
+
+		size_t AllocationStack::depth() const
+		{
+			return m_depth;
+		}
+
+		template<class T>
+		AllocationBuffer<T>::AllocationBuffer(size_t count):
+			m_mark(AllocationStack::local().m_arena.mark()),
+			m_data(static_cast<T *>(AllocationStack::local().push(sizeof(T) * count, alignof(T)))),
+			m_size(count)
+		{
+		}
+
 		template<class T>
-		std::vector<T> detail::AllocationBufferStorage<T>::buffer;
+		AllocationBuffer<T>::~AllocationBuffer()
+		{
+			AllocationStack::local().pop(m_mark, sizeof(T) * m_size);
+		}
 
 		template<class T>
-		T * allocation_buffer(size_t count)
+		T * AllocationBuffer<T>::data() const
 		{
-			if(detail::AllocationBufferStorage<T>::buffer.size() < count)
-				detail::AllocationBufferStorage<T>::buffer.resize(count);
+			return m_data;
+		}
 
-			return detail::AllocationBufferStorage<T>::buffer.data();
+		template<class T>
+		size_t AllocationBuffer<T>::size() const
+		{
+			return m_size;
 		}
 
 		template<class T>
-		void free_allocation_buffer()
+		T &AllocationBuffer<T>::operator[](size_t i) const
 		{
-			detail::AllocationBufferStorage<T>::buffer.clear();
+			RE_DBG_ASSERT(i < m_size);
+			return m_data[i];
 		}
 	}
 }
\ No newline at end of file
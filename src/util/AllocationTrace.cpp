@@ -0,0 +1,272 @@
+#include "AllocationTrace.hpp"
+#include "../LogFile.hpp"
+#include "../Singleton.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+namespace re
+{
+	namespace util
+	{
+		namespace
+		{
+			/** The beginning of a trace file. */
+			struct TraceHeader
+			{
+				char m_magic[4];
+				std::uint32_t m_version;
+				/** `sizeof(TraceEvent)`, to reject traces from incompatible builds. */
+				std::uint32_t m_event_size;
+				std::uint32_t m_reserved;
+			};
+
+			char const k_magic[4] = { 'R', 'E', 'A', 'T' };
+			std::uint32_t const k_version = 1;
+
+			/** How many threads have recorded an event so far. */
+			std::atomic<std::uint16_t> s_threads(0);
+			/** The id of the calling thread in traces. */
+			thread_local std::uint16_t const s_thread = s_threads++;
+			/** How many Scopes exist on the calling thread. */
+			thread_local size_t s_depth = 0;
+
+			std::uint8_t log2(size_t alignment)
+			{
+				std::uint8_t bits = 0;
+				while(alignment >>= 1)
+					++bits;
+				return bits;
+			}
+		}
+
+		AllocationTrace::AllocationTrace():
+			m_file(nullptr),
+			m_recording(false),
+			m_locked(false),
+			m_next_id(0),
+			m_events(0)
+		{
+		}
+
+		AllocationTrace::~AllocationTrace()
+		{
+			stop();
+		}
+
+		void AllocationTrace::lock()
+		{
+			while(m_locked.exchange(true, std::memory_order_acquire))
+				std::this_thread::yield();
+		}
+
+		void AllocationTrace::unlock()
+		{
+			m_locked.store(false, std::memory_order_release);
+		}
+
+		bool AllocationTrace::start(char const * path)
+		{
+			stop();
+
+			Scope const untraced;
+			std::FILE * const file = std::fopen(path, "wb");
+			if(!file)
+				return false;
+
+			TraceHeader header;
+			std::memcpy(header.m_magic, k_magic, sizeof(k_magic));
+			header.m_version = k_version;
+			header.m_event_size = sizeof(TraceEvent);
+			header.m_reserved = 0;
+			if(std::fwrite(&header, sizeof(header), 1, file) != 1)
+			{
+				std::fclose(file);
+				return false;
+			}
+
+			lock();
+			m_file = file;
+			m_start = std::chrono::steady_clock::now();
+			m_next_id = 0;
+			m_events = 0;
+			m_buffer.reserve(k_buffer_events);
+			m_recording.store(true, std::memory_order_relaxed);
+			unlock();
+
+			return true;
+		}
+
+		void AllocationTrace::stop()
+		{
+			Scope const untraced;
+			lock();
+			if(m_file)
+			{
+				flush();
+				std::fclose(m_file);
+				m_file = nullptr;
+			}
+			m_recording.store(false, std::memory_order_relaxed);
+			m_ids.clear();
+			unlock();
+		}
+
+		void AllocationTrace::push(TraceOp op, std::uint32_t id, size_t size, size_t alignment)
+		{
+			TraceEvent event;
+			event.m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - m_start).count();
+			event.m_size = size;
+			event.m_id = id;
+			event.m_thread = s_thread;
+			event.m_op = std::uint8_t(op);
+			event.m_alignment = log2(alignment);
+
+			m_buffer.push_back(event);
+			++m_events;
+			if(m_buffer.size() >= k_buffer_events)
+				flush();
+		}
+
+		void AllocationTrace::flush()
+		{
+			if(m_buffer.empty())
+				return;
+
+			if(std::fwrite(m_buffer.data(), sizeof(TraceEvent), m_buffer.size(), m_file) != m_buffer.size())
+				RE_LOG("could not write the allocation trace.");
+			m_buffer.clear();
+		}
+
+		bool AllocationTrace::load(char const * path, std::vector<TraceEvent> &events)
+		{
+			std::FILE * const file = std::fopen(path, "rb");
+			if(!file)
+			{
+				RE_LOG("could not open %s.", path);
+				return false;
+			}
+
+			TraceHeader header;
+			bool const valid = std::fread(&header, sizeof(header), 1, file) == 1
+				&& !std::memcmp(header.m_magic, k_magic, sizeof(k_magic))
+				&& header.m_version == k_version
+				&& header.m_event_size == sizeof(TraceEvent);
+
+			if(valid)
+			{
+				TraceEvent event;
+				while(std::fread(&event, sizeof(event), 1, file) == 1)
+					events.push_back(event);
+			} else
+				RE_LOG("%s is not a compatible allocation trace.", path);
+
+			std::fclose(file);
+			return valid;
+		}
+
+		AllocationTrace::Scope::Scope():
+			m_trace(nullptr),
+			m_id(0),
+			m_known(false)
+		{
+			if(s_depth++)
+				return;
+
+			AllocationTrace &trace = singleton<AllocationTrace>();
+			if(trace.recording())
+				m_trace = &trace;
+		}
+
+		AllocationTrace::Scope::~Scope()
+		{
+			--s_depth;
+		}
+
+		void AllocationTrace::Scope::malloc(void const * mem, size_t size, size_t alignment)
+		{
+			if(!m_trace || !mem)
+				return;
+
+			m_trace->lock();
+			if(m_trace->m_file)
+			{
+				std::uint32_t const id = m_trace->m_next_id++;
+				m_trace->m_ids[mem] = id;
+				m_trace->push(TraceOp::Malloc, id, size, alignment);
+			}
+			m_trace->unlock();
+		}
+
+		void AllocationTrace::Scope::free(void const * mem)
+		{
+			if(!m_trace)
+				return;
+
+			m_trace->lock();
+			auto const it = m_trace->m_ids.find(mem);
+			if(it != m_trace->m_ids.end())
+			{
+				m_trace->push(TraceOp::Free, it->second, 0, 1);
+				m_trace->m_ids.erase(it);
+			}
+			m_trace->unlock();
+		}
+
+		void AllocationTrace::Scope::release(void const * mem)
+		{
+			if(!m_trace)
+				return;
+
+			// forget the address, so that other threads can reuse it while the block is moved.
+			m_trace->lock();
+			auto const it = m_trace->m_ids.find(mem);
+			if((m_known = (it != m_trace->m_ids.end())))
+			{
+				m_id = it->second;
+				m_trace->m_ids.erase(it);
+			}
+			m_trace->unlock();
+		}
+
+		void AllocationTrace::Scope::realloc(void const * old, void const * mem, size_t size)
+		{
+			if(!m_trace)
+				return;
+
+			m_trace->lock();
+			if(m_trace->m_file)
+			{
+				if(!mem)
+				{	// the reallocation failed, so the block stayed where it was.
+					if(m_known)
+						m_trace->m_ids[old] = m_id;
+				} else if(m_known)
+				{
+					m_trace->m_ids[mem] = m_id;
+					m_trace->push(TraceOp::Realloc, m_id, size, 1);
+				} else
+				{	// allocated before the recording started, so it is new to the trace.
+					std::uint32_t const id = m_trace->m_next_id++;
+					m_trace->m_ids[mem] = id;
+					m_trace->push(TraceOp::Malloc, id, size, alignof(std::max_align_t));
+				}
+			}
+			m_trace->unlock();
+		}
+
+		void AllocationTrace::Scope::resize(void const * mem, size_t size, bool resized)
+		{
+			if(!m_trace || !resized)
+				return;
+
+			m_trace->lock();
+			auto const it = m_trace->m_ids.find(mem);
+			if(it != m_trace->m_ids.end())
+				m_trace->push(TraceOp::Resize, it->second, size, 1);
+			m_trace->unlock();
+		}
+	}
+}
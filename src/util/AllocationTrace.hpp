@@ -0,0 +1,150 @@
+#ifndef __re_util_allocationtrace_hpp_defined
+#define __re_util_allocationtrace_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+namespace re
+{
+	namespace util
+	{
+		/** The operations recorded in an allocation trace. */
+		enum class TraceOp : std::uint8_t
+		{
+			/** A block was allocated. */
+			Malloc,
+			/** A block was freed. */
+			Free,
+			/** A block was resized, and possibly moved. */
+			Realloc,
+			/** A block was resized in place. */
+			RE_LAST(Resize)
+		};
+
+		/** A recorded allocator operation, as stored in a trace file. */
+		struct TraceEvent
+		{
+			/** The nanoseconds since the recording started. */
+			std::uint64_t m_time;
+			/** The requested byte size, or 0 for TraceOp::Free. */
+			std::uint64_t m_size;
+			/** Identifies the block. Ids are handed out in allocation order, starting at 0, and are not reused. */
+			std::uint32_t m_id;
+			/** Identifies the thread that performed the operation. */
+			std::uint16_t m_thread;
+			/** The TraceOp. */
+			std::uint8_t m_op;
+			/** For TraceOp::Malloc, the base-2 logarithm of the requested alignment. */
+			std::uint8_t m_alignment;
+		};
+
+		/** Records allocator operations to a compact binary trace file, so that real workloads can be replayed against different allocators.
+			The recording hooks are only compiled into the heap functions if RE_HEAP_TRACE is defined. While a trace is recording, every operation of `re::malloc()`, `re::aligned_malloc()`, `re::free()`, `re::realloc()`, `re::resize()`, Heap and MultiHeap is then recorded, in the order in which the threads performed them. Operations performed inside another recorded operation are not recorded again. Blocks allocated before the recording started are ignored.
+			Use `singleton<AllocationTrace>()`. */
+		class AllocationTrace
+		{
+			/** How many events are buffered before they are written. */
+			static size_t const k_buffer_events = 4096;
+
+			/** The trace file, or null if not recording. */
+			std::FILE * m_file;
+			/** Whether a trace is recording. */
+			std::atomic<bool> m_recording;
+			/** Whether a thread is recording an event. */
+			std::atomic<bool> m_locked;
+			/** When the recording started. */
+			std::chrono::steady_clock::time_point m_start;
+			/** The ids of the live blocks. */
+			std::unordered_map<void const *, std::uint32_t> m_ids;
+			/** The next block id. */
+			std::uint32_t m_next_id;
+			/** The events not yet written. */
+			std::vector<TraceEvent> m_buffer;
+			/** How many events were recorded so far. */
+			size_t m_events;
+
+			void lock();
+			void unlock();
+			/** Buffers an event, writing the buffer if it is full. Must be locked. */
+			void push(TraceOp op, std::uint32_t id, size_t size, size_t alignment);
+			/** Writes the buffered events. Must be locked. */
+			void flush();
+		public:
+			class Scope;
+
+			AllocationTrace();
+			/** Stops the recording. */
+			~AllocationTrace();
+
+			AllocationTrace(AllocationTrace const&) = delete;
+			AllocationTrace &operator=(AllocationTrace const&) = delete;
+
+			/** Starts recording to a file, stopping the current recording first.
+			@param[in] path:
+				The trace file to create.
+			@return
+				Whether the file could be created. */
+			bool start(char const * path);
+			/** Stops the recording and closes the trace file. */
+			void stop();
+
+			/** Whether a trace is recording. */
+			REIL bool recording() const;
+			/** How many events were recorded so far. */
+			REIL size_t events() const;
+
+			/** Reads a trace file.
+			@param[in] path:
+				The trace file.
+			@param[out] events:
+				Receives the events.
+			@return
+				Whether the file is a valid trace. */
+			static bool load(char const * path, std::vector<TraceEvent> &events);
+		};
+
+		/** Records an operation of a hooked allocator function.
+			Create one at the beginning of the function and report the operation through it. Scopes created while another one exists on the same thread record nothing. */
+		class AllocationTrace::Scope
+		{
+			/** The trace to record to, or null. */
+			AllocationTrace * m_trace;
+			/** The id of the block released via `release()`. */
+			std::uint32_t m_id;
+			/** Whether `release()` found the block. */
+			bool m_known;
+		public:
+			Scope();
+			~Scope();
+
+			Scope(Scope const&) = delete;
+			Scope &operator=(Scope const&) = delete;
+
+			/** Records an allocation. Does nothing if `mem` is null. */
+			void malloc(void const * mem, size_t size, size_t alignment);
+			/** Records a free. Must be called before the block is freed. */
+			void free(void const * mem);
+			/** Forgets the address of a block that is about to be reallocated. Must be called before `realloc()`. */
+			void release(void const * mem);
+			/** Records the reallocation of the block passed to `release()`.
+			@param[in] old:
+				The address passed to `release()`.
+			@param[in] mem:
+				The new address, or null if the reallocation failed. */
+			void realloc(void const * old, void const * mem, size_t size);
+			/** Records an in-place resize. Does nothing if it failed. */
+			void resize(void const * mem, size_t size, bool resized);
+		};
+	}
+}
+
+#include "AllocationTrace.inl"
+
+#endif
@@ -0,0 +1,15 @@
+namespace re
+{
+	namespace util
+	{
+		bool AllocationTrace::recording() const
+		{
+			return m_recording.load(std::memory_order_relaxed);
+		}
+
+		size_t AllocationTrace::events() const
+		{
+			return m_events;
+		}
+	}
+}
@@ -0,0 +1,158 @@
+#include "FrameArena.hpp"
+#include "Error.hpp"
+
+#include <cstdlib>
+
+namespace re
+{
+	namespace util
+	{
+		/** A block of arena memory, its data follows the Chunk. */
+		struct FrameArena::Chunk
+		{
+			/** The next chunk, or null. */
+			Chunk * m_next;
+			/** The byte size of the data. */
+			size_t m_size;
+
+			REIL uintptr_t begin() const
+			{
+				return uintptr_t(this + 1);
+			}
+
+			REIL uintptr_t end() const
+			{
+				return begin() + m_size;
+			}
+		};
+
+		FrameArena::FrameArena(
+			size_t capacity):
+			m_first(nullptr),
+			m_chunk(nullptr),
+			m_top(0),
+			m_end(0),
+			m_initial(capacity),
+			m_capacity(0),
+			m_allocations(0),
+			m_scopes(0)
+		{
+		}
+
+		FrameArena::~FrameArena()
+		{
+			RE_DBG_ASSERT(!m_scopes
+				&& "FrameArena destroyed while a Scope is open.");
+			release();
+		}
+
+		FrameArena &FrameArena::local()
+		{
+			thread_local FrameArena arena;
+			return arena;
+		}
+
+		void FrameArena::grow(size_t size, size_t alignment)
+		{
+			size_t const needed = size + alignment - 1;
+
+			// chunks after the current one are left over from before a rewind.
+			Chunk * next = m_chunk ? m_chunk->m_next : m_first;
+			while(next && next->m_size < needed)
+				next = next->m_next;
+
+			if(!next)
+			{
+				size_t chunk_size = (m_capacity > m_initial) ? m_capacity : m_initial;
+				if(chunk_size < needed)
+					chunk_size = needed;
+
+				RE_FATAL_LOG(
+					next = static_cast<Chunk *>(std::malloc(sizeof(Chunk) + chunk_size)),
+					"util::FrameArena allocation");
+				next->m_size = chunk_size;
+
+				if(m_chunk)
+				{
+					next->m_next = m_chunk->m_next;
+					m_chunk->m_next = next;
+				} else
+				{
+					next->m_next = m_first;
+					m_first = next;
+				}
+
+				m_capacity += chunk_size;
+				++m_allocations;
+			}
+
+			m_chunk = next;
+			m_top = next->begin();
+			m_end = next->end();
+		}
+
+		void FrameArena::release()
+		{
+			while(Chunk * const chunk = m_first)
+			{
+				m_first = chunk->m_next;
+				std::free(chunk);
+			}
+
+			m_chunk = nullptr;
+			m_top = 0;
+			m_end = 0;
+			m_capacity = 0;
+		}
+
+		void FrameArena::rewind(Mark const& mark)
+		{
+			m_chunk = mark.m_chunk;
+			m_top = mark.m_top;
+			m_end = m_chunk ? m_chunk->end() : 0;
+		}
+
+		void FrameArena::reset()
+		{
+			RE_DBG_ASSERT(!m_scopes
+				&& "FrameArena reset while a Scope is open.");
+
+			if(m_first && m_first->m_next)
+			{	// make the next frame fit into a single chunk.
+				size_t const total = m_capacity;
+				release();
+				grow(total, 1);
+			}
+
+			m_chunk = m_first;
+			m_top = m_chunk ? m_chunk->begin() : 0;
+			m_end = m_chunk ? m_chunk->end() : 0;
+		}
+
+		void FrameArena::trim(size_t capacity)
+		{
+			RE_DBG_ASSERT(!m_scopes
+				&& "FrameArena trimmed while a Scope is open.");
+
+			Chunk * const keep = (m_first && m_first->m_size <= capacity)
+				? m_first
+				: nullptr;
+
+			Chunk * it = keep ? keep->m_next : m_first;
+			while(Chunk * const chunk = it)
+			{
+				it = chunk->m_next;
+				m_capacity -= chunk->m_size;
+				std::free(chunk);
+			}
+
+			if(keep)
+				keep->m_next = nullptr;
+			m_first = keep;
+
+			m_chunk = m_first;
+			m_top = m_chunk ? m_chunk->begin() : 0;
+			m_end = m_chunk ? m_chunk->end() : 0;
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#ifndef __re_util_framearena_hpp_defined
+#define __re_util_framearena_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+#include <cstddef>
+
+namespace re
+{
+	namespace util
+	{
+		/** Bump-pointer allocator for short-lived scratch memory.
+			Allocating only advances a pointer, and memory is never freed individually: it is released all at once, either by rewinding to a Mark, or by resetting the arena once per frame, which graphics::Window::begin_frame() does for the arena of the calling thread.
+			When a frame needs more memory than the arena holds, more chunks are allocated, and the next reset() replaces them by a single chunk large enough for the whole frame. Steady-state frames thus perform no general-purpose allocations, which can be checked via allocations(). */
+		class FrameArena
+		{
+			struct Chunk;
+
+			/** The first chunk. */
+			Chunk * m_first;
+			/** The chunk that is currently allocated from. */
+			Chunk * m_chunk;
+			/** The next free address in the current chunk. */
+			uintptr_t m_top;
+			/** The end of the current chunk. */
+			uintptr_t m_end;
+			/** The byte size of the chunk allocated first. */
+			size_t m_initial;
+			/** The combined byte size of all chunks. */
+			size_t m_capacity;
+			/** How many chunks were allocated so far. */
+			size_t m_allocations;
+			/** How many Scopes are currently open. */
+			size_t m_scopes;
+
+			/** Continues in the next chunk that can hold the given size, allocating one if needed. */
+			void grow(size_t size, size_t alignment);
+			/** Frees all chunks. */
+			void release();
+		public:
+			class Scope;
+
+			/** A position in the arena to rewind to. */
+			struct Mark
+			{
+				Chunk * m_chunk;
+				uintptr_t m_top;
+			};
+
+			/** The chunk size used by the default constructor. */
+			static size_t const k_default_capacity = 64 * 1024;
+
+			/** Creates an arena whose first chunk is allocated on first use.
+			@param[in] capacity:
+				The byte size of the first chunk. */
+			explicit FrameArena(
+				size_t capacity = k_default_capacity);
+			~FrameArena();
+
+			FrameArena(FrameArena const&) = delete;
+			FrameArena &operator=(FrameArena const&) = delete;
+
+			/** The arena of the calling thread. */
+			static FrameArena &local();
+
+			/** Allocates uninitialised memory that lives until the arena is rewound or reset.
+			@param[in] size:
+				The byte size to allocate.
+			@param[in] alignment:
+				The alignment of the memory, a power of two.
+			@return
+				The allocated memory, never null. */
+			REIL void * allocate(
+				size_t size,
+				size_t alignment = alignof(std::max_align_t));
+
+			template<class T>
+			/** Allocates an uninitialised array.
+				Destructors are never called on arena memory, so T should be trivially destructible.
+			@param[in] count:
+				The element count of the array. */
+			REIL T * allocate_array(size_t count);
+
+			/** The current position, to be passed to rewind(). */
+			REIL Mark mark() const;
+			/** Releases everything that was allocated since the given mark was taken. */
+			void rewind(Mark const& mark);
+
+			/** Releases all allocations, and marks the beginning of a new frame.
+				If the previous frame needed more than one chunk, they are replaced by a single chunk of their combined size.
+			@assert
+				There must be no open Scope. */
+			void reset();
+			/** Like reset(), but also frees memory, so that at most the given capacity remains.
+				The first chunk is kept if it is not larger than the capacity.
+			@assert
+				There must be no open Scope. */
+			void trim(size_t capacity);
+
+			/** The combined byte size of all chunks. */
+			REIL size_t capacity() const;
+			/** How many chunks were allocated so far.
+				This does not change across frames that fit into the arena. */
+			REIL size_t allocations() const;
+			/** How many Scopes are currently open. */
+			REIL size_t scopes() const;
+		};
+
+		/** Rewinds the arena to where it was when the Scope was created. */
+		class FrameArena::Scope
+		{
+			FrameArena &m_arena;
+			Mark const m_mark;
+		public:
+			REIL explicit Scope(FrameArena &arena);
+			REIL ~Scope();
+
+			Scope(Scope const&) = delete;
+			Scope &operator=(Scope const&) = delete;
+
+			/** The arena this Scope belongs to. */
+			REIL FrameArena &arena() const;
+		};
+
+		template<class T>
+		/** STL-compatible allocator that allocates from a FrameArena.
+			Deallocating is a no-op, the memory is released with the arena. */
+		class FrameAllocator
+		{
+			template<class U>
+			friend class FrameAllocator;
+
+			FrameArena * m_arena;
+		public:
+			typedef T value_type;
+
+			template<class U>
+			struct rebind
+			{
+				typedef FrameAllocator<U> other;
+			};
+
+			/** Allocates from the arena of the calling thread. */
+			REIL FrameAllocator();
+			REIL FrameAllocator(FrameArena &arena);
+			template<class U>
+			REIL FrameAllocator(FrameAllocator<U> const& other);
+
+			REIL T * allocate(size_t count);
+			REIL void deallocate(T *, size_t);
+
+			template<class U>
+			REIL bool operator==(FrameAllocator<U> const& other) const;
+			template<class U>
+			REIL bool operator!=(FrameAllocator<U> const& other) const;
+		};
+	}
+}
+
+#include "FrameArena.inl"
+
+#endif
@@ -0,0 +1,113 @@
+#include "../LogFile.hpp"
+
+namespace re
+{
+	namespace util
+	{
+		void * FrameArena::allocate(
+			size_t size,
+			size_t alignment)
+		{
+			RE_DBG_ASSERT(alignment && !(alignment & (alignment - 1))
+				&& "alignment must be a power of two.");
+
+			uintptr_t begin = (m_top + alignment - 1) & ~uintptr_t(alignment - 1);
+			if(!m_chunk || begin + size > m_end)
+			{
+				grow(size, alignment);
+				begin = (m_top + alignment - 1) & ~uintptr_t(alignment - 1);
+			}
+
+			m_top = begin + size;
+			return reinterpret_cast<void *>(begin);
+		}
+
+		template<class T>
+		T * FrameArena::allocate_array(size_t count)
+		{
+			return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		FrameArena::Mark FrameArena::mark() const
+		{
+			return Mark{ m_chunk, m_top };
+		}
+
+		size_t FrameArena::capacity() const
+		{
+			return m_capacity;
+		}
+
+		size_t FrameArena::allocations() const
+		{
+			return m_allocations;
+		}
+
+		size_t FrameArena::scopes() const
+		{
+			return m_scopes;
+		}
+
+		FrameArena::Scope::Scope(FrameArena &arena):
+			m_arena(arena),
+			m_mark(arena.mark())
+		{
+			++m_arena.m_scopes;
+		}
+
+		FrameArena::Scope::~Scope()
+		{
+			m_arena.rewind(m_mark);
+			--m_arena.m_scopes;
+		}
+
+		FrameArena &FrameArena::Scope::arena() const
+		{
+			return m_arena;
+		}
+
+		template<class T>
+		FrameAllocator<T>::FrameAllocator():
+			m_arena(&FrameArena::local())
+		{
+		}
+
+		template<class T>
+		FrameAllocator<T>::FrameAllocator(FrameArena &arena):
+			m_arena(&arena)
+		{
+		}
+
+		template<class T>
+		template<class U>
+		FrameAllocator<T>::FrameAllocator(FrameAllocator<U> const& other):
+			m_arena(other.m_arena)
+		{
+		}
+
+		template<class T>
+		T * FrameAllocator<T>::allocate(size_t count)
+		{
+			return m_arena->allocate_array<T>(count);
+		}
+
+		template<class T>
+		void FrameAllocator<T>::deallocate(T *, size_t)
+		{
+		}
+
+		template<class T>
+		template<class U>
+		bool FrameAllocator<T>::operator==(FrameAllocator<U> const& other) const
+		{
+			return m_arena == other.m_arena;
+		}
+
+		template<class T>
+		template<class U>
+		bool FrameAllocator<T>::operator!=(FrameAllocator<U> const& other) const
+		{
+			return m_arena != other.m_arena;
+		}
+	}
+}
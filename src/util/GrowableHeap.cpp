@@ -0,0 +1,187 @@
+#include "GrowableHeap.hpp"
+#include "Error.hpp"
+
+#include <cstdlib>
+
+namespace re
+{
+	namespace util
+	{
+		/** A link in the chain of heaps. */
+		struct GrowableHeap::Pool
+		{
+			Heap m_heap;
+			/** The next older pool, or null. */
+			Pool * m_prev;
+			/** The next newer pool, or null. */
+			Pool * m_next;
+			/** How many allocations in a row skipped this pool while it was empty. */
+			size_t m_idle;
+
+			Pool(
+				size_t capacity,
+				HeapMode mode,
+				HeapMemory memory):
+				m_heap(capacity, mode, memory),
+				m_prev(nullptr),
+				m_next(nullptr),
+				m_idle(0)
+			{
+			}
+		};
+
+		GrowableHeap::GrowableHeap():
+			m_first(nullptr),
+			m_last(nullptr),
+			m_pools(0),
+			m_pool_size(0),
+			m_mode(HeapMode::Segregated),
+			m_memory(HeapMemory::Pages)
+		{
+		}
+
+		GrowableHeap::GrowableHeap(
+			size_t pool_size,
+			HeapMode mode,
+			HeapMemory memory):
+			m_first(nullptr),
+			m_last(nullptr),
+			m_pools(0),
+			m_pool_size(0),
+			m_mode(mode),
+			m_memory(memory)
+		{
+			create(pool_size, mode, memory);
+		}
+
+		GrowableHeap::~GrowableHeap()
+		{
+			dealloc();
+		}
+
+		void GrowableHeap::create(
+			size_t pool_size,
+			HeapMode mode,
+			HeapMemory memory)
+		{
+			RE_DBG_ASSERT(!exists()
+				&& "Tried to allocate GrowableHeap that is already allocated.");
+
+			m_pool_size = pool_size;
+			m_mode = mode;
+			m_memory = memory;
+
+			grow(0);
+		}
+
+		void GrowableHeap::dealloc()
+		{
+			while(Pool * const pool = m_first)
+			{
+				m_first = pool->m_next;
+				pool->~Pool();
+				std::free(pool);
+			}
+
+			m_last = nullptr;
+			m_pools = 0;
+		}
+
+		size_t GrowableHeap::capacity() const
+		{
+			size_t capacity = 0;
+			for(Pool const * it = m_first; it; it = it->m_next)
+				capacity += it->m_heap.capacity();
+			return capacity;
+		}
+
+		GrowableHeap::Pool * GrowableHeap::grow(size_t size)
+		{
+			size_t capacity = m_last
+				? 2 * m_last->m_heap.capacity()
+				: m_pool_size;
+
+			// leave room for rounding and the Header.
+			size_t const needed = size + 2 * sizeof(Heap::Header);
+			if(capacity < needed)
+				capacity = needed;
+
+			Pool * pool;
+			RE_FATAL_LOG(
+				pool = static_cast<Pool *>(std::malloc(sizeof(Pool))),
+				"util::GrowableHeap allocation");
+			new (pool) Pool(capacity, m_mode, m_memory);
+
+			pool->m_prev = m_last;
+			if(m_last)
+				m_last->m_next = pool;
+			else
+				m_first = pool;
+			m_last = pool;
+			++m_pools;
+
+			return pool;
+		}
+
+		void GrowableHeap::release_last()
+		{
+			Pool * const pool = m_last;
+			RE_DBG_ASSERT(pool != m_first
+				&& !pool->m_heap.used());
+
+			m_last = pool->m_prev;
+			m_last->m_next = nullptr;
+			--m_pools;
+
+			pool->~Pool();
+			std::free(pool);
+		}
+
+		void * GrowableHeap::malloc(size_t size)
+		{
+			return aligned_malloc(size, Heap::block_alignment());
+		}
+
+		void * GrowableHeap::aligned_malloc(size_t size, size_t alignment)
+		{
+			RE_DBG_ASSERT(exists()
+				&& "GrowableHeap is not allocated");
+
+			for(Pool * it = m_first; it; it = it->m_next)
+				if(void * const mem = it->m_heap.aligned_malloc(size, alignment))
+				{
+					if(it != m_last)
+					{	// the newest pool was skipped.
+						if(m_last->m_heap.used())
+							m_last->m_idle = 0;
+						else if(++m_last->m_idle >= k_release_delay)
+							release_last();
+					}
+
+					return mem;
+				}
+
+			// the new pool also needs room for the alignment padding.
+			return grow(size + alignment)->m_heap.aligned_malloc(size, alignment);
+		}
+
+		void GrowableHeap::trim()
+		{
+			while(m_last != m_first && !m_last->m_heap.used())
+				release_last();
+		}
+
+		HeapStats GrowableHeap::stats() const
+		{
+			RE_DBG_ASSERT(exists());
+
+			HeapStats stats;
+			for(Pool const * it = m_first; it; it = it->m_next)
+				stats += it->m_heap.stats();
+
+			// pools failing is how the chain is searched, the GrowableHeap itself does not fail.
+			stats.m_failed_allocations = 0;
+			return stats;
+		}
+	}
+}
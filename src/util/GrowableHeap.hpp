@@ -0,0 +1,87 @@
+#ifndef __re_util_growableheap_hpp_defined
+#define __re_util_growableheap_hpp_defined
+
+#include "../defines.hpp"
+
+#include "Heap.hpp"
+
+namespace re
+{
+	namespace util
+	{
+		/** Heap that grows on demand, by chaining additional pools.
+			Each pool is a Heap, so blocks are freed via `re::free()` or their Header as usual. Allocations are served from the oldest pool that fits, which keeps the newest pools empty for as long as possible. An empty newest pool is returned to the operating system once it was skipped by k_release_delay allocations in a row, or when trim() is called. The first pool is kept until the GrowableHeap is deallocated. */
+		class GrowableHeap
+		{
+			struct Pool;
+
+			/** The oldest pool. */
+			Pool * m_first;
+			/** The newest pool. */
+			Pool * m_last;
+			/** How many pools exist. */
+			size_t m_pools;
+			/** The capacity of the first pool. */
+			size_t m_pool_size;
+			/** How the pools search for holes. */
+			HeapMode m_mode;
+			/** Where the pools get their memory from. */
+			HeapMemory m_memory;
+
+			/** Appends a new pool that can hold a block of the given size. */
+			Pool * grow(size_t size);
+			/** Returns the newest pool to the operating system. */
+			void release_last();
+		public:
+			/** How many allocations in a row may skip an empty newest pool before it is released. */
+			static size_t const k_release_delay = 64;
+
+			/** Unallocated GrowableHeap. */
+			GrowableHeap();
+			/** Creates a GrowableHeap with a single pool.
+			@param[in] pool_size:
+				The capacity of the first pool. Each further pool is twice as large as the one before.
+			@param[in] mode:
+				How the pools search for holes. HeapMode::Segregated is recommended, as pools that cannot serve an allocation are skipped quickly.
+			@param[in] memory:
+				Where the pools get their memory from. */
+			explicit GrowableHeap(
+				size_t pool_size,
+				HeapMode mode = HeapMode::Segregated,
+				HeapMemory memory = HeapMemory::Pages);
+			~GrowableHeap();
+
+			GrowableHeap(GrowableHeap const&) = delete;
+			GrowableHeap &operator=(GrowableHeap const&) = delete;
+
+			/** Allocates the first pool. See the constructor. */
+			void create(
+				size_t pool_size,
+				HeapMode mode = HeapMode::Segregated,
+				HeapMemory memory = HeapMemory::Pages);
+			/** Deallocates all pools. */
+			void dealloc();
+
+			/** Whether the first pool is allocated. */
+			REIL bool exists() const;
+			/** How many pools exist. */
+			REIL size_t pools() const;
+			/** The combined capacity of all pools. */
+			size_t capacity() const;
+
+			/** Allocates memory, adding a pool if none of the existing ones has room. */
+			void * malloc(size_t size);
+			/** Allocates memory that is aligned to the given power of two, adding a pool if none of the existing ones has room. */
+			void * aligned_malloc(size_t size, size_t alignment);
+			/** Returns all empty pools at the end of the chain to the operating system. */
+			void trim();
+
+			/** Collects the combined usage statistics of all pools. */
+			HeapStats stats() const;
+		};
+	}
+}
+
+#include "GrowableHeap.inl"
+
+#endif
@@ -0,0 +1,15 @@
+namespace re
+{
+	namespace util
+	{
+		bool GrowableHeap::exists() const
+		{
+			return m_first;
+		}
+
+		size_t GrowableHeap::pools() const
+		{
+			return m_pools;
+		}
+	}
+}
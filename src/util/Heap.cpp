@@ -1,36 +1,153 @@
 #include "Heap.hpp"
+#include "MultiHeap.hpp"
+#include "PageMemory.hpp"
 #include "Error.hpp"
 
 #include <memory>
 #include <cstring>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace re
 {
+	namespace
+	{
+		/** Whether the singleton MultiHeap is used by `re::malloc()`: only a concurrent one is thread-safe. */
+		REIL bool concurrent(util::MultiHeap const& shared)
+		{
+			return shared.exists() && shared.mode() == util::MultiHeapMode::Concurrent;
+		}
+	}
+
+	void * malloc(size_t size)
+	{
+#ifdef RE_HEAP_TRACE
+		util::AllocationTrace::Scope trace;
+#endif
+		util::MultiHeap &shared = singleton<util::MultiHeap>();
+		util::Heap &heap = singleton<util::Heap>();
+		void * const mem = concurrent(shared)
+			? shared.malloc(size)
+			: heap.exists()
+				? heap.malloc(size)
+				: util::Heap::system_malloc(size, alignof(std::max_align_t));
+#ifdef RE_HEAP_TRACE
+		trace.malloc(mem, size, alignof(std::max_align_t));
+#endif
+		return mem;
+	}
+
+	void * aligned_malloc(size_t size, size_t alignment)
+	{
+#ifdef RE_HEAP_TRACE
+		util::AllocationTrace::Scope trace;
+#endif
+		util::MultiHeap &shared = singleton<util::MultiHeap>();
+		util::Heap &heap = singleton<util::Heap>();
+		void * const mem = concurrent(shared)
+			? shared.aligned_malloc(size, alignment)
+			: heap.exists()
+				? heap.aligned_malloc(size, alignment)
+				: util::Heap::system_malloc(size, alignment);
+#ifdef RE_HEAP_TRACE
+		trace.malloc(mem, size, alignment);
+#endif
+		return mem;
+	}
+
 	namespace util
 	{
+		namespace
+		{
+			/** Returns the index of the lowest set bit. */
+			REIL size_t lowest_bit(std::uint64_t mask)
+			{
+				RE_DBG_ASSERT(mask);
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward64(&index, mask);
+				return index;
+#else
+				return __builtin_ctzll(mask);
+#endif
+			}
+
+			/** Returns the index of the highest set bit. */
+			REIL size_t highest_bit(std::uint64_t mask)
+			{
+				RE_DBG_ASSERT(mask);
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanReverse64(&index, mask);
+				return index;
+#else
+				return 63 - __builtin_clzll(mask);
+#endif
+			}
+
+			/** Frees blocks from `Heap::system_malloc()`, which keep their allocation in the `m_next` field. */
+			void system_release(BlockOwner &, Heap::Header * header)
+			{
+				std::free(header->m_next);
+			}
+
+			BlockOwner s_system = { &system_release };
+
+			/** The byte size that is mapped for a Heap with the given capacity. */
+			size_t mapped_size(size_t capacity, HeapMemory memory)
+			{
+				size_t const page = (memory == HeapMemory::HugePages)
+					? huge_page_size()
+					: page_size();
+				return (capacity + page - 1) / page * page;
+			}
+		}
+
 		Heap::Heap():
 			m_pool(0),
+			m_allocation(nullptr),
 			m_capacity(0),
+			m_used(0),
+			m_peak(0),
+			m_blocks(0),
+			m_failed(0),
 			m_first(nullptr),
-			m_last(nullptr)
+			m_last(nullptr),
+			m_mode(HeapMode::FirstFit),
+			m_memory(HeapMemory::Malloc),
+			m_small_mask(0),
+			m_large(nullptr),
+			m_multi(nullptr)
 		{
 		}
 
 
-		Heap::Heap(size_t capacity) :
+		Heap::Heap(
+			size_t capacity,
+			HeapMode mode,
+			HeapMemory memory) :
 			m_pool(0),
+			m_allocation(nullptr),
 			m_capacity(0),
+			m_used(0),
+			m_peak(0),
+			m_blocks(0),
+			m_failed(0),
 			m_first(nullptr),
-			m_last(nullptr)
+			m_last(nullptr),
+			m_mode(mode),
+			m_memory(memory),
+			m_small_mask(0),
+			m_large(nullptr),
+			m_multi(nullptr)
 		{
-			create(capacity);
+			create(capacity, mode, memory);
 		}
 
 		Heap::Heap(Heap && move) :
-			m_pool(move.m_pool),
-			m_capacity(move.m_capacity),
-			m_first(move.m_first),
-			m_last(move.m_last)
+			Heap((Heap const&) move)
 		{
 			move.invalidate();
 		}
@@ -44,6 +161,8 @@ namespace re
 
 			*this = (Heap const&) move;
 			move.invalidate();
+
+			return *this;
 		}
 
 		Heap::~Heap()
@@ -52,13 +171,51 @@ namespace re
 		}
 
 		void * Heap::malloc(size_t size)
+		{
+			return aligned_malloc(size, block_alignment());
+		}
+
+		void * Heap::aligned_malloc(size_t size, size_t alignment)
 		{
 			RE_DBG_ASSERT(exists()
 				&& "heap is not allocated");
+			RE_DBG_ASSERT(alignment && !(alignment & (alignment - 1))
+				&& "alignment must be a power of two.");
+
+#ifdef RE_HEAP_TRACE
+			AllocationTrace::Scope trace;
+			size_t const requested = size;
+#endif
+			size = round_size(size);
+
+			void * const mem = (m_mode == HeapMode::Segregated)
+				? malloc_segregated(size, alignment)
+				: (alignment <= block_alignment())
+					? malloc_first_fit(size)
+					: malloc_first_fit_aligned(size, alignment);
+
+			if(!mem)
+			{
+				++m_failed;
+				return nullptr;
+			}
 
-			if(size_t const rest = size % sizeof(Header))
-				size += sizeof(Header) - rest;
+			if((m_used += size + sizeof(Header)) > m_peak)
+				m_peak = m_used;
+			++m_blocks;
+			++m_allocations[HeapStats::size_class(size)];
+#ifdef RE_HEAP_TAGS
+			get_header(mem)->m_tag = nullptr;
+#endif
+#ifdef RE_HEAP_TRACE
+			trace.malloc(mem, requested, alignment);
+#endif
+
+			return mem;
+		}
 
+		void * Heap::malloc_first_fit(size_t size)
+		{
 			size_t const hole_needed = size + sizeof(Header);
 
 			if(!m_first)
@@ -84,11 +241,12 @@ namespace re
 				return m_first+1;
 			}
 
-			if(uintptr_t(m_first) - uintptr_t(m_pool+1) >= hole_needed)
+			if(uintptr_t(m_first) - uintptr_t(m_pool) >= hole_needed)
 			{	// gap at the beginning?
 				validate_header(m_first);
 
 				m_pool->m_next = m_first;
+				m_pool->m_prev = nullptr;
 				m_first->m_prev = m_pool;
 				m_first = m_pool;
 				m_first->m_heap = this;
@@ -142,7 +300,7 @@ namespace re
 					header->m_next = it->m_header->m_next;
 					it->m_header->m_next = header;
 					header->m_next->m_prev = header;
-					it->m_header->m_size = size;
+					header->m_size = size;
 #ifdef RE_HEAP_DEBUG
 					header->m_magic = heap_magic;
 #endif
@@ -163,77 +321,264 @@ namespace re
 			return nullptr;
 		}
 
-		bool Heap::Header::resize(size_t size)
+		void * Heap::system_malloc(size_t size, size_t alignment)
 		{
-			RE_DBG_ASSERT(m_heap);
-			m_heap->validate_header(this);
+			RE_DBG_ASSERT(alignment && !(alignment & (alignment - 1))
+				&& "alignment must be a power of two.");
 
-			if(this == m_heap->m_last)
-			{
-				uintptr_t mem = uintptr_t(this + 1);
-				uintptr_t end = m_heap->end();
+			if(alignment < block_alignment())
+				alignment = block_alignment();
 
-				if(end-mem >= size)
-				{
-					m_size = size;
-					return true;
-				}
-			} else if(capacity() >= size)
+			void * const allocation = std::malloc(sizeof(Header) + size + alignment - 1);
+			if(!allocation)
+				return nullptr;
+
+			// the Header is placed right before the aligned block.
+			uintptr_t const mem = (uintptr_t(allocation) + sizeof(Header) + alignment - 1)
+				& ~uintptr_t(alignment - 1);
+			Header * const header = get_header(reinterpret_cast<void *>(mem));
+
+			owned_block(header, s_system, size);
+			header->m_next = static_cast<Header *>(allocation);
+			return header + 1;
+		}
+
+		void * Heap::owned_block(
+			Header * header,
+			BlockOwner &owner,
+			size_t size)
+		{
+#ifdef RE_HEAP_DEBUG
+			header->m_magic = heap_magic;
+#endif
+			header->m_owner = &owner;
+			header->m_heap = nullptr;
+			header->m_size = size;
+			header->m_next = nullptr;
+#ifdef RE_HEAP_TAGS
+			header->m_tag = nullptr;
+#endif
+
+			return header + 1;
+		}
+
+		Heap::Header * Heap::link_block(
+			uintptr_t address,
+			Header * prev,
+			Header * next,
+			size_t size)
+		{
+			Header * const header = reinterpret_cast<Header *>(address);
+#ifdef RE_HEAP_DEBUG
+			header->m_magic = heap_magic;
+#endif
+			header->m_prev = prev;
+			header->m_heap = this;
+			header->m_size = size;
+			header->m_next = next;
+
+			if(prev)
+				prev->m_next = header;
+			else
+				m_first = header;
+
+			if(next)
+				next->m_prev = header;
+			else
+				m_last = header;
+
+			validate_header(header);
+			return header;
+		}
+
+		void * Heap::malloc_first_fit_aligned(size_t size, size_t alignment)
+		{
+			// visit every hole, as the padding needed depends on the address.
+			Header * prev = nullptr;
+			Header * next = m_first;
+			for(;;)
 			{
-				m_size = size;
-				return true;
+				uintptr_t const at = aligned_header(hole_begin(prev), alignment);
+				if(at + sizeof(Header) + size <= hole_end(next))
+					return link_block(at, prev, next, size) + 1;
+
+				if(!next)
+					return nullptr;
+
+				prev = next;
+				next = next->m_next;
 			}
+		}
+
+		bool Heap::Header::resize(size_t size)
+		{
+			if(!m_heap)
+				return false;
 
-			return false;
+			if(m_heap->m_multi)
+				return m_heap->m_multi->resize(this, size);
+			else
+				return resize_local(size);
 		}
 
-		void * Heap::Header::realloc(size_t size)
+		bool Heap::Header::resize_local(size_t size)
 		{
 			RE_DBG_ASSERT(m_heap);
 			m_heap->validate_header(this);
 
+#ifdef RE_HEAP_TRACE
+			AllocationTrace::Scope trace;
+			size_t const requested = size;
+#endif
+			size = round_size(size);
+
+			uintptr_t const mem = uintptr_t(this + 1);
+			uintptr_t const hole_end = m_heap->hole_end(m_next);
+
+			if(hole_end - mem < size)
+				return false;
+
+			if((m_heap->m_used += size - m_size) > m_heap->m_peak)
+				m_heap->m_peak = m_heap->m_used;
+
+			if(m_heap->m_mode == HeapMode::Segregated)
+			{	// the hole after this block changes its size.
+				m_heap->unindex_hole(end(), hole_end);
+				m_size = size;
+				m_heap->index_hole(end(), hole_end);
+			} else
+				m_size = size;
+
+#ifdef RE_HEAP_TRACE
+			trace.resize(this + 1, requested, true);
+#endif
+			return true;
+		}
+
+		void * Heap::Header::realloc(size_t size)
+		{
 			if(resize(size))
 				return this + 1;
 
-			void * const moved = m_heap->malloc(size);
-			std::memcpy(moved, this + 1, m_size);
+			void * const moved = !m_heap
+				? system_malloc(size, alignof(std::max_align_t))
+				: m_heap->m_multi
+					? m_heap->m_multi->malloc(size)
+					: m_heap->malloc(size);
+			if(!moved)
+				return nullptr;
+
+			std::memcpy(moved, this + 1, m_size < size ? m_size : size);
 			free();
 			return moved;
 		}
 
 		void Heap::Header::free()
+		{
+			if(!m_heap)
+			{	// not from a Heap.
+#ifdef RE_HEAP_DEBUG
+				RE_ASSERT(m_magic == heap_magic);
+#endif
+				m_owner->m_release(*m_owner, this);
+				return;
+			}
+
+			if(m_heap->m_multi)
+				m_heap->m_multi->free(this);
+			else
+				free_local();
+		}
+
+		void Heap::Header::free_local()
 		{
 			RE_DBG_ASSERT(m_heap);
 			m_heap->validate_header(this);
 
+#ifdef RE_HEAP_TRACE
+			AllocationTrace::Scope trace;
+			trace.free(this + 1);
+#endif
+
+			Heap * const heap = m_heap;
+			heap->m_used -= m_size + sizeof(Header);
+			--heap->m_blocks;
+
+			uintptr_t const begin = heap->hole_begin(m_prev);
+			uintptr_t const end = heap->hole_end(m_next);
+
+			if(heap->m_mode == HeapMode::Segregated)
+			{	// the holes around this block are merged into one.
+				heap->unindex_hole(begin, uintptr_t(this));
+				heap->unindex_hole(this->end(), end);
+			}
+
 			if(m_prev)
 				m_prev->m_next = m_next;
 			else
-				m_heap->m_first = m_next;
+				heap->m_first = m_next;
 
 			if(m_next)
 				m_next->m_prev = m_prev;
 			else
-				m_heap->m_last = m_prev;
+				heap->m_last = m_prev;
+
+			if(heap->m_mode == HeapMode::Segregated)
+				heap->index_hole(begin, end);
 		}
 
-		void Heap::create(size_t capacity)
+		void Heap::create(
+			size_t capacity,
+			HeapMode mode,
+			HeapMemory memory)
 		{
-			/** capacity must be multiple of sizeof(Header). */
-			if(capacity & (sizeof(Header)-1))
-				capacity = (capacity + sizeof(Header)) & ~(sizeof(Header)-1);
-
 			RE_DBG_ASSERT(!exists()
 				&& "Tried to allocate heap that is already allocated.");
 
-			RE_FATAL_LOG(
-				m_pool = static_cast<Header *>(std::malloc(capacity)),
-				"util::Heap allocation"
-			);
+			if(memory == HeapMemory::Malloc)
+			{
+				/** capacity must be multiple of sizeof(Header). */
+				capacity = round_size(capacity);
+
+				RE_FATAL_LOG(
+					m_allocation = std::malloc(capacity + k_cache_line - 1),
+					"util::Heap allocation"
+				);
+				m_pool = reinterpret_cast<Header *>(
+					(uintptr_t(m_allocation) + k_cache_line - 1) & ~uintptr_t(k_cache_line - 1));
+			} else
+			{
+				// use all of the mapped pages.
+				size_t const mapped = mapped_size(capacity, memory);
+				capacity = mapped - mapped % sizeof(Header);
+
+				RE_FATAL_LOG(
+					m_pool = static_cast<Header *>(map_pages(
+						mapped,
+						memory == HeapMemory::HugePages)),
+					"util::Heap page mapping"
+				);
+			}
+
+			m_memory = memory;
 
 			m_capacity = capacity;
+			m_used = 0;
+			m_peak = 0;
+			m_blocks = 0;
+			for(size_t i = 0; i < HeapStats::k_classes; i++)
+				m_allocations[i] = 0;
+			m_failed = 0;
 			m_first = nullptr;
 			m_last = nullptr;
+			m_mode = mode;
+			m_small_mask = 0;
+			for(size_t i = 0; i < k_small_classes; i++)
+				m_small[i] = nullptr;
+			m_large = nullptr;
+
+			if(m_mode == HeapMode::Segregated)
+				index_hole(uintptr_t(m_pool), end());
 		}
 
 		void Heap::dealloc()
@@ -243,14 +588,295 @@ namespace re
 				RE_DBG_ASSERT(!used()
 					&& "Tried to dealloc heap that is still used.");
 
-				std::free(static_cast<void*>(m_pool));
+				if(m_memory == HeapMemory::Malloc)
+					std::free(m_allocation);
+				else
+					unmap_pages(m_pool, mapped_size(m_capacity, m_memory));
 				invalidate();
 			}
 		}
 
+		size_t Heap::largest_hole() const
+		{
+			RE_DBG_ASSERT(exists());
+
+			if(m_mode == HeapMode::Segregated)
+			{
+				if(Hole const * it = m_large)
+				{
+					while(it->m_link[1])
+						it = it->m_link[1];
+					return it->m_size;
+				}
+
+				if(m_small_mask)
+					return (highest_bit(m_small_mask) + 2) * sizeof(Header);
+
+				// untracked holes are too small to be of use.
+				return 0;
+			}
+
+			if(!m_first)
+				return m_capacity;
+
+			size_t largest = end() - m_last->end();
+			if(uintptr_t(m_first) - uintptr_t(m_pool) > largest)
+				largest = uintptr_t(m_first) - uintptr_t(m_pool);
+
+			for(Header const * it = m_first; it->m_next; it = it->m_next)
+				if(it->hole() > largest)
+					largest = it->hole();
+
+			return largest;
+		}
+
+		float Heap::fragmentation() const
+		{
+			size_t const free = free_bytes();
+			return free
+				? 1.f - float(largest_hole()) / float(free)
+				: 0.f;
+		}
+
+		HeapStats Heap::stats() const
+		{
+			RE_DBG_ASSERT(exists());
+
+			HeapStats stats;
+			stats.m_capacity = m_capacity;
+			stats.m_live_blocks = m_blocks;
+			stats.m_used_bytes = m_used;
+			stats.m_live_bytes = m_used - m_blocks * sizeof(Header);
+			stats.m_peak_bytes = m_peak;
+			stats.m_free_bytes = free_bytes();
+			for(size_t i = 0; i < HeapStats::k_classes; i++)
+				stats.m_allocations[i] = m_allocations[i];
+			stats.m_failed_allocations = m_failed;
+
+			// the holes are the gaps between the blocks.
+			Header const * prev = nullptr;
+			Header const * next = m_first;
+			for(;;)
+			{
+				if(size_t const hole = hole_end(next) - hole_begin(prev))
+				{
+					++stats.m_holes;
+					++stats.m_hole_histogram[HeapStats::size_class(hole)];
+					if(hole > stats.m_largest_hole)
+						stats.m_largest_hole = hole;
+				}
+
+				if(!next)
+					break;
+
+				prev = next;
+				next = next->m_next;
+			}
+
+			return stats;
+		}
+
+		size_t Heap::report_leaks(LogFile &log) const
+		{
+			RE_DBG_ASSERT(exists());
+
+			for(Header const * it = m_first; it; it = it->m_next)
+			{
+#ifdef RE_HEAP_TAGS
+				char const * const site = it->m_tag ? it->m_tag : "untagged";
+#else
+				char const * const site = "untagged";
+#endif
+				log.writefln("heap: live block at %p, %zu bytes, allocated at %s.",
+					static_cast<void const *>(it + 1),
+					it->m_size,
+					site);
+			}
+
+			return m_blocks;
+		}
+
 		void Heap::invalidate()
 		{
 			m_pool = 0;
 		}
+
+		void * Heap::malloc_segregated(size_t size, size_t alignment)
+		{
+			// any hole of this size has a suitably aligned address.
+			size_t const padding = (alignment > block_alignment())
+				? (alignment / block_alignment() - 1) * sizeof(Header)
+				: 0;
+			size_t const hole_needed = size + sizeof(Header) + padding;
+
+			Hole * const hole = find_hole(hole_needed);
+			if(!hole)
+				return nullptr;
+
+			uintptr_t const begin = uintptr_t(hole);
+			uintptr_t const end = begin + hole->m_size;
+			unindex_hole(begin, end);
+
+			// the block after the hole knows the block before the hole.
+			Header * const next = (end == this->end())
+				? nullptr
+				: reinterpret_cast<Header *>(end);
+			Header * const prev = next
+				? next->m_prev
+				: m_last;
+
+			uintptr_t const at = padding
+				? aligned_header(begin, alignment)
+				: begin;
+			Header * const header = link_block(at, prev, next, size);
+
+			// keep the padding and the rest of the hole.
+			index_hole(begin, at);
+			index_hole(header->end(), end);
+
+			return header + 1;
+		}
+
+		void Heap::index_hole(uintptr_t begin, uintptr_t end)
+		{
+			size_t const size = end - begin;
+			if(size < 2 * sizeof(Header))
+				return;
+
+			Hole * const hole = reinterpret_cast<Hole *>(begin);
+			hole->m_size = size;
+
+			size_t const size_class = size / sizeof(Header) - 2;
+			if(size_class < k_small_classes)
+			{
+				hole->m_link[0] = nullptr;
+				hole->m_link[1] = m_small[size_class];
+				if(hole->m_link[1])
+					hole->m_link[1]->m_link[0] = hole;
+				else
+					m_small_mask |= std::uint64_t(1) << size_class;
+				m_small[size_class] = hole;
+			} else
+			{
+				hole->m_link[0] = hole->m_link[1] = nullptr;
+				m_large = index_insert(m_large, hole);
+			}
+		}
+
+		void Heap::unindex_hole(uintptr_t begin, uintptr_t end)
+		{
+			size_t const size = end - begin;
+			if(size < 2 * sizeof(Header))
+				return;
+
+			Hole * const hole = reinterpret_cast<Hole *>(begin);
+			RE_DBG_ASSERT(hole->m_size == size
+				&& "hole index is corrupted.");
+
+			size_t const size_class = size / sizeof(Header) - 2;
+			if(size_class < k_small_classes)
+			{
+				if(hole->m_link[0])
+					hole->m_link[0]->m_link[1] = hole->m_link[1];
+				else if(!(m_small[size_class] = hole->m_link[1]))
+					m_small_mask &= ~(std::uint64_t(1) << size_class);
+
+				if(hole->m_link[1])
+					hole->m_link[1]->m_link[0] = hole->m_link[0];
+			} else
+				m_large = index_erase(m_large, hole);
+		}
+
+		Heap::Hole * Heap::find_hole(size_t size) const
+		{
+			size_t const size_class = (size < 2 * sizeof(Header))
+				? 0
+				: size / sizeof(Header) - 2;
+
+			if(size_class < k_small_classes)
+			{
+				// all holes in a free list have the same size, so the first non-empty list is the best fit.
+				if(std::uint64_t const mask = m_small_mask & (~std::uint64_t(0) << size_class))
+					return m_small[lowest_bit(mask)];
+			}
+
+			// smallest large hole that fits, the lowest address wins among equal sizes.
+			Hole * best = nullptr;
+			for(Hole * it = m_large; it;)
+				if(it->m_size >= size)
+				{
+					best = it;
+					it = it->m_link[0];
+				} else
+					it = it->m_link[1];
+
+			return best;
+		}
+
+		namespace
+		{
+			/** Holes in the index are ordered by size, then address. */
+			template<class Hole>
+			REIL bool hole_less(Hole const * a, Hole const * b)
+			{
+				return a->m_size < b->m_size
+					|| (a->m_size == b->m_size && a < b);
+			}
+
+			/** The index is a treap, the priority is a hash of the hole address. */
+			REIL size_t hole_priority(void const * hole)
+			{
+				uintptr_t const key = uintptr_t(hole) / sizeof(void *);
+				return size_t((key ^ (key >> 16)) * uintptr_t(0x9e3779b97f4a7c15ull));
+			}
+		}
+
+		Heap::Hole * Heap::index_insert(Hole * root, Hole * hole)
+		{
+			if(!root)
+				return hole;
+
+			bool const dir = hole_less(root, hole);
+			Hole * const child = root->m_link[dir] = index_insert(root->m_link[dir], hole);
+
+			if(hole_priority(child) <= hole_priority(root))
+				return root;
+
+			// rotate the child up.
+			root->m_link[dir] = child->m_link[!dir];
+			child->m_link[!dir] = root;
+			return child;
+		}
+
+		Heap::Hole * Heap::index_erase(Hole * root, Hole * hole)
+		{
+			RE_DBG_ASSERT(root
+				&& "hole is not in the index.");
+
+			if(root == hole)
+				return index_join(hole->m_link[0], hole->m_link[1]);
+
+			bool const dir = hole_less(root, hole);
+			root->m_link[dir] = index_erase(root->m_link[dir], hole);
+			return root;
+		}
+
+		Heap::Hole * Heap::index_join(Hole * less, Hole * greater)
+		{
+			if(!less)
+				return greater;
+			if(!greater)
+				return less;
+
+			if(hole_priority(less) > hole_priority(greater))
+			{
+				less->m_link[1] = index_join(less->m_link[1], greater);
+				return less;
+			} else
+			{
+				greater->m_link[0] = index_join(less, greater->m_link[0]);
+				return greater;
+			}
+		}
 	}
 }
\ No newline at end of file
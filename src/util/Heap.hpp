@@ -3,6 +3,9 @@
 
 #include "../defines.hpp"
 #include "../base_types.hpp"
+#include "HeapStats.hpp"
+
+#include <cstdint>
 
 #ifdef RE_DEBUG
 /** Define this to prevent the heap checks from being performed. */
@@ -12,17 +15,43 @@
 #endif
 #endif
 
+#ifdef RE_HEAP_TAGS
+#define __RE_HEAP_TAG_LINE(LINE) #LINE
+#define __RE_HEAP_TAG_SITE(LINE) __FILE__ ":" __RE_HEAP_TAG_LINE(LINE)
+/** Tags a block allocated from a Heap with the current source location, which is shown in leak reports.
+	Only has an effect if RE_HEAP_TAGS is defined, which adds a pointer to every Header. */
+#define RE_HEAP_TAG(mem) ::re::util::Heap::tag((mem), __RE_HEAP_TAG_SITE(__LINE__))
+#else
+/** Only has an effect if RE_HEAP_TAGS is defined. */
+#define RE_HEAP_TAG(mem) (mem)
+#endif
+
+/* Define RE_HEAP_TRACE to compile the recording hooks of AllocationTrace into the heap functions. */
+#ifdef RE_HEAP_TRACE
+#include "AllocationTrace.hpp"
+#endif
+
 namespace re
 {
-	REIL void * malloc(size_t size);
+	/** The assumed cache line size.
+		Data that is accessed by SIMD instructions or by several threads should be aligned to it. */
+	static size_t const k_cache_line = 64;
+
+	/** Allocates from the singleton MultiHeap if it is allocated in MultiHeapMode::Concurrent, otherwise from the singleton Heap. If neither is allocated, allocates from the C heap.
+		The memory is aligned to at least `alignof(std::max_align_t)`. */
+	void * malloc(size_t size);
+	/** Like `re::malloc()`, but the memory is aligned to the given power of two. */
+	void * aligned_malloc(size_t size, size_t alignment);
 	REIL void free(void const * mem);
 	REIL bool resize(void const * memory, size_t size);
 	REIL void * realloc(void const * memory, size_t size);
 
 	template<class T, class ... Args>
+	/** Allocates and constructs an instance, aligned to `alignof(T)`. */
 	REIL T * alloc(Args && ...);
 
 	template<class T>
+	/** Allocates and default-constructs an array, aligned to `alignof(T)`. */
 	REIL T * array_alloc(size_t count);
 
 	template<class T>
@@ -33,10 +62,37 @@ namespace re
 
 	namespace util
 	{
+		class MultiHeap;
+		struct BlockOwner;
+
+		/** Selects how a Heap searches for a hole to place a memory block in. */
+		enum class HeapMode
+		{
+			/** Walks the allocated blocks from both ends and takes the first hole that fits.
+				Needs no bookkeeping, but allocation time grows linearly with the block count. */
+			FirstFit,
+			/** Keeps the holes in per-size-class free lists for small sizes, and in a size-ordered index for larger sizes.
+				Takes the smallest hole that fits (best fit), which keeps large holes intact for longer. Freed blocks are merged with their neighbouring holes immediately.
+				Allocating and freeing take constant or logarithmic time, regardless of how many blocks are allocated. */
+			RE_LAST(Segregated)
+		};
+
+		/** Selects where a Heap gets its memory from. */
+		enum class HeapMemory
+		{
+			/** Allocates the memory with `std::malloc`. */
+			Malloc,
+			/** Maps the memory directly from the operating system, so it is returned to it when the Heap is deallocated. */
+			Pages,
+			/** Like HeapMemory::Pages, but backed by huge pages where possible, which reduces TLB misses on large data.
+				The capacity is rounded up to a multiple of the huge page size. */
+			RE_LAST(HugePages)
+		};
+
 		/** Custom Heap class.
-			The Heap, once allocated, cannot be resized, except via deallocating and reallocating. */
+			The Heap, once allocated, cannot be resized, except via deallocating and reallocating. See GrowableHeap for a heap that grows on demand. */
 		class Heap
-		{
+		{	friend class MultiHeap;
 #ifdef RE_HEAP_DEBUG
 			/** 0xfeffefee for 32 bit, 0xbabbabaafeffefee for 64 bit. */
 			static size_t const heap_magic = ((size_t(0xbabbabaa) << 32) | size_t(0xfeffefee));
@@ -44,14 +100,45 @@ namespace re
 public:
 			struct Header;
 private:
-			/** The allocated memory of the Heap. */
+			struct Hole;
+
+			/** How many exact size classes are kept in free lists in HeapMode::Segregated.
+				Class `i` holds holes of `i+2` Header sizes, larger holes go into the size-ordered index. */
+			static size_t const k_small_classes = 64;
+
+			/** The allocated memory of the Heap, aligned to k_cache_line. */
 			Header * m_pool;
+			/** For HeapMemory::Malloc, the allocation that contains the pool. */
+			void * m_allocation;
 			/** The capacity of the heap. */
 			size_t m_capacity;
+			/** The bytes occupied by blocks, including their Headers. */
+			size_t m_used;
+			/** The highest value of `m_used` so far. */
+			size_t m_peak;
+			/** How many blocks are allocated. */
+			size_t m_blocks;
+			/** How many blocks were allocated so far, per HeapStats size class. */
+			size_t m_allocations[HeapStats::k_classes];
+			/** How many allocations failed so far. */
+			size_t m_failed;
 			/** The first allocated memory block of the Heap. */
 			Header * m_first;
 			/** The last allocated memory block of the Heap. */
 			Header * m_last;
+			/** How holes are searched. */
+			HeapMode m_mode;
+			/** Where the memory comes from. */
+			HeapMemory m_memory;
+			/** In HeapMode::Segregated, bit `i` is set if `m_small[i]` is not empty. */
+			std::uint64_t m_small_mask;
+			/** In HeapMode::Segregated, the free lists of the small size classes. */
+			Hole * m_small[k_small_classes];
+			/** In HeapMode::Segregated, the root of the size-ordered index of large holes. */
+			Hole * m_large;
+			/** If this Heap belongs to a concurrent MultiHeap, that MultiHeap, otherwise null.
+				Freeing and resizing blocks is then routed through the MultiHeap. */
+			MultiHeap * m_multi;
 
 			/** The first address that is outside the Heap. */
 			REIL uintptr_t end() const;
@@ -61,7 +148,10 @@ private:
 			/** Unallocated Heap. */
 			Heap();
 			/** Heap with given capacity. */
-			explicit Heap(size_t capacity);
+			explicit Heap(
+				size_t capacity,
+				HeapMode mode = HeapMode::FirstFit,
+				HeapMemory memory = HeapMemory::Malloc);
 			Heap(Heap &&);
 			Heap &operator=(Heap &&);
 			~Heap();
@@ -73,18 +163,39 @@ private:
 			bool resize(void const * mem, size_t size);
 			/** If the memory cannot be resized, it will be copied to a newly allocated destination. */
 			void * realloc(void const * mem, size_t size);
-			/** Allocates memory. */
+			/** Allocates memory, aligned to `block_alignment()`. */
 			void * malloc(size_t size);
+			/** Allocates memory that is aligned to the given power of two.
+				Leading padding needed for alignment is left as a hole. */
+			void * aligned_malloc(size_t size, size_t alignment);
+			/** The alignment that every block has. */
+			static RECX size_t block_alignment();
+			/** Allocates a block from the C heap, for when no Heap is allocated.
+				The block has no Heap, but can be freed and reallocated like any other block. */
+			static void * system_malloc(size_t size, size_t alignment);
+			/** Places a Header for a block that does not belong to a Heap.
+			@param[in] header:
+				Where to place the Header, right before the block.
+			@param[in] owner:
+				Releases the block when it is freed.
+			@param[in] size:
+				The byte size of the block.
+			@return
+				The block. */
+			static void * owned_block(
+				Header * header,
+				BlockOwner &owner,
+				size_t size);
 
 			template<class T, class ... Args>
-			/** Allocates and constructs an instance of the requested type.
+			/** Allocates and constructs an instance of the requested type, aligned to `alignof(T)`.
 			@param[in] args:
 				The arguments to be used when constructing the allocated instance. */
 			REIL T * alloc(Args && ... args);
 
 			template<class T>
-			/** Allocates and constructs an array of the requested type and size.
-				Each object in the array will be default constructed.
+			/** Allocates and constructs an array of the requested type and size, aligned to `alignof(T)`.
+				Each object in the array will be default constructed. If the block has room for more elements than requested, they are constructed as well, as `array_dealloc()` derives the element count from the block size.
 			@parmam[in] size:
 				The element count of the array.
 			@return
@@ -95,9 +206,40 @@ private:
 			REIL bool exists() const;
 			/** Whether there are allocated blocks within the Heap. */
 			REIL bool used() const;
+			/** How the Heap searches for holes. */
+			REIL HeapMode mode() const;
+			/** The byte size of the Heap's memory. */
+			REIL size_t capacity() const;
+
+			/** The bytes that are not occupied by blocks or their Headers. */
+			REIL size_t free_bytes() const;
+			/** The byte size of the largest hole, including the room for a Header.
+				The largest block that can currently be allocated is `sizeof(Header)` smaller. */
+			size_t largest_hole() const;
+			/** How fragmented the free memory is.
+			@return
+				0 if all free memory is in a single hole, approaching 1 the more it is split up. */
+			float fragmentation() const;
+			/** Collects the usage statistics of the Heap.
+				This walks all blocks, so it should not be called in hot paths. */
+			HeapStats stats() const;
+			/** Writes all live blocks to the given log, with their tags if RE_HEAP_TAGS is defined.
+				Meant to be called before deallocating the Heap, to find leaked blocks.
+			@return
+				How many blocks are live. */
+			size_t report_leaks(LogFile &log) const;
+
+			template<class T>
+			/** Tags a block with its allocation site. Use RE_HEAP_TAG instead.
+			@return
+				`mem`. */
+			static REIL T * tag(T * mem, char const * site);
 
 			/** Allocates the Heap. */
-			void create(size_t capcity);
+			void create(
+				size_t capcity,
+				HeapMode mode = HeapMode::FirstFit,
+				HeapMemory memory = HeapMemory::Malloc);
 			/** Deallocates the Heap. */
 			void dealloc();
 
@@ -108,25 +250,42 @@ private:
 			/** In RE_HEAP_DEBUG, validates the header and its pointers. */
 			REIL void validate_header(Header const * header) const;
 
-			/** The Header structure that describes a block of allocated memory. */
-			struct Header
+			/** The Header structure that describes a block of allocated memory.
+				It is aligned so that blocks are suitable for SIMD data. */
+			struct alignas(16) Header
 			{
 #ifdef RE_HEAP_DEBUG
 				size_t m_magic;
 #endif
-				/** The previous Header, or null if none. */
-				Header * m_prev;
+				union
+				{
+					/** The previous Header, or null if none. */
+					Header * m_prev;
+					/** For blocks without Heap, what releases them. */
+					BlockOwner * m_owner;
+				};
 				/** The heap this Header belongs to.
-					This is used to allow the existence of multiple Heaps, where the deleter function does not have to know what heap a memory block is allocated from. */
+					This is used to allow the existence of multiple Heaps, where the deleter function does not have to know what heap a memory block is allocated from. Null for blocks from `owned_block()`. */
 				Heap * m_heap;
 				/** The bytes allocated in this header. */
 				size_t m_size;
 				/** The next used header. */
 				Header * m_next;
+#ifdef RE_HEAP_TAGS
+				/** Where the block was allocated, or null if not tagged. */
+				char const * m_tag;
+#endif
 
+				/** Frees the block, via the owning MultiHeap if there is one. */
 				void free();
+				/** Resizes the block in place, via the owning MultiHeap if there is one. */
 				bool resize(size_t size);
+				/** Resizes the block, or moves it if it cannot be resized in place. */
 				void * realloc(size_t size);
+				/** Frees the block in its Heap, without synchronisation. */
+				void free_local();
+				/** Resizes the block in its Heap, without synchronisation. */
+				bool resize_local(size_t size);
 				/** The capacity of the memory block. */
 				REIL size_t capacity() const;
 				/** The size of the hole between this one and the next one. */
@@ -135,12 +294,65 @@ private:
 			};
 
 		private:
+			/** A hole that is tracked in HeapMode::Segregated.
+				It is stored in-place at the beginning of the hole, so only holes that can fit at least a Header and one more Header size of memory are tracked. Smaller holes are reclaimed once a neighbouring block is freed. */
+			struct Hole
+			{
+				/** The byte size of the hole. */
+				size_t m_size;
+				/** In a free list, the previous and next hole.
+					In the size-ordered index, the smaller and greater child. */
+				Hole * m_link[2];
+			};
+
 			/** Invalidates the Heap (for moving). */
 			void invalidate();
 
+			/** Rounds the given size up to a multiple of the Header size. */
+			static RECX size_t round_size(size_t size);
+			/** The address of the hole that follows the given block, or the beginning of the Heap, if null. */
+			REIL uintptr_t hole_begin(Header const * prev) const;
+			/** The address that ends the hole before the given block, or the end of the Heap, if null. */
+			REIL uintptr_t hole_end(Header const * next) const;
+
+			/** Tracks the hole between `begin` and `end`, if it is big enough. */
+			void index_hole(uintptr_t begin, uintptr_t end);
+			/** Stops tracking the hole between `begin` and `end`, if it was tracked. */
+			void unindex_hole(uintptr_t begin, uintptr_t end);
+			/** Finds the smallest tracked hole of at least the given size.
+			@return
+				The hole, or null if there is none. */
+			Hole * find_hole(size_t size) const;
+			/** The first Header address at or after `begin` whose block is aligned to the given power of two. */
+			static REIL uintptr_t aligned_header(uintptr_t begin, size_t alignment);
+			/** Places a new block at the given address, between two neighbouring blocks. */
+			Header * link_block(uintptr_t address, Header * prev, Header * next, size_t size);
+
+			/** Allocates memory in HeapMode::FirstFit. */
+			void * malloc_first_fit(size_t size);
+			/** Allocates aligned memory in HeapMode::FirstFit. */
+			void * malloc_first_fit_aligned(size_t size, size_t alignment);
+			/** Allocates aligned memory in HeapMode::Segregated. */
+			void * malloc_segregated(size_t size, size_t alignment);
+
+			/** Inserts a hole into the size-ordered index. */
+			static Hole * index_insert(Hole * root, Hole * hole);
+			/** Removes a hole from the size-ordered index. */
+			static Hole * index_erase(Hole * root, Hole * hole);
+			/** Joins two index subtrees, where all holes in `less` are smaller than the ones in `greater`. */
+			static Hole * index_join(Hole * less, Hole * greater);
+
 			Heap(Heap const&) = default;
 			Heap &operator=(Heap const&) = default;
 		};
+
+		/** Releases blocks that do not belong to a Heap, such as the slots of an ObjectPool.
+			Such blocks have a Header without Heap, so they are freed via `re::free()` like any other block. */
+		struct BlockOwner
+		{
+			/** Releases the block of the given Header. */
+			void (*m_release)(BlockOwner &owner, Heap::Header * header);
+		};
 	}
 }
 
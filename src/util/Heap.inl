@@ -6,18 +6,16 @@
 namespace re
 {
 
-	void * malloc(size_t size)
-	{
-		return singleton<util::Heap>().malloc(size);
-	}
-
 	void free(void const * mem)
 	{
 		RE_DBG_ASSERT(mem);
 
-		util::Heap::Header * header = util::Heap::get_header(mem);
-		header->m_heap->validate_header(header);
-		header->free();
+#ifdef RE_HEAP_TRACE
+		util::AllocationTrace::Scope trace;
+		trace.free(mem);
+#endif
+		// the header is validated once its Heap is safe to access.
+		util::Heap::get_header(mem)->free();
 	}
 
 	bool resize(void const * mem, size_t size)
@@ -25,9 +23,14 @@ namespace re
 		RE_DBG_ASSERT(mem);
 		RE_DBG_ASSERT(size);
 
-		util::Heap::Header * header = util::Heap::get_header(mem);
-		header->m_heap->validate_header(header);
-		return header->resize(size);
+#ifdef RE_HEAP_TRACE
+		util::AllocationTrace::Scope trace;
+		bool const resized = util::Heap::get_header(mem)->resize(size);
+		trace.resize(mem, size, resized);
+		return resized;
+#else
+		return util::Heap::get_header(mem)->resize(size);
+#endif
 	}
 
 	void * realloc(void const * mem, size_t size)
@@ -36,23 +39,48 @@ namespace re
 			return malloc(size);
 		else
 		{
-			util::Heap::Header * header = util::Heap::get_header(mem);
-			header->m_heap->validate_header(header);
-			return header->realloc(size);
+#ifdef RE_HEAP_TRACE
+			util::AllocationTrace::Scope trace;
+			trace.release(mem);
+			void * const moved = util::Heap::get_header(mem)->realloc(size);
+			trace.realloc(mem, moved, size);
+			return moved;
+#else
+			return util::Heap::get_header(mem)->realloc(size);
+#endif
 		}
 	}
 
 	template<class T, class ... Args>
 	T * alloc(Args && ... args)
 	{
-		return singleton<util::Heap>().alloc<T>(
-			std::forward<Args>(args)...);
+		T * const instance = static_cast<T*>(aligned_malloc(sizeof(T), alignof(T)));
+		return instance
+			? new (instance) T(std::forward<Args>(args)...)
+			: nullptr;
+	}
+
+	namespace detail
+	{
+		template<class T>
+		/** Default-constructs as many elements as fit into the block, so that array_dealloc can derive the element count from the block size. */
+		REIL T * construct_array(void * block)
+		{
+			if(!block)
+				return nullptr;
+
+			T * const array = static_cast<T *>(block);
+			size_t const count = util::Heap::get_header(block)->m_size / sizeof(T);
+			for(size_t i = 0; i < count; i++)
+				new (&array[i]) T();
+			return array;
+		}
 	}
 
 	template<class T>
 	T * array_alloc(size_t size)
 	{
-		return singleton<util::Heap>().array_alloc<T>(size);
+		return detail::construct_array<T>(aligned_malloc(sizeof(T) * size, alignof(T)));
 	}
 
 	template<class T>
@@ -62,7 +90,8 @@ namespace re
 			&& "Tried to delete null pointer.");
 
 		ptr->~T();
-		free(ptr);
+		// qualified, so that argument-dependent lookup cannot pick `::free()`.
+		re::free(ptr);
 	}
 
 	template<class T>
@@ -71,17 +100,10 @@ namespace re
 		RE_DBG_ASSERT(ptr
 			&& "Tried to delete null pointer.");
 
-		util::Heap::Header * const header = util::Heap::get_header(ptr);
-		RE_DBG_ASSERT(header->m_heap);
-		header->m_heap->validate_header(header);
-
-		RE_DBG_ASSERT(header->m_size % sizeof(T) == 0
-			&& "Could not determine array size.");
-
-		size_t const count = header->m_size / sizeof(T);
+		size_t const count = util::Heap::get_header(ptr)->m_size / sizeof(T);
 		for(size_t i = 0; i < count; i++)
 			ptr[i].~T();
-		free(ptr);
+		re::free(ptr);
 	}
 
 	namespace util
@@ -130,7 +152,7 @@ namespace re
 		template<class T, class ... Args>
 		T * Heap::alloc(Args && ... args)
 		{
-			T * const instance = static_cast<T*>(malloc(sizeof(T)));
+			T * const instance = static_cast<T*>(aligned_malloc(sizeof(T), alignof(T)));
 			return instance
 				? new (instance) T(std::forward<Args>(args)...)
 				: nullptr;
@@ -139,10 +161,7 @@ namespace re
 		template<class T>
 		T * Heap::array_alloc(size_t size)
 		{
-			T * const array = static_cast<T*>(malloc(sizeof(T) * size));
-			return array
-				? new (array) T[size]
-				: nullptr;
+			return re::detail::construct_array<T>(aligned_malloc(sizeof(T) * size, alignof(T)));
 		}
 
 		bool Heap::exists() const
@@ -155,6 +174,69 @@ namespace re
 			return exists() && m_first;
 		}
 
+		HeapMode Heap::mode() const
+		{
+			return m_mode;
+		}
+
+		template<class T>
+		T * Heap::tag(T * mem, char const * site)
+		{
+#ifdef RE_HEAP_TAGS
+			if(mem)
+				get_header(mem)->m_tag = site;
+#else
+			(void) site;
+#endif
+			return mem;
+		}
+
+		size_t Heap::capacity() const
+		{
+			return m_capacity;
+		}
+
+		size_t Heap::free_bytes() const
+		{
+			return m_capacity - m_used;
+		}
+
+		RECX size_t Heap::round_size(size_t size)
+		{
+			return size % sizeof(Header)
+				? size + sizeof(Header) - size % sizeof(Header)
+				: size;
+		}
+
+		RECX size_t Heap::block_alignment()
+		{
+			// the pool is aligned to a cache line, so blocks have the alignment of the Header size.
+			return (sizeof(Header) & (~sizeof(Header) + 1)) < k_cache_line
+				? (sizeof(Header) & (~sizeof(Header) + 1))
+				: k_cache_line;
+		}
+
+		uintptr_t Heap::aligned_header(uintptr_t begin, size_t alignment)
+		{
+			while((begin + sizeof(Header)) & (alignment - 1))
+				begin += sizeof(Header);
+			return begin;
+		}
+
+		uintptr_t Heap::hole_begin(Header const * prev) const
+		{
+			return prev
+				? prev->end()
+				: uintptr_t(m_pool);
+		}
+
+		uintptr_t Heap::hole_end(Header const * next) const
+		{
+			return next
+				? uintptr_t(next)
+				: end();
+		}
+
 		REIL size_t Heap::Header::capacity() const
 		{
 			return m_size + hole();
@@ -0,0 +1,144 @@
+#include "HeapStats.hpp"
+#include "../LogFile.hpp"
+
+#include <cstdio>
+
+namespace re
+{
+	namespace util
+	{
+		namespace
+		{
+			/** How many leading entries of a histogram are needed to show all non-zero ones. */
+			size_t used_classes(size_t const * histogram)
+			{
+				size_t count = HeapStats::k_classes;
+				while(count && !histogram[count-1])
+					--count;
+				return count;
+			}
+
+			/** Appends a histogram as JSON array. */
+			void append_json(std::string &out, size_t const * histogram)
+			{
+				out += '[';
+				for(size_t i = 0, count = used_classes(histogram); i < count; i++)
+				{
+					if(i)
+						out += ',';
+					out += std::to_string(histogram[i]);
+				}
+				out += ']';
+			}
+
+			/** Writes the non-zero entries of a histogram to the log, one line each. */
+			void log_histogram(LogFile &log, char const * name, size_t const * histogram)
+			{
+				for(size_t i = 0; i < HeapStats::k_classes; i++)
+					if(histogram[i])
+						log.writefln("  %s [%zu, %zu): %zu",
+							name,
+							i ? size_t(1) << i : size_t(0),
+							size_t(1) << (i+1),
+							histogram[i]);
+			}
+		}
+
+		HeapStats::HeapStats():
+			m_capacity(0),
+			m_live_bytes(0),
+			m_live_blocks(0),
+			m_used_bytes(0),
+			m_peak_bytes(0),
+			m_free_bytes(0),
+			m_largest_hole(0),
+			m_holes(0),
+			m_failed_allocations(0)
+		{
+			for(size_t i = 0; i < k_classes; i++)
+				m_hole_histogram[i] = m_allocations[i] = 0;
+		}
+
+		HeapStats &HeapStats::operator+=(HeapStats const& other)
+		{
+			m_capacity += other.m_capacity;
+			m_live_bytes += other.m_live_bytes;
+			m_live_blocks += other.m_live_blocks;
+			m_used_bytes += other.m_used_bytes;
+			m_peak_bytes += other.m_peak_bytes;
+			m_free_bytes += other.m_free_bytes;
+			if(other.m_largest_hole > m_largest_hole)
+				m_largest_hole = other.m_largest_hole;
+			m_holes += other.m_holes;
+			for(size_t i = 0; i < k_classes; i++)
+			{
+				m_hole_histogram[i] += other.m_hole_histogram[i];
+				m_allocations[i] += other.m_allocations[i];
+			}
+			m_failed_allocations += other.m_failed_allocations;
+
+			return *this;
+		}
+
+		size_t HeapStats::size_class(size_t size)
+		{
+			size_t size_class = 0;
+			while((size >>= 1) && size_class < k_classes - 1)
+				++size_class;
+			return size_class;
+		}
+
+		float HeapStats::fragmentation() const
+		{
+			return m_free_bytes
+				? 1.f - float(m_largest_hole) / float(m_free_bytes)
+				: 0.f;
+		}
+
+		void HeapStats::log(LogFile &log) const
+		{
+			log.writefln("heap: %zu of %zu bytes used (peak %zu), %zu live blocks with %zu bytes.",
+				m_used_bytes,
+				m_capacity,
+				m_peak_bytes,
+				m_live_blocks,
+				m_live_bytes);
+			log.writefln("heap: %zu free bytes in %zu holes, largest %zu, fragmentation %.3f, %zu failed allocations.",
+				m_free_bytes,
+				m_holes,
+				m_largest_hole,
+				fragmentation(),
+				m_failed_allocations);
+			log_histogram(log, "holes", m_hole_histogram);
+			log_histogram(log, "allocations", m_allocations);
+		}
+
+		std::string HeapStats::json() const
+		{
+			char buffer[512];
+			std::snprintf(buffer, sizeof(buffer),
+				"{\"capacity\":%zu,\"live_bytes\":%zu,\"live_blocks\":%zu,"
+				"\"used_bytes\":%zu,\"peak_bytes\":%zu,\"free_bytes\":%zu,"
+				"\"largest_hole\":%zu,\"holes\":%zu,\"fragmentation\":%.4f,"
+				"\"failed_allocations\":%zu,\"hole_histogram\":",
+				m_capacity,
+				m_live_bytes,
+				m_live_blocks,
+				m_used_bytes,
+				m_peak_bytes,
+				m_free_bytes,
+				m_largest_hole,
+				m_holes,
+				fragmentation(),
+				m_failed_allocations);
+
+			std::string out(buffer);
+			append_json(out, m_hole_histogram);
+			out += ",\"allocations\":";
+			append_json(out, m_allocations);
+			out += '}';
+
+			return out;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef __re_util_heapstats_hpp_defined
+#define __re_util_heapstats_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+#include <string>
+
+namespace re
+{
+	class LogFile;
+
+	namespace util
+	{
+		/** A snapshot of the usage of a Heap or MultiHeap, for sizing heaps from real workloads.
+			Sizes are grouped into power-of-two classes: class `i` holds the sizes in `[2^i, 2^(i+1))`, class 0 also holds 0, and the last class holds everything above. */
+		struct HeapStats
+		{
+			/** How many size classes are distinguished. */
+			static size_t const k_classes = 32;
+
+			/** The byte size of the heap memory. */
+			size_t m_capacity;
+			/** The bytes allocated to live blocks, without their Headers. */
+			size_t m_live_bytes;
+			/** How many blocks are live. */
+			size_t m_live_blocks;
+			/** The bytes occupied by live blocks, including their Headers. */
+			size_t m_used_bytes;
+			/** The highest `m_used_bytes` so far. For a MultiHeap, the sum of the individual heaps' values. */
+			size_t m_peak_bytes;
+			/** The bytes not occupied by blocks or their Headers. */
+			size_t m_free_bytes;
+			/** The byte size of the largest hole, including the room for a Header. */
+			size_t m_largest_hole;
+			/** How many holes there are. */
+			size_t m_holes;
+			/** How many holes there are per size class. */
+			size_t m_hole_histogram[k_classes];
+			/** How many blocks were allocated so far per size class. */
+			size_t m_allocations[k_classes];
+			/** How many allocations failed so far. */
+			size_t m_failed_allocations;
+
+			/** Empty statistics. */
+			HeapStats();
+
+			/** Combines the statistics of another heap into these. */
+			HeapStats &operator+=(HeapStats const& other);
+
+			/** The size class of the given size. */
+			static size_t size_class(size_t size);
+
+			/** How fragmented the free memory is.
+			@return
+				0 if all free memory is in a single hole, approaching 1 the more it is split up. */
+			float fragmentation() const;
+
+			/** Writes the statistics to the given log. */
+			void log(LogFile &log) const;
+			/** The statistics as a JSON object. Histograms are arrays indexed by size class, without trailing zeros. */
+			std::string json() const;
+		};
+	}
+}
+
+#endif
@@ -1,34 +1,431 @@
 #include "MultiHeap.hpp"
-#include "NotNull.hpp"
+#include "Error.hpp"
+
+#include <atomic>
+#include <thread>
+#include <cstdlib>
 
 namespace re
 {
 	namespace util
 	{
+		namespace
+		{
+			/** Hands out the thread indices used for heap affinity. */
+			std::atomic<size_t> s_thread_counter(0);
+
+			/** The index of the calling thread. */
+			size_t thread_index()
+			{
+				thread_local size_t const index = s_thread_counter++;
+				return index;
+			}
+
+			/** Free blocks in caches and remote free lists are linked through their first bytes. */
+			REIL Heap::Header *& next_block(Heap::Header * header)
+			{
+				return *reinterpret_cast<Heap::Header **>(header + 1);
+			}
+		}
+
+		/** Synchronises the access to a heap of a concurrent MultiHeap.
+			The lock and remote list are written by every thread that uses the heap, so the Arena fills a cache line, which it does not share with the Arenas of other heaps. */
+		struct alignas(k_cache_line) MultiHeap::Arena
+		{
+			/** Whether a thread is using the heap. */
+			std::atomic<bool> m_locked;
+			/** Blocks freed by threads that are not affine to the heap. */
+			std::atomic<Heap::Header *> m_remote;
+
+			Arena():
+				m_locked(false),
+				m_remote(nullptr)
+			{
+			}
+
+			void lock()
+			{
+				while(m_locked.exchange(true, std::memory_order_acquire))
+					std::this_thread::yield();
+			}
+
+			void unlock()
+			{
+				m_locked.store(false, std::memory_order_release);
+			}
+
+			/** Hands a block back to the heap without locking it. */
+			void push_remote(Heap::Header * header)
+			{
+				Heap::Header * head = m_remote.load(std::memory_order_relaxed);
+				do next_block(header) = head;
+				while(!m_remote.compare_exchange_weak(
+					head,
+					header,
+					std::memory_order_release,
+					std::memory_order_relaxed));
+			}
+
+			/** Frees the blocks that were handed back. The Arena must be locked. */
+			void drain()
+			{
+				Heap::Header * it = m_remote.exchange(nullptr, std::memory_order_acquire);
+				while(it)
+				{
+					Heap::Header * const next = next_block(it);
+					it->free_local();
+					it = next;
+				}
+			}
+		};
+
+		/** Keeps recently freed blocks of a thread's affine heap for reuse. */
+		struct MultiHeap::ThreadCache
+		{
+			/** The MultiHeap the cached blocks belong to, or null. */
+			MultiHeap * m_owner;
+			/** The cached blocks, by size in Header sizes minus one. */
+			Heap::Header * m_blocks[k_cache_classes];
+			/** How many blocks are cached per size. */
+			size_t m_count[k_cache_classes];
+
+			ThreadCache():
+				m_owner(nullptr)
+			{
+				for(size_t i = 0; i < k_cache_classes; i++)
+				{
+					m_blocks[i] = nullptr;
+					m_count[i] = 0;
+				}
+			}
+
+			~ThreadCache()
+			{
+				flush();
+			}
+
+			/** Frees all cached blocks and unbinds the cache from its MultiHeap. */
+			void flush()
+			{
+				if(!m_owner)
+					return;
+
+				for(size_t i = 0; i < k_cache_classes; i++)
+				{
+					while(Heap::Header * const header = m_blocks[i])
+					{
+						m_blocks[i] = next_block(header);
+
+						Arena &arena = m_owner->m_arenas[m_owner->heap_index(header)];
+						arena.lock();
+						header->free_local();
+						arena.unlock();
+					}
+					m_count[i] = 0;
+				}
+
+				m_owner = nullptr;
+			}
+		};
+
+		thread_local MultiHeap::ThreadCache MultiHeap::s_cache;
+
+		MultiHeap::MultiHeap():
+			m_heaps(nullptr),
+			m_arenas(nullptr),
+			m_arena_allocation(nullptr),
+			m_count(0),
+			m_counter(0),
+			m_mode(MultiHeapMode::RoundRobin)
+		{
+		}
+
 		MultiHeap::MultiHeap(
 			size_t heaps,
-			size_t size):
-			m_heaps(NotNull<Heap>(re::array_alloc<Heap>(heaps))),
-			m_count(heaps),
-			m_counter(0)
+			size_t size,
+			HeapMode mode,
+			MultiHeapMode distribution):
+			m_heaps(nullptr),
+			m_arenas(nullptr),
+			m_arena_allocation(nullptr),
+			m_count(0),
+			m_counter(0),
+			m_mode(distribution)
+		{
+			create(heaps, size, mode, distribution);
+		}
+
+		MultiHeap::~MultiHeap()
+		{
+			dealloc();
+		}
+
+		void MultiHeap::create(
+			size_t heaps,
+			size_t size,
+			HeapMode mode,
+			MultiHeapMode distribution)
 		{
+			RE_DBG_ASSERT(!exists()
+				&& "Tried to allocate MultiHeap that is already allocated.");
+			RE_DBG_ASSERT(heaps);
+
+			// the heaps must not be allocated from the allocator they implement.
+			RE_FATAL_LOG(
+				m_heaps = static_cast<Heap *>(std::malloc(heaps * sizeof(Heap))),
+				"util::MultiHeap allocation");
 			for(size_t i = 0; i < heaps; i++)
-				new (&m_heaps[i]) Heap(size);
+				new (&m_heaps[i]) Heap(size, mode);
+
+			if(distribution == MultiHeapMode::Concurrent)
+			{
+				static_assert(sizeof(Arena) == k_cache_line,
+					"an Arena must fill exactly one cache line.");
+
+				RE_FATAL_LOG(
+					m_arena_allocation = std::malloc(heaps * sizeof(Arena) + k_cache_line - 1),
+					"util::MultiHeap allocation");
+				m_arenas = reinterpret_cast<Arena *>(
+					(uintptr_t(m_arena_allocation) + k_cache_line - 1) & ~uintptr_t(k_cache_line - 1));
+
+				for(size_t i = 0; i < heaps; i++)
+				{
+					new (&m_arenas[i]) Arena();
+					m_heaps[i].m_multi = this;
+				}
+			}
+
+			m_count = heaps;
+			m_counter = 0;
+			m_mode = distribution;
 		}
 
-		void * MultiHeap::malloc(size_t size)
+		void MultiHeap::dealloc()
 		{
-			size_t const t_counter = m_counter;
-			void * ptr;
-			while(!(ptr = m_heaps[m_counter++].malloc(size)))
+			if(!exists())
+				return;
+
+			if(m_mode == MultiHeapMode::Concurrent)
 			{
-				if(m_counter == m_count)
-					m_counter = 0;
-				if(m_counter == t_counter)
-					return nullptr;
+				if(s_cache.m_owner == this)
+					s_cache.flush();
+
+				for(size_t i = 0; i < m_count; i++)
+				{
+					m_arenas[i].drain();
+					m_arenas[i].~Arena();
+					m_heaps[i].m_multi = nullptr;
+				}
+
+				std::free(m_arena_allocation);
+				m_arena_allocation = nullptr;
+				m_arenas = nullptr;
 			}
 
+			for(size_t i = 0; i < m_count; i++)
+				m_heaps[i].~Heap();
+
+			std::free(m_heaps);
+			m_heaps = nullptr;
+			m_count = 0;
+		}
+
+		void * MultiHeap::malloc_from(size_t heap, size_t size, size_t alignment)
+		{
+			if(m_mode != MultiHeapMode::Concurrent)
+				return m_heaps[heap].aligned_malloc(size, alignment);
+
+			Arena &arena = m_arenas[heap];
+			arena.lock();
+			arena.drain();
+			void * const ptr = m_heaps[heap].aligned_malloc(size, alignment);
+			arena.unlock();
+
 			return ptr;
 		}
+
+		void * MultiHeap::malloc(size_t size)
+		{
+			RE_DBG_ASSERT(exists()
+				&& "MultiHeap is not allocated");
+
+			if(m_mode == MultiHeapMode::RoundRobin)
+			{
+				size_t const t_counter = m_counter;
+				do {
+					void * const ptr = m_heaps[m_counter].malloc(size);
+					if(++m_counter == m_count)
+						m_counter = 0;
+					if(ptr)
+						return ptr;
+				} while(m_counter != t_counter);
+
+				return nullptr;
+			}
+
+			// freed blocks need room for the free list link.
+			size_t const rounded = Heap::round_size(size ? size : 1);
+			size_t const size_class = rounded / sizeof(Heap::Header) - 1;
+
+			ThreadCache &cache = s_cache;
+			if(cache.m_owner == this
+			&& size_class < k_cache_classes
+			&& cache.m_count[size_class])
+			{
+				Heap::Header * const header = cache.m_blocks[size_class];
+				cache.m_blocks[size_class] = next_block(header);
+				--cache.m_count[size_class];
+				return header + 1;
+			}
+
+			size_t const affine = thread_index() % m_count;
+			for(size_t i = 0; i < m_count; i++)
+				if(void * const ptr = malloc_from((affine + i) % m_count, rounded, Heap::block_alignment()))
+					return ptr;
+
+			if(cache.m_owner == this)
+			{	// the cached blocks might leave a big enough hole.
+				cache.flush();
+				return malloc_from(affine, rounded, Heap::block_alignment());
+			}
+
+			return nullptr;
+		}
+
+		void * MultiHeap::aligned_malloc(size_t size, size_t alignment)
+		{
+			RE_DBG_ASSERT(exists()
+				&& "MultiHeap is not allocated");
+
+			if(alignment <= Heap::block_alignment())
+				return malloc(size);
+
+			if(m_mode == MultiHeapMode::RoundRobin)
+			{
+				size_t const t_counter = m_counter;
+				do {
+					void * const ptr = m_heaps[m_counter].aligned_malloc(size, alignment);
+					if(++m_counter == m_count)
+						m_counter = 0;
+					if(ptr)
+						return ptr;
+				} while(m_counter != t_counter);
+
+				return nullptr;
+			}
+
+			// freed blocks need room for the free list link.
+			size_t const rounded = Heap::round_size(size ? size : 1);
+
+			size_t const affine = thread_index() % m_count;
+			for(size_t i = 0; i < m_count; i++)
+				if(void * const ptr = malloc_from((affine + i) % m_count, rounded, alignment))
+					return ptr;
+
+			ThreadCache &cache = s_cache;
+			if(cache.m_owner == this)
+			{	// the cached blocks might leave a big enough hole.
+				cache.flush();
+				return malloc_from(affine, rounded, alignment);
+			}
+
+			return nullptr;
+		}
+
+		void MultiHeap::free(Heap::Header * header)
+		{
+			RE_DBG_ASSERT(header);
+			size_t const heap = heap_index(header);
+
+			if(m_mode != MultiHeapMode::Concurrent)
+			{
+				header->free_local();
+				return;
+			}
+
+			Arena &arena = m_arenas[heap];
+			if(heap != thread_index() % m_count)
+			{	// the affine thread of the heap frees the block later.
+				arena.push_remote(header);
+				return;
+			}
+
+			ThreadCache &cache = s_cache;
+			if(!cache.m_owner)
+				cache.m_owner = this;
+
+			size_t const size_class = header->m_size / sizeof(Heap::Header) - 1;
+			if(cache.m_owner == this
+			&& size_class < k_cache_classes
+			&& cache.m_count[size_class] < k_cache_depth)
+			{
+				next_block(header) = cache.m_blocks[size_class];
+				cache.m_blocks[size_class] = header;
+				++cache.m_count[size_class];
+				return;
+			}
+
+			arena.lock();
+			arena.drain();
+			header->free_local();
+			arena.unlock();
+		}
+
+		HeapStats MultiHeap::stats() const
+		{
+			RE_DBG_ASSERT(exists());
+
+			HeapStats stats;
+			for(size_t i = 0; i < m_count; i++)
+			{
+				if(m_mode == MultiHeapMode::Concurrent)
+					m_arenas[i].lock();
+
+				stats += m_heaps[i].stats();
+
+				if(m_mode == MultiHeapMode::Concurrent)
+					m_arenas[i].unlock();
+			}
+
+			return stats;
+		}
+
+		size_t MultiHeap::report_leaks(LogFile &log) const
+		{
+			RE_DBG_ASSERT(exists());
+
+			size_t blocks = 0;
+			for(size_t i = 0; i < m_count; i++)
+			{
+				if(m_mode == MultiHeapMode::Concurrent)
+					m_arenas[i].lock();
+
+				blocks += m_heaps[i].report_leaks(log);
+
+				if(m_mode == MultiHeapMode::Concurrent)
+					m_arenas[i].unlock();
+			}
+
+			return blocks;
+		}
+
+		bool MultiHeap::resize(Heap::Header * header, size_t size)
+		{
+			RE_DBG_ASSERT(header);
+
+			if(m_mode != MultiHeapMode::Concurrent)
+				return header->resize_local(size);
+
+			// freed blocks need room for the free list link.
+			if(!size)
+				size = 1;
+
+			Arena &arena = m_arenas[heap_index(header)];
+			arena.lock();
+			bool const resized = header->resize_local(size);
+			arena.unlock();
+
+			return resized;
+		}
 	}
-}
\ No newline at end of file
+}
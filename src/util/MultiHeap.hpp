@@ -3,31 +3,112 @@
 
 #include "../defines.hpp"
 
-#include "Pointer.hpp"
 #include "Heap.hpp"
 
 namespace re
 {
 	namespace util
 	{
-		/** Structure for distributing allocations to multiple heaps, which should generally speed up the process of finding a hole. */
+		/** Selects how a MultiHeap distributes allocations to its heaps. */
+		enum class MultiHeapMode
+		{
+			/** Distributes the allocations to the heaps in turns.
+				Must not be used from more than one thread at a time. */
+			RoundRobin,
+			/** Thread-safe mode.
+				Every thread allocates from its own affine heap, and keeps a small cache of recently freed blocks. Blocks freed by a thread other than the affine one are put onto a lock-free list, which the owning heap drains on its next allocation. */
+			RE_LAST(Concurrent)
+		};
+
+		/** Structure for distributing allocations to multiple heaps, which should generally speed up the process of finding a hole.
+			If a MultiHeap in MultiHeapMode::Concurrent is allocated via `singleton<MultiHeap>()`, `re::malloc` uses it instead of the singleton Heap. A singleton MultiHeap in MultiHeapMode::RoundRobin is not thread-safe, and is ignored by `re::malloc`. */
 		class MultiHeap
 		{
-			Auto<Heap[]> m_heaps;
+			struct Arena;
+			struct ThreadCache;
+
+			/** How many block sizes (in Header sizes) are kept in the thread caches. */
+			static size_t const k_cache_classes = 8;
+			/** How many blocks of each size a thread cache holds at most. */
+			static size_t const k_cache_depth = 16;
+
+			/** The thread cache of the current thread. */
+			thread_local static ThreadCache s_cache;
+
+			/** The heaps. */
+			Heap * m_heaps;
+			/** In MultiHeapMode::Concurrent, the synchronisation state of each heap. Each Arena has a cache line of its own, so that threads using different heaps do not contend on it. */
+			Arena * m_arenas;
+			/** The allocation `m_arenas` is aligned within. */
+			void * m_arena_allocation;
+			/** The heap count. */
 			size_t m_count;
+			/** In MultiHeapMode::RoundRobin, the next heap to allocate from. */
 			size_t m_counter;
+			/** How allocations are distributed. */
+			MultiHeapMode m_mode;
 
+			/** Allocates from the given heap, with synchronisation in MultiHeapMode::Concurrent. */
+			void * malloc_from(size_t heap, size_t size, size_t alignment);
+			/** The index of the heap the given block belongs to. */
+			REIL size_t heap_index(Heap::Header const * header) const;
 		public:
+			/** Unallocated MultiHeap. */
+			MultiHeap();
 			/** Constructs a split heap.
 			@param[in] heaps:
 				The heap count.
 			@param[in] size:
-				The individual heap size. */
-			MultiHeap(size_t heaps, size_t size);
+				The individual heap size.
+			@param[in] mode:
+				How the individual heaps search for holes.
+			@param[in] distribution:
+				How the allocations are distributed to the heaps. */
+			MultiHeap(
+				size_t heaps,
+				size_t size,
+				HeapMode mode = HeapMode::FirstFit,
+				MultiHeapMode distribution = MultiHeapMode::RoundRobin);
+			/** Deallocates the heaps.
+				In MultiHeapMode::Concurrent, all threads that used the MultiHeap, except for the calling thread, must have exited before. */
 			~MultiHeap();
 
+			MultiHeap(MultiHeap const&) = delete;
+			MultiHeap &operator=(MultiHeap const&) = delete;
+
+			/** Allocates the heaps. See the constructor. */
+			void create(
+				size_t heaps,
+				size_t size,
+				HeapMode mode = HeapMode::FirstFit,
+				MultiHeapMode distribution = MultiHeapMode::RoundRobin);
+			/** Deallocates the heaps. */
+			void dealloc();
+
+			/** Whether the heaps are allocated. */
+			REIL bool exists() const;
+			/** How allocations are distributed. */
+			REIL MultiHeapMode mode() const;
+
+			/** Collects the combined usage statistics of all heaps.
+				In MultiHeapMode::Concurrent, blocks held in thread caches are counted as live. */
+			HeapStats stats() const;
+			/** Writes all live blocks of all heaps to the given log. See `Heap::report_leaks()`.
+			@return
+				How many blocks are live. */
+			size_t report_leaks(LogFile &log) const;
+
 			/** Allocates */
 			void * malloc(size_t size);
+			/** Allocates memory that is aligned to the given power of two.
+				Over-aligned blocks bypass the thread caches. */
+			void * aligned_malloc(size_t size, size_t alignment);
+			/** Frees a block that was allocated from this MultiHeap.
+				In MultiHeapMode::Concurrent, this is called by `Heap::Header::free()`. */
+			void free(Heap::Header * header);
+			/** Resizes a block that was allocated from this MultiHeap.
+				In MultiHeapMode::Concurrent, this is called by `Heap::Header::resize()`. */
+			bool resize(Heap::Header * header, size_t size);
 
 			template<class T, class ... Args>
 			REIL T * alloc(Args && ... args);
@@ -38,4 +119,6 @@ namespace re
 	}
 }
 
-#endif
\ No newline at end of file
+#include "MultiHeap.inl"
+
+#endif
@@ -0,0 +1,37 @@
+namespace re
+{
+	namespace util
+	{
+		size_t MultiHeap::heap_index(Heap::Header const * header) const
+		{
+			RE_DBG_ASSERT(header->m_heap >= m_heaps
+				&& header->m_heap < m_heaps + m_count);
+			return header->m_heap - m_heaps;
+		}
+
+		bool MultiHeap::exists() const
+		{
+			return m_count != 0;
+		}
+
+		MultiHeapMode MultiHeap::mode() const
+		{
+			return m_mode;
+		}
+
+		template<class T, class ... Args>
+		T * MultiHeap::alloc(Args && ... args)
+		{
+			T * const instance = static_cast<T*>(aligned_malloc(sizeof(T), alignof(T)));
+			return instance
+				? new (instance) T(std::forward<Args>(args)...)
+				: nullptr;
+		}
+
+		template<class T>
+		T * MultiHeap::array_alloc(size_t size)
+		{
+			return re::detail::construct_array<T>(aligned_malloc(sizeof(T) * size, alignof(T)));
+		}
+	}
+}
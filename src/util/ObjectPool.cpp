@@ -0,0 +1,306 @@
+#include "ObjectPool.hpp"
+#include "Error.hpp"
+
+#include <cstdlib>
+#include <thread>
+
+namespace re
+{
+	namespace util
+	{
+		/** A block of slots. The slots follow the Slab. */
+		struct ObjectPoolBase::Slab
+		{
+			/** The next older slab. */
+			Slab * m_next;
+
+			/** The offset of the first slot. */
+			static RECX size_t slots_offset()
+			{
+				return (sizeof(Slab) + alignof(Heap::Header) - 1) / alignof(Heap::Header) * alignof(Heap::Header);
+			}
+
+			/** The Header of the first slot. */
+			Heap::Header * slots()
+			{
+				return reinterpret_cast<Heap::Header *>(uintptr_t(this) + slots_offset());
+			}
+		};
+
+		/** Keeps free slots of a few pools for the current thread. */
+		struct ObjectPoolBase::ThreadCache
+		{
+			struct Entry
+			{
+				/** The pool the cached slots belong to, or null. */
+				ObjectPoolBase * m_owner;
+				/** The cached slots, linked via their Headers. */
+				Heap::Header * m_slots;
+				/** How many slots are cached. */
+				size_t m_count;
+			};
+
+			Entry m_entries[k_cache_pools];
+
+			ThreadCache()
+			{
+				for(Entry &entry : m_entries)
+				{
+					entry.m_owner = nullptr;
+					entry.m_slots = nullptr;
+					entry.m_count = 0;
+				}
+			}
+
+			~ThreadCache()
+			{
+				for(Entry &entry : m_entries)
+					flush(entry);
+			}
+
+			/** The entry of the given pool. Binds a free entry to it if it has none.
+			@return
+				The entry, or null if all entries are bound to other pools. */
+			Entry * find(ObjectPoolBase * pool)
+			{
+				Entry * unbound = nullptr;
+				for(Entry &entry : m_entries)
+					if(entry.m_owner == pool)
+						return &entry;
+					else if(!entry.m_owner && !unbound)
+						unbound = &entry;
+
+				if(unbound)
+					unbound->m_owner = pool;
+				return unbound;
+			}
+
+			/** Returns the cached slots of an entry to their pool, and unbinds the entry. */
+			static void flush(Entry &entry)
+			{
+				if(!entry.m_owner)
+					return;
+
+				ObjectPoolBase &pool = *entry.m_owner;
+				pool.lock();
+				while(Heap::Header * const header = entry.m_slots)
+				{
+					entry.m_slots = header->m_next;
+					pool.put(header);
+				}
+				pool.unlock();
+
+				entry.m_owner = nullptr;
+				entry.m_count = 0;
+			}
+		};
+
+		thread_local ObjectPoolBase::ThreadCache ObjectPoolBase::s_cache;
+
+		ObjectPoolBase::ObjectPoolBase(
+			size_t object_size,
+			ObjectPoolMode mode,
+			size_t slab_slots):
+			BlockOwner{ &release },
+			m_slabs(nullptr),
+			m_free(nullptr),
+			m_batches(nullptr),
+			m_object_size(object_size),
+			// a free slot holds the batch link, even for objects that are smaller.
+			m_slot_size(sizeof(Heap::Header) + ((object_size > sizeof(Heap::Header *) ? object_size : sizeof(Heap::Header *)) + alignof(Heap::Header) - 1) / alignof(Heap::Header) * alignof(Heap::Header)),
+			m_slab_slots(slab_slots ? slab_slots : 1),
+			m_slab_count(0),
+			m_capacity(0),
+			m_available(0),
+			m_mode(mode),
+			m_locked(false)
+		{
+		}
+
+		ObjectPoolBase::~ObjectPoolBase()
+		{
+			flush_cache();
+
+			RE_DBG_ASSERT(!live()
+				&& "Tried to destroy an ObjectPool that is still used.");
+
+			while(Slab * const slab = m_slabs)
+			{
+				m_slabs = slab->m_next;
+				std::free(slab);
+			}
+		}
+
+		void ObjectPoolBase::lock()
+		{
+			if(m_mode == ObjectPoolMode::Concurrent)
+				while(m_locked.exchange(true, std::memory_order_acquire))
+					std::this_thread::yield();
+		}
+
+		void ObjectPoolBase::unlock()
+		{
+			if(m_mode == ObjectPoolMode::Concurrent)
+				m_locked.store(false, std::memory_order_release);
+		}
+
+		void ObjectPoolBase::grow()
+		{
+			size_t slots = m_capacity ? m_capacity : m_slab_slots;
+			if(slots > k_max_slab_slots)
+				slots = k_max_slab_slots;
+
+			Slab * slab;
+			RE_FATAL_LOG(
+				slab = static_cast<Slab *>(std::malloc(Slab::slots_offset() + slots * m_slot_size)),
+				"util::ObjectPool slab allocation");
+			slab->m_next = m_slabs;
+			m_slabs = slab;
+			++m_slab_count;
+
+			// link the slots so that they are handed out in address order.
+			uintptr_t slot = uintptr_t(slab->slots()) + slots * m_slot_size;
+			for(size_t i = slots; i--;)
+			{
+				slot -= m_slot_size;
+				Heap::Header * const header = reinterpret_cast<Heap::Header *>(slot);
+				Heap::owned_block(header, *this, m_object_size);
+				header->m_next = m_free;
+				m_free = header;
+			}
+
+			m_capacity += slots;
+			m_available += slots;
+		}
+
+		Heap::Header * ObjectPoolBase::take()
+		{
+			if(!m_free)
+			{
+				if(m_batches)
+				{	// threads without a cache entry for this pool take single slots, so the batches are split up again.
+					m_free = m_batches;
+					m_batches = next_batch(m_free);
+				} else
+					grow();
+			}
+
+			Heap::Header * const header = m_free;
+			m_free = header->m_next;
+			--m_available;
+			return header;
+		}
+
+		void ObjectPoolBase::put(Heap::Header * header)
+		{
+			header->m_next = m_free;
+			m_free = header;
+			++m_available;
+		}
+
+		void * ObjectPoolBase::malloc()
+		{
+			if(m_mode == ObjectPoolMode::SingleThreaded)
+				return take() + 1;
+
+			ThreadCache::Entry * const entry = s_cache.find(this);
+			if(entry && entry->m_count)
+			{
+				Heap::Header * const header = entry->m_slots;
+				entry->m_slots = header->m_next;
+				--entry->m_count;
+				return header + 1;
+			}
+
+			lock();
+			if(entry && m_batches)
+			{	// refill the cache with a whole batch.
+				Heap::Header * const batch = m_batches;
+				m_batches = next_batch(batch);
+				m_available -= k_batch_size;
+				unlock();
+
+				entry->m_slots = batch->m_next;
+				entry->m_count = k_batch_size - 1;
+				return batch + 1;
+			}
+
+			Heap::Header * const header = take();
+			if(entry && m_free)
+			{	// refill half of the cache from the free list, keeping the order of the slots.
+				Heap::Header * last = m_free;
+				size_t count = 1;
+				for(; count < k_batch_size && last->m_next; count++)
+					last = last->m_next;
+
+				entry->m_slots = m_free;
+				entry->m_count = count;
+				m_free = last->m_next;
+				last->m_next = nullptr;
+				m_available -= count;
+			}
+			unlock();
+
+			return header + 1;
+		}
+
+		void ObjectPoolBase::free(void * slot)
+		{
+			RE_DBG_ASSERT(slot);
+			RE_DBG_ASSERT(Heap::get_header(slot)->m_owner == static_cast<BlockOwner *>(this)
+				&& "slot belongs to another pool.");
+
+			release(*this, Heap::get_header(slot));
+		}
+
+		void ObjectPoolBase::release(BlockOwner &owner, Heap::Header * header)
+		{
+			ObjectPoolBase &pool = static_cast<ObjectPoolBase &>(owner);
+
+			if(pool.m_mode == ObjectPoolMode::SingleThreaded)
+			{
+				pool.put(header);
+				return;
+			}
+
+			ThreadCache::Entry * const entry = s_cache.find(&pool);
+			if(!entry)
+			{
+				pool.lock();
+				pool.put(header);
+				pool.unlock();
+				return;
+			}
+
+			header->m_next = entry->m_slots;
+			entry->m_slots = header;
+			if(++entry->m_count <= k_cache_depth)
+				return;
+
+			// return the most recently freed slots as a batch. They were just touched, so splitting them off is cheap.
+			Heap::Header * const batch = entry->m_slots;
+			Heap::Header * last = batch;
+			for(size_t i = 1; i < k_batch_size; i++)
+				last = last->m_next;
+			entry->m_slots = last->m_next;
+			entry->m_count -= k_batch_size;
+			last->m_next = nullptr;
+
+			pool.lock();
+			next_batch(batch) = pool.m_batches;
+			pool.m_batches = batch;
+			pool.m_available += k_batch_size;
+			pool.unlock();
+		}
+
+		void ObjectPoolBase::flush_cache()
+		{
+			if(m_mode != ObjectPoolMode::Concurrent)
+				return;
+
+			for(ThreadCache::Entry &entry : s_cache.m_entries)
+				if(entry.m_owner == this)
+					ThreadCache::flush(entry);
+		}
+	}
+}
@@ -0,0 +1,152 @@
+#ifndef __re_util_objectpool_hpp_defined
+#define __re_util_objectpool_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+#include "Heap.hpp"
+
+#include <atomic>
+
+namespace re
+{
+	namespace util
+	{
+		/** Selects whether an ObjectPool can be used by multiple threads. */
+		enum class ObjectPoolMode
+		{
+			/** Must not be used from more than one thread at a time. */
+			SingleThreaded,
+			/** Thread-safe mode.
+				Every thread keeps a small cache of free slots, so that the pool is only locked once every few allocations. */
+			RE_LAST(Concurrent)
+		};
+
+		/** The untyped part of ObjectPool, which manages slots of a fixed size.
+			Slots are carved from slabs that are never returned until the pool is destroyed, and freed slots are kept in a free list for reuse.
+			Every slot has a Heap Header that names the pool as its BlockOwner, so slots can be freed via `re::free()`, `re::dealloc()` or an Auto like blocks from a Heap. */
+		class ObjectPoolBase : private BlockOwner
+		{
+			struct Slab;
+			struct ThreadCache;
+
+			/** How many pools a thread cache serves at the same time. */
+			static size_t const k_cache_pools = 4;
+			/** How many free slots a thread cache holds per pool at most. */
+			static size_t const k_cache_depth = 32;
+			/** How many free slots a thread cache exchanges with the pool at once. */
+			static size_t const k_batch_size = k_cache_depth / 2;
+			/** How many slots a slab holds at most. */
+			static size_t const k_max_slab_slots = 64 * 1024;
+
+			/** The thread cache of the current thread. */
+			thread_local static ThreadCache s_cache;
+
+			/** The slabs, newest first. */
+			Slab * m_slabs;
+			/** The free slots. */
+			Heap::Header * m_free;
+			/** In ObjectPoolMode::Concurrent, batches of `k_batch_size` free slots returned by thread caches.
+				The slots of a batch are linked via their Headers, and the batches via the first slot. A thread cache takes a whole batch at once, instead of collecting the slots one by one, which would touch every slot while the pool is locked. */
+			Heap::Header * m_batches;
+			/** The byte size of the objects. */
+			size_t m_object_size;
+			/** The byte size of a slot, including its Header. */
+			size_t m_slot_size;
+			/** How many slots the first slab holds. */
+			size_t m_slab_slots;
+			/** How many slabs exist. */
+			size_t m_slab_count;
+			/** How many slots exist. */
+			size_t m_capacity;
+			/** How many slots are in the free list. */
+			size_t m_available;
+			/** Whether the pool is thread-safe. */
+			ObjectPoolMode m_mode;
+			/** In ObjectPoolMode::Concurrent, whether a thread is using the free list. */
+			std::atomic<bool> m_locked;
+
+			/** Frees a slot, called via `Heap::Header::free()`. */
+			static void release(BlockOwner &owner, Heap::Header * header);
+
+			void lock();
+			void unlock();
+			/** Takes a slot from the free list, adding a slab if it is empty. The pool must be locked. */
+			Heap::Header * take();
+			/** Puts a slot into the free list. The pool must be locked. */
+			void put(Heap::Header * header);
+			/** The link to the next batch, stored in the first slot of a batch. */
+			static REIL Heap::Header *& next_batch(Heap::Header * batch);
+			/** Adds a slab that holds as many slots as all other slabs together. */
+			void grow();
+		public:
+			/** How many slots the first slab holds by default. */
+			static size_t const k_default_slab_slots = 256;
+
+			/** Creates an empty pool. The first slab is allocated on first use.
+			@param[in] object_size:
+				The byte size of the objects.
+			@param[in] mode:
+				Whether the pool is thread-safe.
+			@param[in] slab_slots:
+				How many slots the first slab holds. */
+			ObjectPoolBase(
+				size_t object_size,
+				ObjectPoolMode mode,
+				size_t slab_slots);
+			/** Frees all slabs.
+				All slots must have been freed. In ObjectPoolMode::Concurrent, all threads that used the pool, except for the calling thread, must have exited before. */
+			~ObjectPoolBase();
+
+			ObjectPoolBase(ObjectPoolBase const&) = delete;
+			ObjectPoolBase &operator=(ObjectPoolBase const&) = delete;
+
+			/** Allocates an uninitialised slot. Never returns null. */
+			void * malloc();
+			/** Frees a slot of this pool. Equivalent to `re::free()`. */
+			void free(void * slot);
+			/** Returns the free slots in the calling thread's cache to the pool. */
+			void flush_cache();
+
+			/** Whether the pool is thread-safe. */
+			REIL ObjectPoolMode mode() const;
+			/** The byte size of the objects. */
+			REIL size_t object_size() const;
+			/** How many slots exist. */
+			REIL size_t capacity() const;
+			/** How many slots are allocated, or held in thread caches. */
+			REIL size_t live() const;
+			/** How many slabs were allocated. */
+			REIL size_t slabs() const;
+		};
+
+		template<class T>
+		/** Fixed-size object allocator for large numbers of objects of the same type.
+			Allocating and freeing take constant time, and objects are packed densely into slabs. Objects can be released via `dealloc()`, `re::dealloc()`, or an owning Auto. */
+		class ObjectPool : public ObjectPoolBase
+		{
+			static_assert(alignof(T) <= alignof(Heap::Header),
+				"the type is over-aligned for an ObjectPool.");
+		public:
+			/** Creates an empty pool. The first slab is allocated on first use.
+			@param[in] mode:
+				Whether the pool is thread-safe.
+			@param[in] slab_slots:
+				How many objects the first slab holds. */
+			explicit ObjectPool(
+				ObjectPoolMode mode = ObjectPoolMode::SingleThreaded,
+				size_t slab_slots = k_default_slab_slots);
+
+			template<class ... Args>
+			/** Allocates and constructs an object.
+			@param[in] args:
+				The arguments to be used when constructing the object. */
+			REIL T * alloc(Args && ... args);
+			/** Destroys and frees an object of this pool. */
+			REIL void dealloc(T * object);
+		};
+	}
+}
+
+#include "ObjectPool.inl"
+
+#endif
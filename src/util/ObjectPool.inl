@@ -0,0 +1,64 @@
+#include "../LogFile.hpp"
+
+#include <utility>
+
+namespace re
+{
+	namespace util
+	{
+		ObjectPoolMode ObjectPoolBase::mode() const
+		{
+			return m_mode;
+		}
+
+		size_t ObjectPoolBase::object_size() const
+		{
+			return m_object_size;
+		}
+
+		size_t ObjectPoolBase::capacity() const
+		{
+			return m_capacity;
+		}
+
+		size_t ObjectPoolBase::live() const
+		{
+			return m_capacity - m_available;
+		}
+
+		size_t ObjectPoolBase::slabs() const
+		{
+			return m_slab_count;
+		}
+
+		Heap::Header *& ObjectPoolBase::next_batch(Heap::Header * batch)
+		{
+			return *reinterpret_cast<Heap::Header **>(batch + 1);
+		}
+
+		template<class T>
+		ObjectPool<T>::ObjectPool(
+			ObjectPoolMode mode,
+			size_t slab_slots):
+			ObjectPoolBase(sizeof(T), mode, slab_slots)
+		{
+		}
+
+		template<class T>
+		template<class ... Args>
+		T * ObjectPool<T>::alloc(Args && ... args)
+		{
+			return new (malloc()) T(std::forward<Args>(args)...);
+		}
+
+		template<class T>
+		void ObjectPool<T>::dealloc(T * object)
+		{
+			RE_DBG_ASSERT(object
+				&& "Tried to delete null pointer.");
+
+			object->~T();
+			free(object);
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#include "PageMemory.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace re
+{
+	namespace util
+	{
+		size_t page_size()
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return info.dwPageSize;
+#else
+			return size_t(sysconf(_SC_PAGESIZE));
+#endif
+		}
+
+		size_t huge_page_size()
+		{
+#ifdef _WIN32
+			if(size_t const size = GetLargePageMinimum())
+				return size;
+#endif
+			return 2 * 1024 * 1024;
+		}
+
+		void * map_pages(size_t size, bool huge)
+		{
+#ifdef _WIN32
+			void * memory = nullptr;
+			// large pages need the lock memory privilege, which is rarely granted.
+			if(huge)
+				memory = VirtualAlloc(
+					nullptr,
+					size,
+					MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+					PAGE_READWRITE);
+			if(!memory)
+				memory = VirtualAlloc(
+					nullptr,
+					size,
+					MEM_RESERVE | MEM_COMMIT,
+					PAGE_READWRITE);
+			return memory;
+#else
+			void * memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			// explicit huge pages only exist if the system reserved some.
+			if(huge)
+				memory = mmap(
+					nullptr,
+					size,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+					-1,
+					0);
+#endif
+			if(memory == MAP_FAILED)
+			{
+				memory = mmap(
+					nullptr,
+					size,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS,
+					-1,
+					0);
+
+				if(memory == MAP_FAILED)
+					return nullptr;
+#ifdef MADV_HUGEPAGE
+				if(huge)
+					madvise(memory, size, MADV_HUGEPAGE);
+#endif
+			}
+			return memory;
+#endif
+		}
+
+		void unmap_pages(void * memory, size_t size)
+		{
+#ifdef _WIN32
+			(void) size;
+			VirtualFree(memory, 0, MEM_RELEASE);
+#else
+			munmap(memory, size);
+#endif
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef __re_util_pagememory_hpp_defined
+#define __re_util_pagememory_hpp_defined
+
+#include "../defines.hpp"
+#include "../base_types.hpp"
+
+namespace re
+{
+	namespace util
+	{
+		/** The size of a normal memory page. */
+		size_t page_size();
+		/** The size of a huge memory page. */
+		size_t huge_page_size();
+
+		/** Maps zeroed memory pages directly from the operating system.
+		@param[in] size:
+			The byte size to map, a multiple of `page_size()`, or of `huge_page_size()` if `huge` is set.
+		@param[in] huge:
+			Whether to back the memory with huge pages. Explicit huge pages are tried first, then transparent huge pages, then normal pages.
+		@return
+			The mapped memory, or null. */
+		void * map_pages(size_t size, bool huge);
+		/** Returns pages mapped by `map_pages()` to the operating system.
+		@param[in] size:
+			The size that was passed to `map_pages()`. */
+		void unmap_pages(void * memory, size_t size);
+	}
+}
+
+#endif
@@ -10,30 +10,71 @@ namespace re
 {
 	namespace util
 	{
-		template<class T>
+		template<class T, RefCountPolicy Policy>
+		class Borrowed;
+
+		template<class T, RefCountPolicy Policy = RefCountPolicy::Local>
 		/** Pointer class that deallocates the held pointer after the last object referencing to it is destroyed.
-			This allows copying and moving. */
+			This allows copying and moving. The object and its reference count are stored in a single allocation.
+			By default, the reference count is not thread-safe, so all Shareds referencing an object must be confined to one thread. Use AtomicShared for objects that are referenced from multiple threads. */
 		class Shared
 		{
-			RefCount<T> * m_obj;
+			friend class Borrowed<T, Policy>;
+
+			RefCount<T, Policy> * m_obj;
 
 			void unref();
-			Shared(RefCount<T> & obj);
+			Shared(RefCount<T, Policy> & obj);
 		public:
 			RECX Shared();
 			RECX Shared(nullptr_t);
-			Shared(Shared<T> const&);
-			Shared(Shared<T> &&);
-			Shared &operator=(Shared<T> const&);
-			Shared &operator=(Shared<T> &&);
+			Shared(Shared const&);
+			Shared(Shared &&);
+			Shared &operator=(Shared const&);
+			Shared &operator=(Shared &&);
 			~Shared();
 
 			REIL T* operator->() const;
 			REIL T& operator*() const;
-			RECX operator bool() const;
+			RECX explicit operator bool() const;
+			/** Whether both reference the same object. */
+			RECX bool operator==(Shared const& other) const;
+			RECX bool operator!=(Shared const& other) const;
+
+			/** How many Shareds reference the object, or 0 if null. */
+			REIL size_t count() const;
+			/** A reference to the object that does not change the reference count. */
+			RECX Borrowed<T, Policy> borrow() const;
 
 			template<class ...Args>
-			static Shared<T> alloc(Args && ...);
+			/** Allocates and constructs an object, together with its reference count. */
+			static Shared alloc(Args && ...);
+		};
+
+		template<class T>
+		/** A Shared whose reference count is atomic, for objects that are referenced from multiple threads. */
+		using AtomicShared = Shared<T, RefCountPolicy::Atomic>;
+
+		template<class T, RefCountPolicy Policy = RefCountPolicy::Local>
+		/** Non-owning reference to the object of a Shared, which does not change the reference count.
+			It must not outlive the Shareds that keep the object alive, which makes it suited for getters and parameters in hot paths. Use `share()` to keep the object alive beyond that. */
+		class Borrowed
+		{
+			RefCount<T, Policy> * m_obj;
+		public:
+			RECX Borrowed();
+			RECX Borrowed(nullptr_t);
+			RECX Borrowed(Shared<T, Policy> const& shared);
+
+			REIL T* operator->() const;
+			REIL T& operator*() const;
+			RECX explicit operator bool() const;
+			/** Whether both reference the same object. */
+			RECX bool operator==(Borrowed const& other) const;
+			RECX bool operator!=(Borrowed const& other) const;
+
+			/** A new owning reference to the object. */
+			REIL Shared<T, Policy> share() const;
 		};
 
 		template<class T>
@@ -2,42 +2,42 @@ namespace re
 {
 	namespace util
 	{
-		template<class T>
-		RECX Shared<T>::Shared() :
+		template<class T, RefCountPolicy Policy>
+		RECX Shared<T, Policy>::Shared() :
 			m_obj(nullptr)
 		{
 		}
 
-		template<class T>
-		RECX Shared<T>::Shared(nullptr_t):
+		template<class T, RefCountPolicy Policy>
+		RECX Shared<T, Policy>::Shared(nullptr_t):
 			m_obj(nullptr)
 		{
 		}
 
-		template<class T>
-		Shared<T>::Shared(RefCount<T> & ref):
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy>::Shared(RefCount<T, Policy> & ref):
 			m_obj(&ref)
 		{
 			ref.reference();
 		}
 
-		template<class T>
-		Shared<T>::Shared(Shared<T> const& copy):
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy>::Shared(Shared const& copy):
 			m_obj(copy.m_obj)
 		{
 			if(m_obj)
 				m_obj->reference();
 		}
 
-		template<class T>
-		Shared<T>::Shared(Shared<T> && move):
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy>::Shared(Shared && move):
 			m_obj(move.m_obj)
 		{
 			move.m_obj = nullptr;
 		}
 
-		template<class T>
-		Shared<T> &Shared<T>::operator=(Shared<T> const& copy)
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy> &Shared<T, Policy>::operator=(Shared const& copy)
 		{
 			if(this != &copy && m_obj != copy.m_obj)
 			{
@@ -50,20 +50,21 @@ namespace re
 			return *this;
 		}
 
-		template<class T>
-		Shared<T> &Shared<T>::operator=(Shared<T> && move)
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy> &Shared<T, Policy>::operator=(Shared && move)
 		{
 			if(this != &move)
 			{
 				unref();
 				m_obj = move.m_obj;
+				move.m_obj = nullptr;
 			}
 
 			return *this;
 		}
 
-		template<class T>
-		void Shared<T>::unref()
+		template<class T, RefCountPolicy Policy>
+		void Shared<T, Policy>::unref()
 		{
 			if(m_obj)
 			{
@@ -75,38 +76,119 @@ namespace re
 			}
 		}
 
-		template<class T>
-		Shared<T>::~Shared()
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy>::~Shared()
 		{
 			unref();
 		}
 
-		template<class T>
-		T* Shared<T>::operator->() const
+		template<class T, RefCountPolicy Policy>
+		T* Shared<T, Policy>::operator->() const
 		{
 			return m_obj ? &m_obj->get() : nullptr;
 		}
 
-		template<class T>
-		T& Shared<T>::operator*() const
+		template<class T, RefCountPolicy Policy>
+		T& Shared<T, Policy>::operator*() const
 		{
 			RE_DBG_ASSERT(m_obj != nullptr);
 			return m_obj->get();
 		}
 
-		template<class T>
+		template<class T, RefCountPolicy Policy>
 		template<class ...Args>
-		Shared<T> Shared<T>::alloc(Args && ... args)
+		Shared<T, Policy> Shared<T, Policy>::alloc(Args && ... args)
 		{
-			return *(re::alloc<RefCount<T>>(std::forward<Args>(args)...));
+			return *(re::alloc<RefCount<T, Policy>>(std::forward<Args>(args)...));
 		}
 
-		template<class T>
-		RECX Shared<T>::operator bool() const
+		template<class T, RefCountPolicy Policy>
+		RECX Shared<T, Policy>::operator bool() const
+		{
+			return m_obj != nullptr;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX bool Shared<T, Policy>::operator==(Shared const& other) const
+		{
+			return m_obj == other.m_obj;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX bool Shared<T, Policy>::operator!=(Shared const& other) const
+		{
+			return m_obj != other.m_obj;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		size_t Shared<T, Policy>::count() const
+		{
+			return m_obj ? m_obj->count() : 0;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX Borrowed<T, Policy> Shared<T, Policy>::borrow() const
+		{
+			return Borrowed<T, Policy>(*this);
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX Borrowed<T, Policy>::Borrowed():
+			m_obj(nullptr)
+		{
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX Borrowed<T, Policy>::Borrowed(nullptr_t):
+			m_obj(nullptr)
+		{
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX Borrowed<T, Policy>::Borrowed(Shared<T, Policy> const& shared):
+			m_obj(shared.m_obj)
+		{
+		}
+
+		template<class T, RefCountPolicy Policy>
+		T* Borrowed<T, Policy>::operator->() const
+		{
+			return m_obj ? &m_obj->get() : nullptr;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		T& Borrowed<T, Policy>::operator*() const
+		{
+			RE_DBG_ASSERT(m_obj != nullptr);
+			return m_obj->get();
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX Borrowed<T, Policy>::operator bool() const
 		{
 			return m_obj != nullptr;
 		}
 
+		template<class T, RefCountPolicy Policy>
+		RECX bool Borrowed<T, Policy>::operator==(Borrowed const& other) const
+		{
+			return m_obj == other.m_obj;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX bool Borrowed<T, Policy>::operator!=(Borrowed const& other) const
+		{
+			return m_obj != other.m_obj;
+		}
+
+		template<class T, RefCountPolicy Policy>
+		Shared<T, Policy> Borrowed<T, Policy>::share() const
+		{
+			return m_obj
+				? Shared<T, Policy>(*m_obj)
+				: Shared<T, Policy>();
+		}
+
 		template<class T>
 		Auto<T>::Auto():
 			m_obj(nullptr)
@@ -2,15 +2,62 @@
 #define __re_util_refcount_hpp_defined
 
 #include "../defines.hpp"
+#include "../base_types.hpp"
+
+#include <atomic>
 
 namespace re
 {
 	namespace util
 	{
-		template<class T>
+		/** Selects how a RefCount counts its references. */
+		enum class RefCountPolicy
+		{
+			/** Plain counter. The references must not be copied or destroyed by more than one thread at a time. */
+			Local,
+			/** Atomic counter, for objects that are referenced from multiple threads. */
+			RE_LAST(Atomic)
+		};
+
+		namespace detail
+		{
+			template<RefCountPolicy Policy>
+			/** The reference counter of a RefCount. */
+			class RefCounter;
+
+			template<>
+			class RefCounter<RefCountPolicy::Local>
+			{
+				size_t m_count;
+			public:
+				RECX RefCounter();
+
+				RECX size_t count() const;
+				REIL void reference();
+				REIL size_t unreference();
+			};
+
+			template<>
+			class RefCounter<RefCountPolicy::Atomic>
+			{
+				std::atomic<size_t> m_count;
+			public:
+				REIL RefCounter();
+
+				/** Only reliable while no other thread changes the count. */
+				REIL size_t count() const;
+				/** Adds a reference. Relaxed, as a new reference can only be made from an existing one. */
+				REIL void reference();
+				/** Removes a reference. Acquires and releases, so that all accesses through other references happen before the object is destroyed. */
+				REIL size_t unreference();
+			};
+		}
+
+		template<class T, RefCountPolicy Policy = RefCountPolicy::Local>
+		/** An object and its reference count, stored in a single allocation. */
 		class RefCount
 		{
-			size_t m_count;
+			detail::RefCounter<Policy> m_count;
 			T m_instance;
 		public:
 			template<class ...Args>
@@ -19,7 +66,7 @@ namespace re
 			RECX14 T & get();
 			RECX T const& get() const;
 
-			RECX size_t count() const;
+			REIL size_t count() const;
 
 			REIL void reference();
 			REIL size_t unreference();
@@ -4,40 +4,83 @@ namespace re
 {
 	namespace util
 	{
-		template<class T>
-		RECX14 T &RefCount<T>::get()
+		namespace detail
+		{
+			RECX RefCounter<RefCountPolicy::Local>::RefCounter():
+				m_count(0)
+			{
+			}
+
+			RECX size_t RefCounter<RefCountPolicy::Local>::count() const
+			{
+				return m_count;
+			}
+
+			REIL void RefCounter<RefCountPolicy::Local>::reference()
+			{
+				++m_count;
+			}
+
+			REIL size_t RefCounter<RefCountPolicy::Local>::unreference()
+			{
+				return --m_count;
+			}
+
+			REIL RefCounter<RefCountPolicy::Atomic>::RefCounter():
+				m_count(0)
+			{
+			}
+
+			REIL size_t RefCounter<RefCountPolicy::Atomic>::count() const
+			{
+				return m_count.load(std::memory_order_relaxed);
+			}
+
+			REIL void RefCounter<RefCountPolicy::Atomic>::reference()
+			{
+				m_count.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			REIL size_t RefCounter<RefCountPolicy::Atomic>::unreference()
+			{
+				return m_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+			}
+		}
+
+		template<class T, RefCountPolicy Policy>
+		RECX14 T &RefCount<T, Policy>::get()
 		{
 			return m_instance;
 		}
 
-		template<class T>
-		RECX T const& RefCount<T>::get() const
+		template<class T, RefCountPolicy Policy>
+		RECX T const& RefCount<T, Policy>::get() const
 		{
 			return m_instance;
 		}
 
-		template<class T>
-		RECX size_t RefCount<T>::count() const
+		template<class T, RefCountPolicy Policy>
+		REIL size_t RefCount<T, Policy>::count() const
 		{
-			return m_count;
+			return m_count.count();
 		}
 
-		template<class T>
-		REIL void RefCount<T>::reference()
+		template<class T, RefCountPolicy Policy>
+		REIL void RefCount<T, Policy>::reference()
 		{
-			++m_count;
+			m_count.reference();
 		}
 
-		template<class T>
-		REIL size_t RefCount<T>::unreference()
+		template<class T, RefCountPolicy Policy>
+		REIL size_t RefCount<T, Policy>::unreference()
 		{
-			return --m_count;
+			return m_count.unreference();
 		}
 
-		template<class T>
+		template<class T, RefCountPolicy Policy>
 		template<class ...Args>
-		REIL RefCount<T>::RefCount(Args && ... args):
-			m_count(0),
+		REIL RefCount<T, Policy>::RefCount(Args && ... args):
+			m_count(),
 			m_instance(std::forward<Args>(args)...)
 		{
 		}
@@ -0,0 +1,133 @@
+/** Counts the general-purpose heap allocations of steady-state frames, which should be zero.
+
+	Usage: re_frame_allocations [frames] [nodes]
+
+	A Scene with `nodes` (default 10000) nodes, which uses the flattened transform hierarchy, is drawn for `frames` (default 100) frames after a few warm-up frames. Every frame does the work of the main loop and Renderer::renderQueued() that runs without a GL context:
+		graphics::Window::begin_frame(),
+		moving one in a hundred nodes, and Scene::updateTransforms(),
+		reading every world transformation and queueing a draw per node into a RenderQueue, which is then sorted,
+		and building a list of the visible nodes in a std::vector that allocates from the frame arena.
+	Submitting the draws, Font::compile() and the UI layout models need a GL context, and are not run; they build their scratch data in the frame arena or on the stack.
+	The global operator new is replaced to count the heap allocations, and the chunks the frame arena allocates are counted via util::FrameArena::allocations(). The tool fails if a frame after the warm-up allocates. */
+#include "../src/Scene.hpp"
+#include "../src/RenderQueue.hpp"
+#include "../src/graphics/Window.hpp"
+#include "../src/util/FrameArena.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace re;
+using namespace re::math;
+
+namespace
+{
+	/** How many frames are drawn before counting, to let the containers reach their steady-state capacity. */
+	unsigned const k_warm_up = 3;
+
+	/** How many times operator new was called so far. */
+	size_t g_allocations = 0;
+
+	void build(
+		SceneNode &root,
+		size_t count,
+		std::vector<SceneNode *> &nodes)
+	{
+		nodes.push_back(&root);
+		// a tree of fan-out 10, built breadth first.
+		for(size_t i = 1; i < count; i++)
+		{
+			SceneNode child;
+			child.setPosition(fvec3_t(float(i % 10), float(i / 10 % 10), float(i % 7) - 2));
+			nodes.push_back(nodes[(i - 1) / 10]->addChild(std::move(child)));
+		}
+	}
+}
+
+void * operator new(std::size_t size)
+{
+	++g_allocations;
+	if(void * const memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * memory) noexcept
+{
+	std::free(memory);
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned const frames = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 100;
+	size_t const count = argc > 2 ? size_t(std::strtoull(argv[2], nullptr, 10)) : 10000;
+	if(!frames || !count)
+	{
+		std::fprintf(stderr, "usage: %s [frames] [nodes]\n", argv[0]);
+		return 1;
+	}
+
+	Scene scene;
+	scene.setFlatTransforms(true);
+	std::vector<SceneNode *> nodes;
+	build(scene.getRoot(), count, nodes);
+
+	// the queue only compares the state of the Models, so they need no GL objects.
+	Model const model(nullptr, nullptr, nullptr, nullptr);
+	RenderQueue queue;
+	fmat4x4_t const view_projection = fmat4x4_t::perspective(deg(65), 2, 2, 0.1f, 1000.f);
+	util::FrameArena &arena = util::FrameArena::local();
+
+	size_t warm_up_allocations = 0, steady_allocations = 0, worst_frame = 0;
+	size_t const arena_allocations = arena.allocations();
+	size_t warm_up_chunks = 0;
+	size_t visible_count = 0;
+	for(unsigned frame = 0; frame < k_warm_up + frames; frame++)
+	{
+		size_t const before = g_allocations;
+
+		graphics::Window::begin_frame();
+		for(size_t i = frame % 100; i < nodes.size(); i += 100)
+			nodes[i]->setPosition(nodes[i]->getPosition() + fvec3_t(0, 0.01f, 0));
+		scene.updateTransforms();
+
+		std::vector<uint32_t, util::FrameAllocator<uint32_t>> visible;
+		queue.clear();
+		for(size_t i = 0; i < nodes.size(); i++)
+		{
+			fmat4x4_t const mvp = view_projection * nodes[i]->getWorldTransformation();
+			if(mvp.v3.w > 0)
+			{
+				visible.push_back(uint32_t(i));
+				queue.add(model, mvp);
+			}
+		}
+		queue.sort();
+		visible_count = visible.size();
+
+		size_t const allocations = g_allocations - before;
+		if(frame < k_warm_up)
+		{
+			warm_up_allocations += allocations;
+			warm_up_chunks = arena.allocations() - arena_allocations;
+		} else
+		{
+			steady_allocations += allocations;
+			if(allocations > worst_frame)
+				worst_frame = allocations;
+		}
+	}
+	size_t const steady_chunks = arena.allocations() - arena_allocations - warm_up_chunks;
+
+	std::printf("%zu nodes, %zu drawn per frame, %zu byte frame arena\n", nodes.size(), visible_count, arena.capacity());
+	std::printf("warm-up: %u frames, %zu heap allocations, %zu arena chunks\n", k_warm_up, warm_up_allocations, warm_up_chunks);
+	std::printf("steady:  %u frames, %zu heap allocations (at most %zu per frame), %zu arena chunks\n", frames, steady_allocations, worst_frame, steady_chunks);
+
+	bool const ok = !steady_allocations && !steady_chunks;
+	if(!ok)
+		std::printf("FAILED: steady-state frames allocate\n");
+	return ok ? 0 : 1;
+}
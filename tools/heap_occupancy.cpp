@@ -0,0 +1,132 @@
+/** Measures how the malloc and free latency of a Heap depends on how many blocks it holds.
+
+	Usage: re_heap_occupancy [firstfit|segregated|both] [milliseconds per level]
+
+	For each occupancy level, a Heap is filled with packed blocks, and every other block is freed again, leaving holes that are too small for the measured requests. A few fitting holes are then freed in the middle of the heap. The measured loop allocates and frees short-lived blocks of varying sizes, which have to be placed into the fitting holes, and is repeated until the given time (default 200 ms) has passed.
+	In HeapMode::FirstFit, the latency grows with the block count, as the blocks are walked to find a hole. In HeapMode::Segregated, it should stay flat. The ratio between the slowest and the fastest level is printed per mode. */
+#include "../src/util/Heap.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace re;
+using namespace re::util;
+
+namespace
+{
+	/** The live block counts to measure at. */
+	size_t const k_levels[] = { 1000, 4000, 16000, 64000 };
+	/** How many short-lived blocks are allocated at once. */
+	size_t const k_batch = 8;
+
+	/** Measures the average time of a malloc and free pair, in nanoseconds, or returns a negative value if an allocation failed. */
+	double measure(
+		HeapMode mode,
+		size_t level,
+		std::chrono::steady_clock::duration budget)
+	{
+		// room for the packed small and large blocks, including their Headers.
+		size_t const capacity = level * 2 * (32 + 32) + level * (32 + 320);
+		Heap heap(capacity, mode);
+
+		std::vector<void *> blocks;
+		for(void * block; (block = heap.malloc(blocks.size() % 2 ? 8 : 320));)
+			blocks.push_back(block);
+
+		// holes too small for the measured requests.
+		for(size_t i = 1; i < blocks.size(); i += 2)
+		{
+			re::free(blocks[i]);
+			blocks[i] = nullptr;
+		}
+		// a few fitting holes in the middle.
+		for(size_t i = blocks.size() / 2 & ~size_t(1), hole = 0; hole < k_batch && i < blocks.size(); hole++, i += 2)
+		{
+			re::free(blocks[i]);
+			blocks[i] = nullptr;
+		}
+
+		double result = 0;
+		void * batch[k_batch];
+		size_t iterations = 0;
+		auto const start = std::chrono::steady_clock::now();
+		auto end = start;
+		// the clock is read once per 64 iterations, or per iteration if they are slow.
+		for(size_t check = 1; end - start < budget; end = std::chrono::steady_clock::now())
+		{
+			for(size_t i = 0; i < check; i++, iterations++)
+			{
+				for(void *& block : batch)
+					if(!(block = heap.malloc(64 + (iterations & 63) * 4)))
+						result = -1;
+				for(void * block : batch)
+					if(block)
+						re::free(block);
+			}
+			if(end - start < budget / 64)
+				check = 64;
+		}
+
+		for(void * block : blocks)
+			if(block)
+				re::free(block);
+
+		if(result < 0)
+			return result;
+		return std::chrono::duration<double, std::nano>(end - start).count() / (iterations * k_batch);
+	}
+
+	/** Runs all occupancy levels for a mode, and prints their latencies. */
+	bool run(
+		char const * name,
+		HeapMode mode,
+		std::chrono::steady_clock::duration budget)
+	{
+		double fastest = 0, slowest = 0;
+		for(size_t level : k_levels)
+		{
+			double const ns = measure(mode, level, budget);
+			if(ns < 0)
+			{
+				std::printf("%-10s %6zu blocks: allocation failed\n", name, level);
+				return false;
+			}
+
+			std::printf("%-10s %6zu blocks: %10.1f ns per malloc+free\n", name, level, ns);
+			if(!fastest || ns < fastest)
+				fastest = ns;
+			if(ns > slowest)
+				slowest = ns;
+		}
+		std::printf("%-10s slowest / fastest: %.2f\n", name, slowest / fastest);
+		return true;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	char const * const modes = argc > 1 ? argv[1] : "both";
+	std::chrono::milliseconds const budget(argc > 2
+		? std::strtoll(argv[2], nullptr, 10)
+		: 200);
+
+	bool const first_fit = !std::strcmp(modes, "firstfit") || !std::strcmp(modes, "both");
+	bool const segregated = !std::strcmp(modes, "segregated") || !std::strcmp(modes, "both");
+	if(budget.count() <= 0 || !(first_fit || segregated))
+	{
+		std::fprintf(stderr, "usage: %s [firstfit|segregated|both] [milliseconds per level]\n", argv[0]);
+		return 1;
+	}
+
+	bool ok = true;
+	if(first_fit)
+		ok &= run("FirstFit", HeapMode::FirstFit, budget);
+	if(segregated)
+		ok &= run("Segregated", HeapMode::Segregated, budget);
+
+	return ok ? 0 : 1;
+}
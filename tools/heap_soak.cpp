@@ -0,0 +1,148 @@
+/** Runs a long allocation workload against a Heap, and reports how its largest hole and fragmentation develop.
+
+	Usage: re_heap_soak [firstfit|segregated] [cycles] [heap MiB]
+
+	Every cycle either allocates a block or frees a random live block. The live block count oscillates between 3000 and 4500 every 50000 cycles. Sizes are mixed: 70% are 8-128 bytes, 25% are 128 bytes to 2 KiB, and 5% are 4-68 KiB. The heap defaults to 16 MiB and the run to 4 million cycles.
+	The largest hole and the fragmentation are sampled every 1000 cycles and printed eight times during the run. At the end, all blocks are freed, and the heap has to consist of a single hole again, otherwise the tool fails. */
+#include "../src/util/Heap.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace re;
+using namespace re::util;
+
+namespace
+{
+	/** How many cycles pass between two samples. */
+	size_t const k_sample = 1000;
+	/** How often the state is printed during the run. */
+	size_t const k_reports = 8;
+
+	/** A deterministic linear congruential generator, so that runs are comparable. */
+	class Random
+	{
+		std::uint32_t m_state;
+	public:
+		Random():
+			m_state(12345)
+		{
+		}
+
+		std::uint32_t operator()()
+		{
+			m_state = m_state * 1103515245u + 12345u;
+			return m_state >> 8;
+		}
+	};
+
+	/** Picks the size of a new block. */
+	size_t block_size(Random &random)
+	{
+		std::uint32_t const kind = random() % 100;
+		if(kind < 70)
+			return 8 + random() % 120;
+		if(kind < 95)
+			return 128 + random() % 2048;
+		return 4096 + random() % 65536;
+	}
+
+	double mib(size_t bytes)
+	{
+		return bytes / 1048576.0;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	HeapMode mode = HeapMode::Segregated;
+	if(argc > 1 && !std::strcmp(argv[1], "firstfit"))
+		mode = HeapMode::FirstFit;
+	else if(argc > 1 && std::strcmp(argv[1], "segregated"))
+	{
+		std::fprintf(stderr, "usage: %s [firstfit|segregated] [cycles] [heap MiB]\n", argv[0]);
+		return 1;
+	}
+
+	size_t const cycles = argc > 2
+		? size_t(std::strtoull(argv[2], nullptr, 10))
+		: 4000000;
+	size_t const capacity = argc > 3
+		? size_t(std::strtoull(argv[3], nullptr, 10)) << 20
+		: size_t(16) << 20;
+	if(cycles < k_reports || !capacity)
+	{
+		std::fprintf(stderr, "usage: %s [firstfit|segregated] [cycles] [heap MiB]\n", argv[0]);
+		return 1;
+	}
+
+	Heap heap(capacity, mode);
+	size_t const empty = heap.free_bytes();
+
+	std::vector<void *> live;
+	Random random;
+	size_t failed = 0;
+	size_t min_largest = SIZE_MAX;
+	double fragmentation = 0;
+	size_t samples = 0;
+
+	auto const start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < cycles; i++)
+	{
+		size_t const target = 3000 + (i / 50000 % 2) * 1500;
+		if(live.size() < target)
+		{
+			if(void * const block = heap.malloc(block_size(random)))
+				live.push_back(block);
+			else
+				++failed;
+		} else
+		{
+			size_t const index = random() % live.size();
+			re::free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		if(i % k_sample == 0)
+		{
+			size_t const largest = heap.largest_hole();
+			if(largest < min_largest)
+				min_largest = largest;
+			fragmentation += heap.fragmentation();
+			++samples;
+		}
+
+		if(i % (cycles / k_reports) == cycles / k_reports - 1)
+			std::printf("%9zu cycles: %5zu live, %7.2f MiB free, %7.2f MiB largest hole, fragmentation %.3f, %zu failed\n",
+				i + 1,
+				live.size(),
+				mib(heap.free_bytes()),
+				mib(heap.largest_hole()),
+				heap.fragmentation(),
+				failed);
+	}
+	auto const end = std::chrono::steady_clock::now();
+
+	std::printf("smallest largest hole: %.2f MiB\n", mib(min_largest));
+	std::printf("mean fragmentation:    %.3f\n", fragmentation / samples);
+	std::printf("failed allocations:    %zu\n", failed);
+	std::printf("time per cycle:        %.1f ns\n",
+		std::chrono::duration<double, std::nano>(end - start).count() / cycles);
+
+	for(void * block : live)
+		re::free(block);
+
+	bool const merged = heap.free_bytes() == empty && heap.largest_hole() == empty;
+	std::printf("after freeing all:     %.2f MiB free, %.2f MiB largest hole%s\n",
+		mib(heap.free_bytes()),
+		mib(heap.largest_hole()),
+		merged ? "" : " (not merged into a single hole)");
+
+	return merged ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+/** Checks the accuracy of the Mat4x4<float> and Mat3x3<float> inversions against a double precision reference, and measures them.
+
+	Usage: re_matrix_inverse [iterations]
+
+	inverse(), affine_inverse() and inverse_transpose3x3() of Mat4x4, and inverse() and inverse_transpose() of Mat3x3 are computed in float, which uses the SIMD backend the tool was compiled with, and via the generic templates in double. General matrices have random elements in [-1, 1] and a diagonal of 3, affine matrices have such an upper left 3x3 part and a translation in [-10, 10], which keeps them well conditioned. The 3x3 matrices are the upper left 3x3 parts of general matrices. The error is relative to the largest element of the reference result, and the tool fails if it exceeds `k_tolerance`. The residual, the largest deviation of the matrix times its float inverse from the identity, is printed as well.
+	Then, the time per inversion is measured over `iterations` (default 10 million) inversions. To compare backends, build the tool once with the default flags, once with `-mavx2 -mfma`, and once with RE_NO_SIMD defined. */
+#include "../src/math/Matrix.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace re;
+using namespace re::math;
+
+namespace
+{
+	/** The largest accepted error, relative to the largest element of the reference result. */
+	double const k_tolerance = 1e-5;
+	/** How many random matrices are checked. */
+	size_t const k_checks = 100000;
+	/** How many matrices the measurements cycle through, a power of two. */
+	size_t const k_operands = 256;
+
+	char const * backend()
+	{
+#if defined(RE_SIMD_SCALAR)
+		return "scalar (generic templates)";
+#elif defined(RE_SIMD_NEON)
+		return "NEON";
+#elif defined(RE_SIMD_AVX) && defined(RE_SIMD_FMA)
+		return "AVX + FMA";
+#elif defined(RE_SIMD_AVX)
+		return "AVX";
+#elif defined(RE_SIMD_SSE41)
+		return "SSE4.1";
+#else
+		return "SSE2";
+#endif
+	}
+
+	class Random
+	{
+		std::mt19937 m_engine;
+		std::uniform_real_distribution<float> m_distribution;
+	public:
+		Random():
+			m_engine(12345),
+			m_distribution(-1.0f, 1.0f)
+		{
+		}
+
+		float operator()()
+		{
+			return m_distribution(m_engine);
+		}
+
+		/** A general matrix with a dominant diagonal. */
+		fmat4x4_t general()
+		{
+			fmat4x4_t m(
+				fvec4_t((*this)(), (*this)(), (*this)(), (*this)()),
+				fvec4_t((*this)(), (*this)(), (*this)(), (*this)()),
+				fvec4_t((*this)(), (*this)(), (*this)(), (*this)()),
+				fvec4_t((*this)(), (*this)(), (*this)(), (*this)()));
+			m.v0.x += 3;
+			m.v1.y += 3;
+			m.v2.z += 3;
+			m.v3.w += 3;
+			return m;
+		}
+
+		/** A general 3x3 matrix with a dominant diagonal. */
+		fmat3x3_t general3x3()
+		{
+			fmat4x4_t const m = general();
+			return fmat3x3_t(fvec3_t(m.v0), fvec3_t(m.v1), fvec3_t(m.v2));
+		}
+
+		/** An affine matrix, whose last row is `(0, 0, 0, 1)`. */
+		fmat4x4_t affine()
+		{
+			fmat4x4_t m = general();
+			m.v0.w = m.v1.w = m.v2.w = 0;
+			m.v3 = fvec4_t(10 * (*this)(), 10 * (*this)(), 10 * (*this)(), 1);
+			return m;
+		}
+	};
+
+	/** The largest absolute element of a matrix. */
+	double largest(Mat4x4<double> const& m)
+	{
+		double result = 0;
+		for(Vec4<double> const& v : { m.v0, m.v1, m.v2, m.v3 })
+			result = std::max(result, std::max(
+				std::max(std::fabs(v.x), std::fabs(v.y)),
+				std::max(std::fabs(v.z), std::fabs(v.w))));
+		return result;
+	}
+
+	Mat4x4<double> difference(
+		Mat4x4<double> const& a,
+		Mat4x4<double> const& b)
+	{
+		return Mat4x4<double>(a.v0 - b.v0, a.v1 - b.v1, a.v2 - b.v2, a.v3 - b.v3);
+	}
+
+	Mat4x4<double> extend(Mat3x3<double> const& m)
+	{
+		return Mat4x4<double>(
+			Vec4<double>(m.v0, 0),
+			Vec4<double>(m.v1, 0),
+			Vec4<double>(m.v2, 0),
+			Vec4<double>(0, 0, 0, 0));
+	}
+
+	/** The largest error of an inversion so far. */
+	struct Check
+	{
+		char const * m_name;
+		double m_error;
+		double m_residual;
+
+		void add(
+			Mat4x4<double> const& matrix,
+			Mat4x4<double> const& result,
+			Mat4x4<double> const& reference,
+			Mat4x4<double> const& identity)
+		{
+			m_error = std::max(m_error, largest(difference(result, reference)) / largest(reference));
+			m_residual = std::max(m_residual, largest(difference(matrix * result, identity)));
+		}
+	};
+
+	/** Keeps the results alive, so that the loops are not removed. */
+	volatile float g_sink;
+
+	template<class Operation>
+	/** The time per operation, in nanoseconds. The operations do not depend on each other, so this measures throughput, as when preparing the matrices of many nodes. */
+	double measure(
+		size_t iterations,
+		Operation operation)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < iterations; i++)
+			g_sink = operation(i & (k_operands - 1));
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	size_t const iterations = argc > 1
+		? size_t(std::strtoull(argv[1], nullptr, 10))
+		: 10000000;
+	if(!iterations)
+	{
+		std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	std::printf("backend: %s\n", backend());
+
+	Mat4x4<double> const identity(Mat4x4<double>::kIdentity);
+	// the inverse transpose is checked as the inverse of the transposed 3x3 part.
+	Mat4x4<double> const identity3x3 = extend(Mat3x3<double>::kIdentity);
+
+	Random random;
+	Check inverse_check = { "inverse", 0, 0 };
+	Check affine_check = { "affine_inverse", 0, 0 };
+	Check inverse_transpose_check = { "inverse_transpose3x3", 0, 0 };
+	Check inverse3x3_check = { "inverse (3x3)", 0, 0 };
+	Check inverse_transpose3x3_check = { "inverse_transpose", 0, 0 };
+	for(size_t i = 0; i < k_checks; i++)
+	{
+		fmat4x4_t const m = random.general();
+		Mat4x4<double> const dm(m);
+		inverse_check.add(dm, Mat4x4<double>(inverse(m)), inverse(dm), identity);
+
+		fmat4x4_t const a = random.affine();
+		Mat4x4<double> const da(a);
+		affine_check.add(da, Mat4x4<double>(affine_inverse(a)), affine_inverse(da), identity);
+
+		Mat4x4<double> const transposed3x3 = transpose(extend(Mat3x3<double>(Vec3<double>(dm.v0), Vec3<double>(dm.v1), Vec3<double>(dm.v2))));
+		inverse_transpose_check.add(
+			transposed3x3,
+			extend(Mat3x3<double>(inverse_transpose3x3(m))),
+			extend(inverse_transpose3x3(dm)),
+			identity3x3);
+
+		fmat3x3_t const m3 = random.general3x3();
+		Mat3x3<double> const dm3(m3);
+		inverse3x3_check.add(extend(dm3), extend(Mat3x3<double>(inverse(m3))), extend(inverse(dm3)), identity3x3);
+		inverse_transpose3x3_check.add(
+			transpose(extend(dm3)),
+			extend(Mat3x3<double>(inverse_transpose(m3))),
+			extend(inverse_transpose(dm3)),
+			identity3x3);
+	}
+
+	bool ok = true;
+	for(Check const * check : { &inverse_check, &affine_check, &inverse_transpose_check, &inverse3x3_check, &inverse_transpose3x3_check })
+	{
+		bool const passed = check->m_error <= k_tolerance;
+		std::printf("%-21s max relative error %.2e, max residual %.2e%s\n",
+			check->m_name,
+			check->m_error,
+			check->m_residual,
+			passed ? "" : " FAILED");
+		ok &= passed;
+	}
+
+	std::vector<fmat4x4_t> general, affine;
+	std::vector<fmat3x3_t> general3x3;
+	for(size_t i = 0; i < k_operands; i++)
+	{
+		general.push_back(random.general());
+		affine.push_back(random.affine());
+		general3x3.push_back(random.general3x3());
+	}
+
+	std::printf("inverse               %6.2f ns\n", measure(iterations, [&](size_t i) { return inverse(general[i]).v2.z; }));
+	std::printf("affine_inverse        %6.2f ns\n", measure(iterations, [&](size_t i) { return affine_inverse(affine[i]).v3.y; }));
+	std::printf("inverse_transpose3x3  %6.2f ns\n", measure(iterations, [&](size_t i) { return inverse_transpose3x3(general[i]).v1.z; }));
+	std::printf("inverse (3x3)         %6.2f ns\n", measure(iterations, [&](size_t i) { return inverse(general3x3[i]).v2.y; }));
+	std::printf("inverse_transpose     %6.2f ns\n", measure(iterations, [&](size_t i) { return inverse_transpose(general3x3[i]).v1.z; }));
+
+	return ok ? 0 : 1;
+}
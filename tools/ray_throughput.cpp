@@ -0,0 +1,248 @@
+/** Measures the throughput of the batched ray intersection kernels in rays per second, and checks them against the scalar intersect() overloads.
+
+	Usage: re_ray_throughput [rays] [triangles]
+
+	The triangles (default 64, as in a picking mesh or a Bvh leaf) are random and lie within the cube [-1, 1]^3. The rays start in front of the cube and point at random points inside it, so that most of them hit a triangle. Every ray is tested against all triangles via intersect_nearest() and via a loop over the scalar intersect(), and against the box [-0.5, 0.5]^3 via intersect_box() and via the scalar intersect(). The measurements cycle through 1024 rays until `rays` (default 1 million) rays were tested.
+	Before that, the nearest hits and box distances of all 1024 rays are compared between the kernels and the scalar overloads. If a hit differs, the tool fails. */
+#include "../src/math/RayIntersection.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace re;
+using namespace re::math;
+
+namespace
+{
+	/** How many different rays there are. */
+	size_t const k_rays = 1024;
+	/** The largest accepted difference between two hit coordinates, relative to the coordinate. */
+	float const k_tolerance = 1e-4f;
+
+	class Random
+	{
+		std::mt19937 m_engine;
+		std::uniform_real_distribution<float> m_distribution;
+	public:
+		Random():
+			m_engine(12345),
+			m_distribution(-1.0f, 1.0f)
+		{
+		}
+
+		float operator()()
+		{
+			return m_distribution(m_engine);
+		}
+
+		fvec3_t vector()
+		{
+			return fvec3_t((*this)(), (*this)(), (*this)());
+		}
+	};
+
+	/** The triangles, as corners for the scalar test and as arrays for the kernel. */
+	struct Triangles
+	{
+		std::vector<fvec3_t> a, b, c;
+		std::vector<float> arrays[9];
+
+		Triangles(
+			Random &random,
+			size_t count)
+		{
+			for(size_t i = 0; i < count; i++)
+			{
+				fvec3_t const corner = random.vector();
+				a.push_back(corner);
+				b.push_back(corner + random.vector() * 0.5f);
+				c.push_back(corner + random.vector() * 0.5f);
+
+				fvec3_t const edge1 = b.back() - corner;
+				fvec3_t const edge2 = c.back() - corner;
+				float const coordinates[9] = {
+					corner.x, corner.y, corner.z,
+					edge1.x, edge1.y, edge1.z,
+					edge2.x, edge2.y, edge2.z
+				};
+				for(size_t j = 0; j < 9; j++)
+					arrays[j].push_back(coordinates[j]);
+			}
+		}
+
+		TriangleArrays view() const
+		{
+			TriangleArrays const view = {
+				arrays[0].data(), arrays[1].data(), arrays[2].data(),
+				arrays[3].data(), arrays[4].data(), arrays[5].data(),
+				arrays[6].data(), arrays[7].data(), arrays[8].data()
+			};
+			return view;
+		}
+
+		size_t size() const
+		{
+			return a.size();
+		}
+	};
+
+	/** The reference: the nearest hit of the scalar intersect() over all triangles. */
+	bool scalar_nearest(
+		Ray<float> const& ray,
+		Triangles const& triangles,
+		TriangleHit &hit)
+	{
+		bool found = false;
+		float max_distance = std::numeric_limits<float>::infinity();
+		for(size_t i = 0; i < triangles.size(); i++)
+			if(intersect(ray, triangles.a[i], triangles.b[i], triangles.c[i], max_distance, hit.distance, hit.u, hit.v))
+			{
+				found = true;
+				hit.triangle = i;
+				max_distance = hit.distance;
+			}
+		return found;
+	}
+
+	bool close(
+		float a,
+		float b)
+	{
+		return std::fabs(a - b) <= k_tolerance * std::fmax(1.0f, std::fabs(b));
+	}
+
+	/** Keeps the results alive, so that the loops are not removed. */
+	volatile size_t g_sink;
+
+	template<class Run>
+	/** The rays per second of the given loop. */
+	double measure(
+		size_t rays,
+		Run run)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		g_sink = run();
+		return rays / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void print(
+		char const * name,
+		double batched,
+		double scalar)
+	{
+		std::printf("%-10s %8.2f M rays/s batched, %8.2f M rays/s scalar, %5.2fx\n",
+			name,
+			batched * 1e-6,
+			scalar * 1e-6,
+			batched / scalar);
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	size_t const rays = argc > 1
+		? size_t(std::strtoull(argv[1], nullptr, 10))
+		: 1000000;
+	size_t const triangle_count = argc > 2
+		? size_t(std::strtoull(argv[2], nullptr, 10))
+		: 64;
+	if(!rays || !triangle_count || triangle_count >= (size_t(1) << 24))
+	{
+		std::fprintf(stderr, "usage: %s [rays] [triangles]\n", argv[0]);
+		return 1;
+	}
+
+	std::printf("%zu lanes, %zu triangles per ray\n", size_t(simd::WideLanes::k_width), triangle_count);
+
+	Random random;
+	Triangles const triangles(random, triangle_count);
+	TriangleArrays const triangle_arrays = triangles.view();
+
+	std::vector<Ray<float>> ray_list;
+	std::vector<float> ray_arrays[6];
+	for(size_t i = 0; i < k_rays; i++)
+	{
+		fvec3_t const origin(random() * 2, random() * 2, -5);
+		fvec3_t const direction = random.vector() - origin;
+		ray_list.push_back(Ray<float>(origin, direction));
+
+		float const coordinates[6] = {
+			origin.x, origin.y, origin.z,
+			1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z
+		};
+		for(size_t j = 0; j < 6; j++)
+			ray_arrays[j].push_back(coordinates[j]);
+	}
+	RayArrays const rays_view = {
+		ray_arrays[0].data(), ray_arrays[1].data(), ray_arrays[2].data(),
+		ray_arrays[3].data(), ray_arrays[4].data(), ray_arrays[5].data()
+	};
+	faabb_t const box(fvec3_t(-0.5f, -0.5f, -0.5f), fvec3_t(0.5f, 0.5f, 0.5f));
+
+	size_t triangle_hits = 0, triangle_mismatches = 0;
+	for(Ray<float> const& ray : ray_list)
+	{
+		TriangleHit batched, scalar;
+		bool const batched_found = intersect_nearest(ray, triangle_arrays, triangles.size(), batched);
+		bool const scalar_found = scalar_nearest(ray, triangles, scalar);
+		triangle_hits += scalar_found;
+		// two triangles can be hit at almost the same coordinate, so only the coordinate has to match.
+		if(batched_found != scalar_found
+		|| (scalar_found && !(close(batched.distance, scalar.distance)
+			&& (batched.triangle != scalar.triangle || (close(batched.u, scalar.u) && close(batched.v, scalar.v))))))
+			++triangle_mismatches;
+	}
+
+	std::vector<float> distances(k_rays);
+	size_t const box_hits = intersect_box(rays_view, k_rays, box, distances.data());
+	size_t scalar_box_hits = 0, box_mismatches = 0;
+	for(size_t i = 0; i < k_rays; i++)
+	{
+		float distance;
+		bool const hit = intersect(ray_list[i], box, std::numeric_limits<float>::infinity(), distance);
+		scalar_box_hits += hit;
+		if(hit != std::isfinite(distances[i]) || (hit && !close(distances[i], distance)))
+			++box_mismatches;
+	}
+
+	std::printf("triangles: %zu of %zu rays hit, %zu differ\n", triangle_hits, k_rays, triangle_mismatches);
+	std::printf("box:       %zu of %zu rays hit (%zu scalar), %zu differ\n", box_hits, k_rays, scalar_box_hits, box_mismatches);
+
+	double const batched_triangles = measure(rays, [&]() {
+		size_t found = 0;
+		TriangleHit hit;
+		for(size_t i = 0; i < rays; i++)
+			found += intersect_nearest(ray_list[i % k_rays], triangle_arrays, triangles.size(), hit);
+		return found;
+	});
+	double const scalar_triangles = measure(rays, [&]() {
+		size_t found = 0;
+		TriangleHit hit;
+		for(size_t i = 0; i < rays; i++)
+			found += scalar_nearest(ray_list[i % k_rays], triangles, hit);
+		return found;
+	});
+	print("triangles", batched_triangles, scalar_triangles);
+
+	double const batched_box = measure(rays, [&]() {
+		size_t found = 0;
+		for(size_t i = 0; i < rays; i += k_rays)
+			found += intersect_box(rays_view, rays - i < k_rays ? rays - i : k_rays, box, distances.data());
+		return found;
+	});
+	double const scalar_box = measure(rays, [&]() {
+		size_t found = 0;
+		float distance;
+		for(size_t i = 0; i < rays; i++)
+			found += intersect(ray_list[i % k_rays], box, std::numeric_limits<float>::infinity(), distance);
+		return found;
+	});
+	print("box", batched_box, scalar_box);
+
+	return triangle_mismatches || box_mismatches || box_hits != scalar_box_hits ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+/** Measures what passing an object by Shared, AtomicShared and Borrowed costs.
+
+	Usage: re_shared_copy [iterations]
+
+	Each iteration passes the reference to a function that is not inlined, so that the reference count changes cannot be optimised away, and reads from the object. Borrowed never changes the reference count. AtomicShared is also measured while several threads copy the same reference at once, which makes them contend for the cache line of the count. The iterations default to 10 million per measurement.
+	Afterwards, the reference counts are checked to have returned to their initial values, otherwise the tool fails. */
+#include "../src/util/Pointer.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+using namespace re;
+using namespace re::util;
+
+namespace
+{
+	/** An object that is referenced, such as a Font. */
+	struct Object
+	{
+		int m_data[64];
+	};
+
+	template<class Reference>
+	/** Receives a reference by value, as a getter or parameter would. */
+	NOINLINE int pass(Reference reference)
+	{
+		return reference->m_data[0];
+	}
+
+	template<class Run>
+	/** The time per iteration of the given loop, in nanoseconds. */
+	double measure(
+		size_t iterations,
+		Run run)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		run();
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	}
+
+	/** Keeps the results alive, so that the loops are not removed. */
+	volatile int g_sink;
+}
+
+int main(int argc, char ** argv)
+{
+	size_t const iterations = argc > 1
+		? size_t(std::strtoull(argv[1], nullptr, 10))
+		: 10000000;
+	if(!iterations)
+	{
+		std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	Shared<Object> const local = Shared<Object>::alloc();
+	AtomicShared<Object> const atomic = AtomicShared<Object>::alloc();
+
+	std::printf("Shared copy:           %6.2f ns\n", measure(iterations, [&]() {
+		int sum = 0;
+		for(size_t i = 0; i < iterations; i++)
+			sum += pass<Shared<Object>>(local);
+		g_sink = sum;
+	}));
+	std::printf("AtomicShared copy:     %6.2f ns\n", measure(iterations, [&]() {
+		int sum = 0;
+		for(size_t i = 0; i < iterations; i++)
+			sum += pass<AtomicShared<Object>>(atomic);
+		g_sink = sum;
+	}));
+	std::printf("Borrowed:              %6.2f ns\n", measure(iterations, [&]() {
+		int sum = 0;
+		for(size_t i = 0; i < iterations; i++)
+			sum += pass(local.borrow());
+		g_sink = sum;
+	}));
+
+	unsigned const hardware = std::thread::hardware_concurrency();
+	for(unsigned threads = 2; threads <= 4; threads *= 2)
+	{
+		size_t const per_thread = iterations / threads;
+		double const ns = measure(per_thread, [&]() {
+			std::vector<int> sums(threads);
+			std::vector<std::thread> workers;
+			for(unsigned t = 0; t < threads; t++)
+				workers.emplace_back([&, t]() {
+					int sum = 0;
+					for(size_t i = 0; i < per_thread; i++)
+						sum += pass<AtomicShared<Object>>(atomic);
+					sums[t] = sum;
+				});
+			for(std::thread &worker : workers)
+				worker.join();
+			g_sink = sums[0];
+		});
+		std::printf("AtomicShared copy, %u threads at once: %6.2f ns per copy per thread%s\n",
+			threads,
+			ns,
+			threads > hardware ? " (more threads than cores)" : "");
+	}
+
+	bool const balanced = local.count() == 1 && atomic.count() == 1;
+	if(!balanced)
+		std::printf("reference counts did not return to 1: %zu, %zu\n", local.count(), atomic.count());
+	return balanced ? 0 : 1;
+}
@@ -0,0 +1,325 @@
+/** Checks the vectorised Vec4<float> and Mat4x4<float> operations against the generic templates, and measures both.
+
+	Usage: re_simd_ops [iterations]
+
+	The generic templates are the reference implementation: every operation is computed on random operands in float, which uses the SIMD backend the tool was compiled with, via the templates in float, and via the templates in double. The tool fails if a float result differs from the double result by more than `k_tolerance`.
+	Then, the time per operation is measured over `iterations` (default 20 million) operations on a small set of random operands, via the SIMD backend and via the templates, alternating between both, and the speedup is printed. The templates cannot be called for float directly, as the SIMD overloads and specialisations take precedence, so they are called with `Scalar`, a float wrapper that compiles to the same code. Both paths are used by the check and by the measurement, so that the compiler makes the same inlining decisions for both. A SIMD operation that is not faster than its template should not exist. With RE_NO_SIMD defined, both measure the templates. */
+#include "../src/math/Matrix.hpp"
+#include "../src/math/Vector.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace re;
+using namespace re::math;
+
+namespace
+{
+	/** The largest accepted absolute difference to the reference, for operands in [-1, 1]. */
+	double const k_tolerance = 1e-5;
+	/** How many random operands are checked. */
+	size_t const k_checks = 10000;
+	/** How many operands the measurements cycle through, a power of two. */
+	size_t const k_operands = 256;
+	/** How often each measurement is repeated, alternating between the paths. The best time counts. */
+	unsigned const k_repeats = 3;
+
+	char const * backend()
+	{
+#if defined(RE_SIMD_SCALAR)
+		return "scalar (generic templates)";
+#elif defined(RE_SIMD_NEON)
+		return "NEON";
+#elif defined(RE_SIMD_AVX) && defined(RE_SIMD_FMA)
+		return "AVX + FMA";
+#elif defined(RE_SIMD_AVX)
+		return "AVX";
+#elif defined(RE_SIMD_SSE41)
+		return "SSE4.1";
+#else
+		return "SSE2";
+#endif
+	}
+
+	class Random
+	{
+		std::mt19937 m_engine;
+		std::uniform_real_distribution<float> m_distribution;
+	public:
+		Random():
+			m_engine(12345),
+			m_distribution(-1.0f, 1.0f)
+		{
+		}
+
+		fvec4_t vector()
+		{
+			return fvec4_t(m_distribution(m_engine), m_distribution(m_engine), m_distribution(m_engine), m_distribution(m_engine));
+		}
+
+		fmat4x4_t matrix()
+		{
+			return fmat4x4_t(vector(), vector(), vector(), vector());
+		}
+	};
+
+	double error(float a, double b)
+	{
+		return std::fabs(a - b);
+	}
+
+	double error(fvec4_t const& a, Vec4<double> const& b)
+	{
+		return std::max(
+			std::max(error(a.x, b.x), error(a.y, b.y)),
+			std::max(error(a.z, b.z), error(a.w, b.w)));
+	}
+
+	double error(fmat4x4_t const& a, Mat4x4<double> const& b)
+	{
+		return std::max(
+			std::max(error(a.v0, b.v0), error(a.v1, b.v1)),
+			std::max(error(a.v2, b.v2), error(a.v3, b.v3)));
+	}
+
+	/** The largest error of an operation so far. */
+	struct Check
+	{
+		char const * m_name;
+		/** Of the SIMD backend. */
+		double m_error;
+		/** Of the templates for float. */
+		double m_template_error;
+	};
+
+	/** A float that the SIMD overloads and specialisations do not apply to, so that the generic templates can be measured for float in the same build. */
+	struct Scalar
+	{
+		float value;
+
+		Scalar() = default;
+		Scalar(float value):
+			value(value)
+		{
+		}
+
+		explicit operator float() const
+		{
+			return value;
+		}
+
+		explicit operator bool() const
+		{
+			return value != 0.0f;
+		}
+	};
+
+	Scalar operator+(Scalar a, Scalar b) { return a.value + b.value; }
+	Scalar operator-(Scalar a, Scalar b) { return a.value - b.value; }
+	Scalar operator*(Scalar a, Scalar b) { return a.value * b.value; }
+	Scalar operator/(Scalar a, double b) { return float(a.value / b); }
+	double sqrt(Scalar a) { return std::sqrt(double(a.value)); }
+
+	typedef Vec4<Scalar> svec4_t;
+	typedef Mat4x4<Scalar> smat4x4_t;
+
+	svec4_t to_scalar(fvec4_t const& v)
+	{
+		return svec4_t(v.x, v.y, v.z, v.w);
+	}
+
+	smat4x4_t to_scalar(fmat4x4_t const& m)
+	{
+		return smat4x4_t(to_scalar(m.v0), to_scalar(m.v1), to_scalar(m.v2), to_scalar(m.v3));
+	}
+
+	double error(Scalar a, double b)
+	{
+		return error(a.value, b);
+	}
+
+	double error(svec4_t const& a, Vec4<double> const& b)
+	{
+		return error(fvec4_t(a.x.value, a.y.value, a.z.value, a.w.value), b);
+	}
+
+	double error(smat4x4_t const& a, Mat4x4<double> const& b)
+	{
+		return std::max(
+			std::max(error(a.v0, b.v0), error(a.v1, b.v1)),
+			std::max(error(a.v2, b.v2), error(a.v3, b.v3)));
+	}
+
+	/** Keeps the results alive, so that the loops are not removed. */
+	volatile float g_sink;
+
+	template<class Operation>
+	/** The time per operation, in nanoseconds. The operations do not depend on each other, so this measures throughput, as in a loop over many vertices or nodes. */
+	double measure(
+		size_t iterations,
+		Operation operation)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < iterations; i++)
+			g_sink = operation(i & (k_operands - 1));
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	}
+
+	template<class Simd, class Scalar>
+	/** Measures an operation via the SIMD backend and via the template, and prints both times and the speedup. */
+	void compare(
+		char const * name,
+		size_t iterations,
+		Simd simd,
+		Scalar scalar)
+	{
+		double simd_time = 0, scalar_time = 0;
+		for(unsigned repeat = 0; repeat < k_repeats; repeat++)
+		{
+			double const simd_run = measure(iterations, simd);
+			double const scalar_run = measure(iterations, scalar);
+			if(!repeat || simd_run < simd_time)
+				simd_time = simd_run;
+			if(!repeat || scalar_run < scalar_time)
+				scalar_time = scalar_run;
+		}
+		std::printf("%-10s simd %6.2f ns, template %6.2f ns, %5.2fx\n",
+			name,
+			simd_time,
+			scalar_time,
+			scalar_time / simd_time);
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	size_t const iterations = argc > 1
+		? size_t(std::strtoull(argv[1], nullptr, 10))
+		: 20000000;
+	if(!iterations)
+	{
+		std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	std::printf("backend: %s\n", backend());
+
+	Random random;
+	Check checks[] = {
+		{ "mat*mat", 0, 0 },
+		{ "mat*vec", 0, 0 },
+		{ "transpose", 0, 0 },
+		{ "dot", 0, 0 },
+		{ "cross", 0, 0 },
+		{ "norm", 0, 0 },
+		{ "absf", 0, 0 },
+		{ "vec+vec", 0, 0 },
+		{ "vec-vec", 0, 0 },
+		{ "vec*scalar", 0, 0 }
+	};
+	for(size_t i = 0; i < k_checks; i++)
+	{
+		fmat4x4_t const a = random.matrix();
+		fmat4x4_t const b = random.matrix();
+		fvec4_t const v = random.vector();
+		fvec4_t const w = random.vector();
+		Mat4x4<double> const da(a);
+		Mat4x4<double> const db(b);
+		Vec4<double> const dv(v);
+		Vec4<double> const dw(w);
+		smat4x4_t const sa = to_scalar(a);
+		smat4x4_t const sb = to_scalar(b);
+		svec4_t const sv = to_scalar(v);
+		svec4_t const sw = to_scalar(w);
+
+		double const errors[] = {
+			error(a * b, da * db),
+			error(a * v, da * dv),
+			error(transpose(a), transpose(da)),
+			error(dot(v, w), dot(dv, dw)),
+			error(cross(v, w), cross(dv, dw)),
+			error(norm(v), norm(dv)),
+			error(absf(v), abs(dv)),
+			error(v + w, dv + dw),
+			error(v - w, dv - dw),
+			error(v * 2.5f, dv * 2.5f)
+		};
+		double const template_errors[] = {
+			error(sa * sb, da * db),
+			error(sa * sv, da * dv),
+			error(transpose(sa), transpose(da)),
+			error(dot(sv, sw), dot(dv, dw)),
+			error(cross(sv, sw), cross(dv, dw)),
+			error(norm(sv), norm(dv)),
+			error(absf(sv), abs(dv)),
+			error(sv + sw, dv + dw),
+			error(sv - sw, dv - dw),
+			error(sv * 2.5f, dv * 2.5f)
+		};
+		for(size_t op = 0; op < _countof(checks); op++)
+		{
+			checks[op].m_error = std::max(checks[op].m_error, errors[op]);
+			checks[op].m_template_error = std::max(checks[op].m_template_error, template_errors[op]);
+		}
+	}
+
+	bool ok = true;
+	for(Check const& check : checks)
+	{
+		bool const passed = check.m_error <= k_tolerance && check.m_template_error <= k_tolerance;
+		std::printf("%-10s max error simd %.2e, template %.2e%s\n", check.m_name, check.m_error, check.m_template_error, passed ? "" : " FAILED");
+		ok &= passed;
+	}
+
+	std::vector<fmat4x4_t> matrices;
+	std::vector<fvec4_t> vectors;
+	std::vector<smat4x4_t> scalar_matrices;
+	std::vector<svec4_t> scalar_vectors;
+	for(size_t i = 0; i < k_operands; i++)
+	{
+		matrices.push_back(random.matrix());
+		vectors.push_back(random.vector());
+		scalar_matrices.push_back(to_scalar(matrices.back()));
+		scalar_vectors.push_back(to_scalar(vectors.back()));
+	}
+	auto const next = [](size_t i) { return (i + 1) & (k_operands - 1); };
+
+	compare("mat*mat", iterations,
+		[&](size_t i) { return (matrices[i] * matrices[next(i)]).v2.z; },
+		[&](size_t i) { return (scalar_matrices[i] * scalar_matrices[next(i)]).v2.z.value; });
+	compare("mat*vec", iterations,
+		[&](size_t i) { return (matrices[i] * vectors[next(i)]).z; },
+		[&](size_t i) { return (scalar_matrices[i] * scalar_vectors[next(i)]).z.value; });
+	compare("transpose", iterations,
+		[&](size_t i) { return transpose(matrices[i]).v1.z; },
+		[&](size_t i) { return transpose(scalar_matrices[i]).v1.z.value; });
+	compare("dot", iterations,
+		[&](size_t i) { return dot(vectors[i], vectors[next(i)]); },
+		[&](size_t i) { return dot(scalar_vectors[i], scalar_vectors[next(i)]).value; });
+	compare("cross", iterations,
+		[&](size_t i) { return cross(vectors[i], vectors[next(i)]).y; },
+		[&](size_t i) { return cross(scalar_vectors[i], scalar_vectors[next(i)]).y.value; });
+	compare("norm", iterations,
+		[&](size_t i) { return norm(vectors[i]).z; },
+		[&](size_t i) { return norm(scalar_vectors[i]).z.value; });
+	compare("absf", iterations,
+		[&](size_t i) { return absf(vectors[i]); },
+		[&](size_t i) { return absf(scalar_vectors[i]); });
+	compare("vec+vec", iterations,
+		[&](size_t i) { return (vectors[i] + vectors[next(i)]).z; },
+		[&](size_t i) { return (scalar_vectors[i] + scalar_vectors[next(i)]).z.value; });
+	compare("vec-vec", iterations,
+		[&](size_t i) { return (vectors[i] - vectors[next(i)]).z; },
+		[&](size_t i) { return (scalar_vectors[i] - scalar_vectors[next(i)]).z.value; });
+	compare("vec*scalar", iterations,
+		[&](size_t i) { return (vectors[i] * 2.5f).z; },
+		[&](size_t i) { return (scalar_vectors[i] * 2.5f).z.value; });
+
+	return ok ? 0 : 1;
+}
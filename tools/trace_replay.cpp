@@ -0,0 +1,366 @@
+/** Replays an allocation trace recorded via `re::util::AllocationTrace` against an allocator, and reports its throughput, peak RSS and fragmentation.
+
+	Usage: re_trace_replay <trace> <allocator> [heap MiB] [heaps]
+
+	The allocator is one of:
+		system:     std::malloc / std::free / std::realloc.
+		firstfit:   a Heap in HeapMode::FirstFit.
+		segregated: a Heap in HeapMode::Segregated.
+		multiheap:  a MultiHeap of Segregated heaps in MultiHeapMode::RoundRobin.
+
+	Every allocator should be replayed in its own process, so that the peak RSS belongs to it alone. Heaps default to twice the peak live bytes of the trace, plus 64 MiB. The events are replayed in recorded order on a single thread, as fast as possible. */
+#include "../src/util/AllocationTrace.hpp"
+#include "../src/util/Heap.hpp"
+#include "../src/util/MultiHeap.hpp"
+#include "../src/util/HeapStats.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace re;
+using namespace re::util;
+
+namespace
+{
+	/** The peak resident set size of the process, in bytes. */
+	size_t peak_rss()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return size_t(usage.ru_maxrss);
+#else
+		return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+	}
+
+	/** An allocator to replay a trace against. */
+	class Allocator
+	{
+	public:
+		virtual ~Allocator() {}
+
+		virtual void * malloc(size_t size, size_t alignment) = 0;
+		virtual void free(void * mem) = 0;
+		virtual void * realloc(void * mem, size_t size) = 0;
+		virtual bool resize(void * mem, size_t size) = 0;
+		/** Collects the usage statistics, if the allocator has any. */
+		virtual bool stats(HeapStats &stats) const = 0;
+	};
+
+	class SystemAllocator : public Allocator
+	{
+	public:
+		void * malloc(size_t size, size_t alignment) override
+		{
+#ifdef _WIN32
+			return _aligned_malloc(size ? size : 1, alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment);
+#else
+			if(alignment <= alignof(std::max_align_t))
+				return std::malloc(size);
+
+			void * mem;
+			return posix_memalign(&mem, alignment, size) ? nullptr : mem;
+#endif
+		}
+
+		void free(void * mem) override
+		{
+#ifdef _WIN32
+			_aligned_free(mem);
+#else
+			std::free(mem);
+#endif
+		}
+
+		void * realloc(void * mem, size_t size) override
+		{
+#ifdef _WIN32
+			return _aligned_realloc(mem, size ? size : 1, alignof(std::max_align_t));
+#else
+			return std::realloc(mem, size);
+#endif
+		}
+
+		bool resize(void *, size_t) override
+		{
+			return false;
+		}
+
+		bool stats(HeapStats &) const override
+		{
+			return false;
+		}
+	};
+
+	class HeapAllocator : public Allocator
+	{
+		Heap m_heap;
+	public:
+		HeapAllocator(size_t capacity, HeapMode mode):
+			m_heap(capacity, mode)
+		{
+		}
+
+		void * malloc(size_t size, size_t alignment) override
+		{
+			return m_heap.aligned_malloc(size, alignment);
+		}
+
+		void free(void * mem) override
+		{
+			re::free(mem);
+		}
+
+		void * realloc(void * mem, size_t size) override
+		{
+			return re::realloc(mem, size);
+		}
+
+		bool resize(void * mem, size_t size) override
+		{
+			return re::resize(mem, size);
+		}
+
+		bool stats(HeapStats &stats) const override
+		{
+			stats = m_heap.stats();
+			return true;
+		}
+	};
+
+	class MultiHeapAllocator : public Allocator
+	{
+		MultiHeap m_heap;
+	public:
+		MultiHeapAllocator(size_t capacity, size_t heaps):
+			m_heap(heaps, capacity / heaps, HeapMode::Segregated, MultiHeapMode::RoundRobin)
+		{
+		}
+
+		void * malloc(size_t size, size_t alignment) override
+		{
+			return m_heap.aligned_malloc(size, alignment);
+		}
+
+		void free(void * mem) override
+		{
+			re::free(mem);
+		}
+
+		void * realloc(void * mem, size_t size) override
+		{
+			return re::realloc(mem, size);
+		}
+
+		bool resize(void * mem, size_t size) override
+		{
+			return re::resize(mem, size);
+		}
+
+		bool stats(HeapStats &stats) const override
+		{
+			stats = m_heap.stats();
+			return true;
+		}
+	};
+
+	/** What a replay measured. */
+	struct Result
+	{
+		/** The time spent in the allocator. */
+		std::chrono::steady_clock::duration m_time;
+		/** How many allocations or reallocations failed. */
+		size_t m_failed;
+		/** How many resizes had to move the block, as they failed in place. */
+		size_t m_moved_resizes;
+		/** The highest fragmentation among the samples. */
+		float m_max_fragmentation;
+		/** The statistics after the last event, if the allocator has any. */
+		HeapStats m_final;
+		bool m_has_stats;
+	};
+
+	/** How many times the fragmentation is sampled during a replay. */
+	size_t const k_samples = 64;
+
+	Result replay(
+		std::vector<TraceEvent> const& events,
+		size_t blocks,
+		Allocator &allocator)
+	{
+		std::vector<void *> mem(blocks, nullptr);
+
+		Result result;
+		result.m_time = std::chrono::steady_clock::duration::zero();
+		result.m_failed = 0;
+		result.m_moved_resizes = 0;
+		result.m_max_fragmentation = 0;
+		result.m_has_stats = false;
+
+		size_t const sample = events.size() / k_samples + 1;
+		for(size_t begin = 0; begin < events.size(); begin += sample)
+		{
+			size_t const end = begin + sample < events.size()
+				? begin + sample
+				: events.size();
+
+			auto const start = std::chrono::steady_clock::now();
+			for(size_t i = begin; i < end; i++)
+			{
+				TraceEvent const& event = events[i];
+				void *& block = mem[event.m_id];
+
+				switch(TraceOp(event.m_op))
+				{
+				case TraceOp::Malloc:
+					{
+						block = allocator.malloc(event.m_size, size_t(1) << event.m_alignment);
+						if(!block)
+							++result.m_failed;
+					} break;
+				case TraceOp::Free:
+					{
+						if(block)
+							allocator.free(block);
+						block = nullptr;
+					} break;
+				case TraceOp::Resize:
+					{
+						if(!block || allocator.resize(block, event.m_size))
+							break;
+						++result.m_moved_resizes;
+					} // fall through.
+				case TraceOp::Realloc:
+					{
+						if(!block)
+							break;
+						if(void * const moved = allocator.realloc(block, event.m_size))
+							block = moved;
+						else
+							++result.m_failed;
+					} break;
+				}
+			}
+			result.m_time += std::chrono::steady_clock::now() - start;
+
+			// sampled outside of the measured time.
+			if(allocator.stats(result.m_final))
+			{
+				result.m_has_stats = true;
+				if(result.m_final.fragmentation() > result.m_max_fragmentation)
+					result.m_max_fragmentation = result.m_final.fragmentation();
+			}
+		}
+
+		for(void * block : mem)
+			if(block)
+				allocator.free(block);
+
+		return result;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	if(argc < 3)
+	{
+		std::fprintf(stderr, "usage: %s <trace> <system|firstfit|segregated|multiheap> [heap MiB] [heaps]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<TraceEvent> events;
+	if(!AllocationTrace::load(argv[1], events))
+	{
+		std::fprintf(stderr, "%s: could not load the trace.\n", argv[1]);
+		return 1;
+	}
+
+	// find the block count and the peak live bytes.
+	size_t blocks = 0, threads = 0, live = 0, peak_live = 0;
+	{
+		std::vector<size_t> sizes;
+		for(TraceEvent const& event : events)
+		{
+			if(event.m_id >= sizes.size())
+				sizes.resize(event.m_id + 1, 0);
+			if(event.m_thread >= threads)
+				threads = event.m_thread + 1u;
+
+			live -= sizes[event.m_id];
+			sizes[event.m_id] = (TraceOp(event.m_op) == TraceOp::Free)
+				? 0
+				: event.m_size;
+			live += sizes[event.m_id];
+			if(live > peak_live)
+				peak_live = live;
+		}
+		blocks = sizes.size();
+	}
+
+	size_t const capacity = argc > 3
+		? size_t(std::strtoull(argv[3], nullptr, 10)) << 20
+		: 2 * peak_live + (size_t(64) << 20);
+	size_t const heaps = argc > 4
+		? size_t(std::strtoull(argv[4], nullptr, 10))
+		: 4;
+
+	std::unique_ptr<Allocator> allocator;
+	if(!std::strcmp(argv[2], "system"))
+		allocator.reset(new SystemAllocator());
+	else if(!std::strcmp(argv[2], "firstfit"))
+		allocator.reset(new HeapAllocator(capacity, HeapMode::FirstFit));
+	else if(!std::strcmp(argv[2], "segregated"))
+		allocator.reset(new HeapAllocator(capacity, HeapMode::Segregated));
+	else if(!std::strcmp(argv[2], "multiheap") && heaps)
+		allocator.reset(new MultiHeapAllocator(capacity, heaps));
+	else
+	{
+		std::fprintf(stderr, "unknown allocator: %s\n", argv[2]);
+		return 1;
+	}
+
+	size_t const rss_before = peak_rss();
+	Result const result = replay(events, blocks, *allocator);
+	size_t const rss_after = peak_rss();
+
+	double const seconds = std::chrono::duration<double>(result.m_time).count();
+	std::printf("trace:         %zu events, %zu blocks, %zu threads, %zu KiB peak live\n",
+		events.size(), blocks, threads, peak_live >> 10);
+	std::printf("allocator:     %s\n", argv[2]);
+	std::printf("time:          %.3f ms\n", seconds * 1e3);
+	std::printf("throughput:    %.2f Mops/s\n", seconds > 0 ? events.size() / seconds * 1e-6 : 0.0);
+	std::printf("failed:        %zu\n", result.m_failed);
+	std::printf("moved resizes: %zu\n", result.m_moved_resizes);
+	std::printf("peak RSS:      %zu KiB (+%zu KiB during replay)\n",
+		rss_after >> 10, (rss_after - rss_before) >> 10);
+	if(result.m_has_stats)
+	{
+		std::printf("peak used:     %zu KiB (%.2fx peak live)\n",
+			result.m_final.m_peak_bytes >> 10,
+			peak_live ? double(result.m_final.m_peak_bytes) / peak_live : 0.0);
+		std::printf("fragmentation: %.3f max, %.3f at the end\n",
+			result.m_max_fragmentation, result.m_final.fragmentation());
+	}
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+/** Compares updating the world transformations of a large Scene via the SceneNodes and via the flattened TransformHierarchy, and checks that both agree.
+
+	Usage: re_transform_update [depth] [fan-out] [runs]
+
+	Two Scenes with the same tree are built, which defaults to a depth of 5 and a fan-out of 10, which are 111111 nodes, with random positions, orientations and scalings. One uses the flattened hierarchy, see Scene::setFlatTransforms(). Each measurement is run several times (default 5), and the best time is printed:
+		all moved:   every node was given a new position.
+		rebuild:     a subtree moved to another parent, so the flattened hierarchy is rebuilt and fully recomputed.
+		1% moved:    one in a hundred nodes, picked at random, was given a new position.
+		none moved:  nothing changed.
+	Then, every node of both Scenes is asked for its world transformation, as Renderer::render() does when nothing is culled. In the Scene with the flattened hierarchy, Scene::updateTransforms() is called before, as Renderer::render() does. Its time is printed separately, and is included in the time of the flattened visit.
+	After every measurement, the world transformations of both Scenes are compared. If they differ by more than `k_tolerance`, relative to the largest element, the tool fails. */
+#include "../src/Scene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace re;
+using namespace re::math;
+
+namespace
+{
+	/** The largest accepted difference between the world transformations of both paths, relative to their largest element. */
+	float const k_tolerance = 1e-4f;
+
+	class Random
+	{
+		std::mt19937 m_engine;
+		std::uniform_real_distribution<float> m_distribution;
+	public:
+		Random():
+			m_engine(12345),
+			m_distribution(-1.0f, 1.0f)
+		{
+		}
+
+		float operator()()
+		{
+			return m_distribution(m_engine);
+		}
+
+		fvec3_t position()
+		{
+			return fvec3_t((*this)(), (*this)(), (*this)()) * 10.0f;
+		}
+
+		fquat_t orientation()
+		{
+			return norm(fquat_t((*this)(), (*this)(), (*this)(), 1.0f + std::fabs((*this)())));
+		}
+
+		fvec3_t scaling()
+		{
+			return fvec3_t(1.0f, 1.0f, 1.0f) + fvec3_t((*this)(), (*this)(), (*this)()) * 0.25f;
+		}
+
+		/** A random index below `count`. */
+		size_t index(size_t count)
+		{
+			return std::uniform_int_distribution<size_t>(0, count - 1)(m_engine);
+		}
+	};
+
+	void build(
+		SceneNode &node,
+		unsigned depth,
+		unsigned fan_out,
+		Random &random)
+	{
+		if(!depth)
+			return;
+
+		for(unsigned i = 0; i < fan_out; i++)
+		{
+			SceneNode child;
+			child.setPosition(random.position());
+			child.setOrientation(random.orientation());
+			child.setScaling(random.scaling());
+			build(*node.addChild(std::move(child)), depth - 1, fan_out, random);
+		}
+	}
+
+	/** Lists the nodes of a tree in depth-first order. */
+	void list(
+		SceneNode &node,
+		std::vector<SceneNode *> &nodes)
+	{
+		nodes.push_back(&node);
+		for(SceneNode * child = node.firstChild(); child; child = child->nextSibling())
+			list(*child, nodes);
+	}
+
+	/** Keeps the results alive, so that the loops are not removed. */
+	volatile float g_sink;
+
+	/** Asks every node for its world transformation, as the culling does when nothing is culled. */
+	void visit(SceneNode const& node)
+	{
+		g_sink = node.getWorldTransformation().v3.x;
+		for(SceneNode const * child = node.firstChild(); child; child = child->nextSibling())
+			visit(*child);
+	}
+
+	float largest(fmat4x4_t const& m)
+	{
+		float result = 0;
+		for(fvec4_t const& v : { m.v0, m.v1, m.v2, m.v3 })
+			result = std::max(result, std::max(
+				std::max(std::fabs(v.x), std::fabs(v.y)),
+				std::max(std::fabs(v.z), std::fabs(v.w))));
+		return result;
+	}
+
+	/** The largest difference between the world transformations of two trees of the same shape, relative to the largest element. */
+	float compare(
+		SceneNode const& a,
+		SceneNode const& b)
+	{
+		fmat4x4_t const& x = a.getWorldTransformation();
+		fmat4x4_t const& y = b.getWorldTransformation();
+		fmat4x4_t const difference(x.v0 - y.v0, x.v1 - y.v1, x.v2 - y.v2, x.v3 - y.v3);
+		float error = largest(difference) / std::max(1.0f, largest(y));
+
+		SceneNode const * child_b = b.firstChild();
+		for(SceneNode const * child_a = a.firstChild(); child_a; child_a = child_a->nextSibling(), child_b = child_b->nextSibling())
+			error = std::max(error, compare(*child_a, *child_b));
+		return error;
+	}
+
+	double milliseconds(
+		std::chrono::steady_clock::time_point from,
+		std::chrono::steady_clock::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned const depth = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 5;
+	unsigned const fan_out = argc > 2 ? unsigned(std::strtoul(argv[2], nullptr, 10)) : 10;
+	unsigned const runs = argc > 3 ? unsigned(std::strtoul(argv[3], nullptr, 10)) : 5;
+	if(!depth || fan_out < 2 || !runs)
+	{
+		std::fprintf(stderr, "usage: %s [depth] [fan-out] [runs]\n", argv[0]);
+		return 1;
+	}
+
+	Scene nodes_scene, flat_scene;
+	flat_scene.setFlatTransforms(true);
+	{
+		Random random_a, random_b;
+		build(nodes_scene.getRoot(), depth, fan_out, random_a);
+		build(flat_scene.getRoot(), depth, fan_out, random_b);
+	}
+	std::vector<SceneNode *> nodes_list, flat_list;
+	list(nodes_scene.getRoot(), nodes_list);
+	list(flat_scene.getRoot(), flat_list);
+	std::printf("%zu nodes per tree, best of %u runs\n", nodes_list.size(), runs);
+
+	bool ok = true;
+	Random random;
+	// prepares a run, then brings both Scenes up to date.
+	auto const measure = [&](char const * name, std::function<void (unsigned run)> const& prepare) {
+		double nodes_time = 0, update_time = 0, flat_time = 0;
+		for(unsigned run = 0; run < runs; run++)
+		{
+			prepare(run);
+			auto const start = std::chrono::steady_clock::now();
+			visit(nodes_scene.getRoot());
+			auto const visited = std::chrono::steady_clock::now();
+			flat_scene.updateTransforms();
+			auto const updated = std::chrono::steady_clock::now();
+			visit(flat_scene.getRoot());
+			auto const end = std::chrono::steady_clock::now();
+
+			if(!run || milliseconds(start, visited) < nodes_time)
+				nodes_time = milliseconds(start, visited);
+			if(!run || milliseconds(visited, updated) < update_time)
+				update_time = milliseconds(visited, updated);
+			if(!run || milliseconds(visited, end) < flat_time)
+				flat_time = milliseconds(visited, end);
+		}
+
+		float const error = compare(flat_scene.getRoot(), nodes_scene.getRoot());
+		bool const passed = error <= k_tolerance;
+		std::printf("%-11s scene nodes %8.3f ms, flattened %8.3f ms (update %8.3f ms), %5.2fx, max error %.2e%s\n",
+			name,
+			nodes_time,
+			flat_time,
+			update_time,
+			nodes_time / flat_time,
+			error,
+			passed ? "" : " FAILED");
+		ok &= passed;
+	};
+	// moves the same nodes in both trees.
+	auto const move = [&](size_t i) {
+		fvec3_t const position = random.position();
+		nodes_list[i]->setPosition(position);
+		flat_list[i]->setPosition(position);
+	};
+
+	measure("all moved", [&](unsigned) {
+		for(size_t i = 0; i < nodes_list.size(); i++)
+			move(i);
+	});
+	measure("rebuild", [&](unsigned run) {
+		// moves the last child of the root under its first child, and back.
+		for(Scene * scene : { &nodes_scene, &flat_scene })
+		{
+			SceneNode &root = scene->getRoot();
+			SceneNode &from = run & 1 ? *root.firstChild() : root;
+			SceneNode &to = run & 1 ? root : *root.firstChild();
+			from.transferChild(from.lastChild(), to);
+		}
+	});
+	// the trees changed shape, so the node lists have to be made again.
+	nodes_list.clear();
+	flat_list.clear();
+	list(nodes_scene.getRoot(), nodes_list);
+	list(flat_scene.getRoot(), flat_list);
+	measure("1% moved", [&](unsigned) {
+		for(size_t i = 0; i < nodes_list.size() / 100; i++)
+			move(random.index(nodes_list.size()));
+	});
+	measure("none moved", [](unsigned) {});
+
+	return ok ? 0 : 1;
+}
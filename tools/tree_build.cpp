@@ -0,0 +1,207 @@
+/** Measures how long building and tearing down a large node tree takes, with pooled and with individually allocated nodes.
+
+	Usage: re_tree_build [depth] [fan-out] [runs]
+
+	The tree defaults to a depth of 5 and a fan-out of 10, which are 111111 nodes. Each variant is run several times (default 5), and the best time is printed:
+		scene, pooled:         SceneNodes in a Scene, allocated from the shared node pool.
+		scene, vector:         a node stored like SceneNodes were before pooling: its child nodes are values in a std::vector. It is padded to the size of a SceneNode, so that only the allocation differs.
+		ui, re::alloc:         a polymorphic node with a UINode-sized payload, whose child nodes are owned via Auto and allocated via re::alloc.
+		ui, re::alloc + Heap:  the same, with a segregated singleton Heap, so that re::alloc does not fall back to the C heap.
+		ui, ObjectPool:        the same, allocated from an ObjectPool, as done by UINode::alloc(). */
+#include "../src/Scene.hpp"
+#include "../src/Singleton.hpp"
+#include "../src/util/Heap.hpp"
+#include "../src/util/ObjectPool.hpp"
+#include "../src/util/Pointer.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace re;
+using namespace re::util;
+
+namespace
+{
+	/** The best build and teardown times of a variant, in milliseconds. */
+	struct Times
+	{
+		double m_build;
+		double m_teardown;
+	};
+
+	double milliseconds(
+		std::chrono::steady_clock::time_point from,
+		std::chrono::steady_clock::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+
+	void build(
+		SceneNode &node,
+		unsigned depth,
+		unsigned fan_out)
+	{
+		if(!depth)
+			return;
+
+		for(unsigned i = 0; i < fan_out; i++)
+		{
+			SceneNode child;
+			child.setPosition(math::fvec3_t(float(i), 0, 0));
+			build(*node.addChild(std::move(child)), depth - 1, fan_out);
+		}
+	}
+
+	/** A node stored like SceneNodes were before pooling: its child nodes are values in a std::vector, which moves them when it grows. */
+	struct VectorNode
+	{
+		VectorNode * m_parent;
+		std::vector<VectorNode> m_children;
+		math::fvec3_t m_position;
+		/** Stands in for the other members of a SceneNode. */
+		char m_padding[sizeof(SceneNode) - sizeof(void *) - sizeof(std::vector<int>) - sizeof(math::fvec3_t)];
+	};
+
+	void build(
+		VectorNode &node,
+		unsigned depth,
+		unsigned fan_out)
+	{
+		if(!depth)
+			return;
+
+		for(unsigned i = 0; i < fan_out; i++)
+		{
+			node.m_children.push_back(VectorNode());
+			VectorNode &child = node.m_children.back();
+			child.m_parent = &node;
+			child.m_position = math::fvec3_t(float(i), 0, 0);
+		}
+		for(VectorNode &child : node.m_children)
+			build(child, depth - 1, fan_out);
+	}
+
+	/** A stand-in for a UINode: polymorphic, a few hundred bytes large, and its child nodes are owned via Auto. */
+	struct UiNode
+	{
+		virtual ~UiNode() {}
+
+		UiNode * m_parent;
+		std::vector<Auto<UiNode>> m_children;
+		char m_payload[320];
+	};
+
+	template<bool k_pool>
+	void build(
+		UiNode &node,
+		unsigned depth,
+		unsigned fan_out)
+	{
+		if(!depth)
+			return;
+
+		node.m_children.reserve(fan_out);
+		for(unsigned i = 0; i < fan_out; i++)
+		{
+			UiNode * const child = k_pool
+				? singleton<ObjectPool<UiNode>>().alloc()
+				: re::alloc<UiNode>();
+			child->m_parent = &node;
+			node.m_children.emplace_back(child);
+			build<k_pool>(*child, depth - 1, fan_out);
+		}
+	}
+
+	template<class Run>
+	/** Runs a variant several times, and keeps its best times. */
+	Times best(
+		unsigned runs,
+		Run run)
+	{
+		Times times = { 0, 0 };
+		for(unsigned i = 0; i < runs; i++)
+		{
+			Times const current = run();
+			if(!i || current.m_build < times.m_build)
+				times.m_build = current.m_build;
+			if(!i || current.m_teardown < times.m_teardown)
+				times.m_teardown = current.m_teardown;
+		}
+		return times;
+	}
+
+	void print(
+		char const * name,
+		Times const& times)
+	{
+		std::printf("%-22s build %8.2f ms, teardown %8.2f ms\n", name, times.m_build, times.m_teardown);
+	}
+
+	template<bool k_pool>
+	Times ui(
+		unsigned depth,
+		unsigned fan_out)
+	{
+		UiNode root;
+		auto const start = std::chrono::steady_clock::now();
+		build<k_pool>(root, depth, fan_out);
+		auto const built = std::chrono::steady_clock::now();
+		root.m_children.clear();
+		auto const end = std::chrono::steady_clock::now();
+
+		Times const times = { milliseconds(start, built), milliseconds(built, end) };
+		return times;
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned const depth = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 5;
+	unsigned const fan_out = argc > 2 ? unsigned(std::strtoul(argv[2], nullptr, 10)) : 10;
+	unsigned const runs = argc > 3 ? unsigned(std::strtoul(argv[3], nullptr, 10)) : 5;
+	if(!fan_out || !runs)
+	{
+		std::fprintf(stderr, "usage: %s [depth] [fan-out] [runs]\n", argv[0]);
+		return 1;
+	}
+
+	size_t nodes = 1;
+	for(size_t level = 1, i = 0; i < depth; i++)
+		nodes += (level *= fan_out);
+	std::printf("%zu nodes per tree, best of %u runs\n", nodes, runs);
+
+	print("scene, pooled", best(runs, [&]() {
+		Scene * const scene = new Scene();
+		auto const start = std::chrono::steady_clock::now();
+		build(scene->getRoot(), depth, fan_out);
+		auto const built = std::chrono::steady_clock::now();
+		delete scene;
+		auto const end = std::chrono::steady_clock::now();
+
+		Times const times = { milliseconds(start, built), milliseconds(built, end) };
+		return times;
+	}));
+
+	print("scene, vector", best(runs, [&]() {
+		VectorNode * const root = new VectorNode();
+		root->m_parent = nullptr;
+		auto const start = std::chrono::steady_clock::now();
+		build(*root, depth, fan_out);
+		auto const built = std::chrono::steady_clock::now();
+		delete root;
+		auto const end = std::chrono::steady_clock::now();
+
+		Times const times = { milliseconds(start, built), milliseconds(built, end) };
+		return times;
+	}));
+
+	print("ui, re::alloc", best(runs, [&]() { return ui<false>(depth, fan_out); }));
+	singleton<Heap>().create(nodes * 512 + (size_t(64) << 20), HeapMode::Segregated);
+	print("ui, re::alloc + Heap", best(runs, [&]() { return ui<false>(depth, fan_out); }));
+	print("ui, ObjectPool", best(runs, [&]() { return ui<true>(depth, fan_out); }));
+
+	return 0;
+}